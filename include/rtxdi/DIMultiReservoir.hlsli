@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef RTXDI_DI_MULTI_RESERVOIR_HLSLI
+#define RTXDI_DI_MULTI_RESERVOIR_HLSLI
+
+#include "DIReservoir.hlsli"
+
+// Number of light samples kept by a RTXDI_DIMultiReservoir, 2 to 4.
+#ifndef RTXDI_DI_MULTI_RESERVOIR_SAMPLES
+#define RTXDI_DI_MULTI_RESERVOIR_SAMPLES 2
+#endif
+
+#if RTXDI_DI_MULTI_RESERVOIR_SAMPLES < 2 || RTXDI_DI_MULTI_RESERVOIR_SAMPLES > 4
+#error "RTXDI_DI_MULTI_RESERVOIR_SAMPLES must be between 2 and 4"
+#endif
+
+// A reservoir that selects RTXDI_DI_MULTI_RESERVOIR_SAMPLES lights from the same candidate stream,
+// for surfaces lit by several comparable lights. Each sample is an independent RTXDI_DIReservoir whose
+// selection uses a stratified copy of the random number, so the samples are distinct lights more often
+// than with independent random numbers. Sample i is combined only with sample i of other reservoirs.
+// Shading averages the samples, see RTXDI_GetDIMultiReservoirSampleWeight.
+struct RTXDI_DIMultiReservoir
+{
+    RTXDI_DIReservoir samples[RTXDI_DI_MULTI_RESERVOIR_SAMPLES];
+};
+
+struct RTXDI_PackedDIMultiReservoir
+{
+    RTXDI_PackedDIReservoir samples[RTXDI_DI_MULTI_RESERVOIR_SAMPLES];
+};
+
+// Random number used by sample i for a selection that uses `random` for the whole reservoir
+float RTXDI_GetDIMultiReservoirRandom(float random, uint sampleIndex)
+{
+    return frac(random + float(sampleIndex) / float(RTXDI_DI_MULTI_RESERVOIR_SAMPLES));
+}
+
+RTXDI_DIMultiReservoir RTXDI_EmptyDIMultiReservoir()
+{
+    RTXDI_DIMultiReservoir reservoir;
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+        reservoir.samples[i] = RTXDI_EmptyDIReservoir();
+    return reservoir;
+}
+
+RTXDI_PackedDIMultiReservoir RTXDI_PackDIMultiReservoir(const RTXDI_DIMultiReservoir reservoir)
+{
+    RTXDI_PackedDIMultiReservoir data;
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+        data.samples[i] = RTXDI_PackDIReservoir(reservoir.samples[i]);
+    return data;
+}
+
+RTXDI_DIMultiReservoir RTXDI_UnpackDIMultiReservoir(RTXDI_PackedDIMultiReservoir data)
+{
+    RTXDI_DIMultiReservoir reservoir;
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+        reservoir.samples[i] = RTXDI_UnpackDIReservoir(data.samples[i]);
+    return reservoir;
+}
+
+// Sample i of the multi-reservoirs in array A is stored as a regular reservoir in array
+// A * RTXDI_DI_MULTI_RESERVOIR_SAMPLES + i, in any of the reservoir storage formats and layouts.
+// See rtxdi::CalculateDIMultiReservoirBufferSizeInBytes for the buffer size.
+uint RTXDI_GetDIMultiReservoirArrayIndex(uint reservoirArrayIndex, uint sampleIndex)
+{
+    return reservoirArrayIndex * RTXDI_DI_MULTI_RESERVOIR_SAMPLES + sampleIndex;
+}
+
+RTXDI_DIMultiReservoir RTXDI_LoadDIMultiReservoir(
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex)
+{
+    RTXDI_DIMultiReservoir reservoir;
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+    {
+        reservoir.samples[i] = RTXDI_LoadDIReservoir(reservoirParams, reservoirPosition,
+            RTXDI_GetDIMultiReservoirArrayIndex(reservoirArrayIndex, i));
+    }
+    return reservoir;
+}
+
+#if RTXDI_ENABLE_STORE_RESERVOIR
+void RTXDI_StoreDIMultiReservoir(
+    const RTXDI_DIMultiReservoir reservoir,
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex)
+{
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+    {
+        RTXDI_StoreDIReservoir(reservoir.samples[i], reservoirParams, reservoirPosition,
+            RTXDI_GetDIMultiReservoirArrayIndex(reservoirArrayIndex, i));
+    }
+}
+#endif // RTXDI_ENABLE_STORE_RESERVOIR
+
+bool RTXDI_IsValidDIMultiReservoir(const RTXDI_DIMultiReservoir reservoir)
+{
+    bool valid = false;
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+        valid = valid || RTXDI_IsValidDIReservoir(reservoir.samples[i]);
+    return valid;
+}
+
+// Adds a new, non-reservoir light sample into every sample of the reservoir, see RTXDI_StreamSample.
+// Returns a mask of the samples that selected it.
+uint RTXDI_StreamDIMultiSample(
+    RTXDI_INOUT(RTXDI_DIMultiReservoir) reservoir,
+    uint lightIndex,
+    float2 uv,
+    float random,
+    float targetPdf,
+    float invSourcePdf)
+{
+    uint selectedMask = 0;
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+    {
+        if (RTXDI_StreamSample(reservoir.samples[i], lightIndex, uv, RTXDI_GetDIMultiReservoirRandom(random, i), targetPdf, invSourcePdf))
+            selectedMask |= 1u << i;
+    }
+    return selectedMask;
+}
+
+// Adds each sample of `newReservoir` into the matching sample of `reservoir`, see RTXDI_CombineDIReservoirs.
+// targetPdf[i] is the target PDF of newReservoir.samples[i] at the surface of `reservoir`.
+// Returns a mask of the samples that selected the new sample.
+uint RTXDI_CombineDIMultiReservoirs(
+    RTXDI_INOUT(RTXDI_DIMultiReservoir) reservoir,
+    const RTXDI_DIMultiReservoir newReservoir,
+    float random,
+    float targetPdf[RTXDI_DI_MULTI_RESERVOIR_SAMPLES])
+{
+    uint selectedMask = 0;
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+    {
+        if (RTXDI_CombineDIReservoirs(reservoir.samples[i], newReservoir.samples[i], RTXDI_GetDIMultiReservoirRandom(random, i), targetPdf[i]))
+            selectedMask |= 1u << i;
+    }
+    return selectedMask;
+}
+
+// Normalizes every sample with the same factors, see RTXDI_FinalizeResampling.
+// Bias correction that depends on the selected light must finalize each sample separately.
+void RTXDI_FinalizeDIMultiResampling(
+    RTXDI_INOUT(RTXDI_DIMultiReservoir) reservoir,
+    float normalizationNumerator,
+    float normalizationDenominator)
+{
+    for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; ++i)
+        RTXDI_FinalizeResampling(reservoir.samples[i], normalizationNumerator, normalizationDenominator);
+}
+
+// Weight of sample i in the shading of the reservoir: the shading result is the sum over the samples
+// of the light contribution times this weight.
+float RTXDI_GetDIMultiReservoirSampleWeight(const RTXDI_DIMultiReservoir reservoir, uint sampleIndex)
+{
+    return RTXDI_GetDIReservoirInvPdf(reservoir.samples[sampleIndex]) / float(RTXDI_DI_MULTI_RESERVOIR_SAMPLES);
+}
+
+#endif // RTXDI_DI_MULTI_RESERVOIR_HLSLI
@@ -43,7 +43,7 @@ float RTXDI_TargetPdfHelper(const RTXDI_DIReservoir lightReservoir, const RAB_Su
 // candidate, after which the MIS is completed by calling RTXDI_StreamCanonicalWithPairwiseStep() once for
 // the canonical sample.
 // See Chapter 9.1 of https://digitalcommons.dartmouth.edu/dissertations/77/, especially Eq 9.10 & Algo 8
-bool RTXDI_StreamNeighborWithPairwiseMIS(inout RTXDI_DIReservoir reservoir,
+bool RTXDI_StreamNeighborWithPairwiseMIS(RTXDI_INOUT(RTXDI_DIReservoir) reservoir,
     float random,
     const RTXDI_DIReservoir neighborReservoir,
     const RAB_Surface neighborSurface,
@@ -85,7 +85,7 @@ bool RTXDI_StreamNeighborWithPairwiseMIS(inout RTXDI_DIReservoir reservoir,
 // Called to finish the process of doing pairwise MIS.  This function must be called after all required calls to
 // RTXDI_StreamNeighborWithPairwiseMIS(), since pairwise MIS overweighs the canonical sample.  This function 
 // compensates for this overweighting, but it can only happen after all neighbors have been processed.
-bool RTXDI_StreamCanonicalWithPairwiseStep(inout RTXDI_DIReservoir reservoir,
+bool RTXDI_StreamCanonicalWithPairwiseStep(RTXDI_INOUT(RTXDI_DIReservoir) reservoir,
     float random,
     const RTXDI_DIReservoir canonicalReservoir,
     const RAB_Surface canonicalSurface)
@@ -107,9 +107,12 @@ bool RTXDI_StreamCanonicalWithPairwiseStep(inout RTXDI_DIReservoir reservoir,
 void RTXDI_BoilingFilter(
     uint2 LocalIndex,
     float filterStrength, // (0..1]
-    inout RTXDI_DIReservoir reservoir)
+    RTXDI_INOUT(RTXDI_DIReservoir) reservoir)
 {
-    if (RTXDI_BoilingFilterInternal(LocalIndex, filterStrength, reservoir.weightSum))
+    bool discard = RTXDI_BoilingFilterInternal(LocalIndex, filterStrength, reservoir.weightSum);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_BOILING_FILTER_REJECTIONS, discard ? 1 : 0);
+
+    if (discard)
         reservoir = RTXDI_EmptyDIReservoir();
 }
 #endif // RTXDI_ENABLE_BOILING_FILTER
@@ -171,12 +174,12 @@ RTXDI_DIReservoir RTXDI_DITemporalResampling(
     uint2 pixelPosition,
     RAB_Surface surface,
     RTXDI_DIReservoir curSample,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_RuntimeParameters params,
     RTXDI_ReservoirBufferParameters reservoirParams,
     RTXDI_DITemporalResamplingParameters tparams,
-    out int2 temporalSamplePixelPos,
-    inout RAB_LightSample selectedLightSample)
+    RTXDI_OUT(int2) temporalSamplePixelPos,
+    RTXDI_INOUT(RAB_LightSample) selectedLightSample)
 {
     // For temporal reuse, there's only a pair of samples; pairwise and basic MIS are essentially identical
     if (tparams.biasCorrectionMode == RTXDI_BIAS_CORRECTION_PAIRWISE)
@@ -184,7 +187,7 @@ RTXDI_DIReservoir RTXDI_DITemporalResampling(
         tparams.biasCorrectionMode = RTXDI_BIAS_CORRECTION_BASIC;
     }
 
-    uint historyLimit = min(RTXDI_PackedDIReservoir_MaxM, uint(tparams.maxHistoryLength * curSample.M));
+    uint historyLimit = min(RTXDI_DIReservoir_MaxM, uint(tparams.maxHistoryLength * curSample.M));
 
     int selectedLightPrevID = -1;
 
@@ -206,7 +209,7 @@ RTXDI_DIReservoir RTXDI_DITemporalResampling(
         motion.xy += float2(RAB_GetNextRandom(rng), RAB_GetNextRandom(rng)) - 0.5;
     }
 
-    float2 reprojectedSamplePosition = float2(pixelPosition) + motion.xy;
+    float2 reprojectedSamplePosition = RTXDI_ReprojectPixelPos(pixelPosition, motion.xy, params);
     int2 prevPos = int2(round(reprojectedSamplePosition));
 
     float expectedPrevLinearDepth = RAB_GetSurfaceLinearDepth(surface) + motion.z;
@@ -253,6 +256,9 @@ RTXDI_DIReservoir RTXDI_DITemporalResampling(
         break;
     }
 
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCHES, 1);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCH_FAILURES, foundNeighbor ? 0 : 1);
+
     bool selectedPreviousSample = false;
     float previousM = 0;
 
@@ -337,6 +343,7 @@ RTXDI_DIReservoir RTXDI_DITemporalResampling(
 #if RTXDI_ALLOWED_BIAS_CORRECTION >= RTXDI_BIAS_CORRECTION_RAY_TRACED
             if (tparams.biasCorrectionMode == RTXDI_BIAS_CORRECTION_RAY_TRACED && temporalP > 0 && (!selectedPreviousSample || !tparams.enableVisibilityShortcut))
             {
+                RTXDI_IncrementCounter(RTXDI_COUNTER_BIAS_CORRECTION_RAYS, 1);
                 if (!RAB_GetTemporalConservativeVisibility(surface, temporalSurface, selectedSampleAtTemporal))
                 {
                     temporalP = 0;
@@ -400,8 +407,43 @@ struct RTXDI_DISpatialResamplingParameters
 
     // Prevents samples which are from the current frame or have no reasonable temporal history merged being spread to neighbors
     bool discountNaiveSamples;
+
+    // Selects the neighbor count of each pixel between minSamples and numSamples, see RTXDI_GetAdaptiveSpatialSampleCount.
+    bool enableAdaptiveSampleCount;
+
+    // Number of neighbor pixels considered by converged pixels in the adaptive mode.
+    uint minSamples;
+
+    // Reservoir M at which a pixel counts as converged, and age at which its sample counts as stale, in the adaptive mode.
+    uint adaptiveConvergedM;
+
+    // Luminance variance of the pixel relative to its squared mean, e.g. estimated by the denoiser in the previous frame,
+    // and the scale that maps it to the [0, 1] range, where 1 requests numSamples neighbors. Only used in the adaptive mode.
+    float luminanceVariance;
+    float adaptiveVarianceScale;
 };
 
+// Number of neighbors considered for the pixel by the spatial resampling functions.
+// Pixels with less than targetHistoryLength history take the disocclusion boost. In the adaptive mode, the other pixels
+// take more neighbors the shorter their history (M), the older their sample (age) and the noisier their neighborhood,
+// from minSamples for converged pixels up to numSamples.
+uint RTXDI_GetAdaptiveSpatialSampleCount(RTXDI_DIReservoir centerSample, RTXDI_DISpatialResamplingParameters sparams)
+{
+    if (centerSample.M < sparams.targetHistoryLength)
+        return max(sparams.numDisocclusionBoostSamples, sparams.numSamples);
+
+    if (!sparams.enableAdaptiveSampleCount || sparams.minSamples >= sparams.numSamples)
+        return sparams.numSamples;
+
+    float convergedM = max(float(sparams.adaptiveConvergedM), 1.0);
+    float historyNeed = 1.0 - saturate(centerSample.M / convergedM);
+    float ageNeed = saturate(float(centerSample.age) / convergedM);
+    float varianceNeed = saturate(sparams.luminanceVariance * sparams.adaptiveVarianceScale);
+    float need = max(historyNeed, max(ageNeed, varianceNeed));
+
+    return sparams.minSamples + uint(need * float(sparams.numSamples - sparams.minSamples) + 0.5);
+}
+
 // Spatial resampling pass, using pairwise MIS.  
 // Inputs and outputs equivalent to RTXDI_SpatialResampling(), but only uses pairwise MIS.
 // Can call this directly, or call RTXDI_SpatialResampling() with sparams.biasCorrectionMode 
@@ -410,30 +452,30 @@ RTXDI_DIReservoir RTXDI_DISpatialResamplingWithPairwiseMIS(
     uint2 pixelPosition,
     RAB_Surface centerSurface,
     RTXDI_DIReservoir centerSample,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_RuntimeParameters params,
     RTXDI_ReservoirBufferParameters reservoirParams,
     RTXDI_DISpatialResamplingParameters sparams,
-    inout RAB_LightSample selectedLightSample)
+    RTXDI_INOUT(RAB_LightSample) selectedLightSample)
 {
     // Initialize the output reservoir
     RTXDI_DIReservoir state = RTXDI_EmptyDIReservoir();
     state.canonicalWeight = 0.0f;
 
     // How many spatial samples to use?  
-    uint numSpatialSamples = (centerSample.M < sparams.targetHistoryLength)
-        ? max(sparams.numDisocclusionBoostSamples, sparams.numSamples)
-        : sparams.numSamples;
+    uint numSpatialSamples = RTXDI_GetAdaptiveSpatialSampleCount(centerSample, sparams);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_DISOCCLUSION_BOOSTS, (numSpatialSamples > sparams.numSamples) ? 1 : 0);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_SPATIAL_SAMPLES, numSpatialSamples);
 
     // Walk the specified number of neighbors, resampling using RIS
-    uint startIdx = uint(RAB_GetNextRandom(rng) * params.neighborOffsetMask);
+    uint startIdx = RTXDI_GetNeighborSampleStartIndex(RAB_GetNextRandom(rng), params.neighborOffsetMask);
     uint validSpatialSamples = 0;
     uint i;
     for (i = 0; i < numSpatialSamples; ++i)
     {
         // Get screen-space location of neighbor
         uint sampleIdx = (startIdx + i) & params.neighborOffsetMask;
-        int2 spatialOffset = int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * sparams.samplingRadius);
+        int2 spatialOffset = RTXDI_RotateNeighborOffset(int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * sparams.samplingRadius), pixelPosition);
         int2 idx = int2(pixelPosition)+spatialOffset;
         idx = RAB_ClampSamplePositionIntoView(idx, false);
 
@@ -505,11 +547,11 @@ RTXDI_DIReservoir RTXDI_DISpatialResampling(
     uint2 pixelPosition,
     RAB_Surface centerSurface,
     RTXDI_DIReservoir centerSample,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_RuntimeParameters params,
     RTXDI_ReservoirBufferParameters reservoirParams,
     RTXDI_DISpatialResamplingParameters sparams,
-    inout RAB_LightSample selectedLightSample)
+    RTXDI_INOUT(RAB_LightSample) selectedLightSample)
 {
     if (sparams.biasCorrectionMode == RTXDI_BIAS_CORRECTION_PAIRWISE)
     {
@@ -534,15 +576,15 @@ RTXDI_DIReservoir RTXDI_DISpatialResampling(
 
     RTXDI_CombineDIReservoirs(state, centerSample, /* random = */ 0.5f, centerSample.targetPdf);
 
-    uint startIdx = uint(RAB_GetNextRandom(rng) * params.neighborOffsetMask);
+    uint startIdx = RTXDI_GetNeighborSampleStartIndex(RAB_GetNextRandom(rng), params.neighborOffsetMask);
     
     uint i;
-    uint numSpatialSamples = sparams.numSamples;
-    if(centerSample.M < sparams.targetHistoryLength)
-        numSpatialSamples = max(sparams.numDisocclusionBoostSamples, numSpatialSamples);
+    uint numSpatialSamples = RTXDI_GetAdaptiveSpatialSampleCount(centerSample, sparams);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_DISOCCLUSION_BOOSTS, (numSpatialSamples > sparams.numSamples) ? 1 : 0);
 
     // Clamp the sample count at 32 to make sure we can keep the neighbor mask in an uint (cachedResult)
     numSpatialSamples = min(numSpatialSamples, 32);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_SPATIAL_SAMPLES, numSpatialSamples);
 
     // We loop through neighbors twice.  Cache the validity / edge-stopping function
     //   results for the 2nd time through.
@@ -553,7 +595,7 @@ RTXDI_DIReservoir RTXDI_DISpatialResampling(
     {
         // Get screen-space location of neighbor
         uint sampleIdx = (startIdx + i) & params.neighborOffsetMask;
-        int2 spatialOffset = int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * sparams.samplingRadius);
+        int2 spatialOffset = RTXDI_RotateNeighborOffset(int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * sparams.samplingRadius), pixelPosition);
         int2 idx = int2(pixelPosition) + spatialOffset;
 
         idx = RAB_ClampSamplePositionIntoView(idx, false);
@@ -625,7 +667,7 @@ RTXDI_DIReservoir RTXDI_DISpatialResampling(
                 uint sampleIdx = (startIdx + i) & params.neighborOffsetMask;
 
                 // Get the screen-space location of our neighbor
-                int2 idx = int2(pixelPosition) + int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * sparams.samplingRadius);
+                int2 idx = int2(pixelPosition) + RTXDI_RotateNeighborOffset(int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * sparams.samplingRadius), pixelPosition);
 
                 idx = RAB_ClampSamplePositionIntoView(idx, false);
 
@@ -643,6 +685,7 @@ RTXDI_DIReservoir RTXDI_DISpatialResampling(
 #if RTXDI_ALLOWED_BIAS_CORRECTION >= RTXDI_BIAS_CORRECTION_RAY_TRACED
                 if (sparams.biasCorrectionMode == RTXDI_BIAS_CORRECTION_RAY_TRACED && ps > 0)
                 {
+                    RTXDI_IncrementCounter(RTXDI_COUNTER_BIAS_CORRECTION_RAYS, 1);
                     if (!RAB_GetConservativeVisibility(neighborSurface, selectedSampleAtNeighbor))
                     {
                         ps = 0;
@@ -747,14 +790,14 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResamplingWithPairwiseMIS(
     uint2 pixelPosition,
     RAB_Surface surface,
     RTXDI_DIReservoir curSample,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_RuntimeParameters params,
     RTXDI_ReservoirBufferParameters reservoirParams,
     RTXDI_DISpatioTemporalResamplingParameters stparams,
-    out int2 temporalSamplePixelPos,
-    inout RAB_LightSample selectedLightSample)
+    RTXDI_OUT(int2) temporalSamplePixelPos,
+    RTXDI_INOUT(RAB_LightSample) selectedLightSample)
 {
-    uint historyLimit = min(RTXDI_PackedDIReservoir_MaxM, uint(stparams.maxHistoryLength * curSample.M));
+    uint historyLimit = min(RTXDI_DIReservoir_MaxM, uint(stparams.maxHistoryLength * curSample.M));
 
     // Backproject this pixel to last frame
     float3 motion = stparams.screenSpaceMotion;
@@ -762,7 +805,7 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResamplingWithPairwiseMIS(
     {
         motion.xy += float2(RAB_GetNextRandom(rng), RAB_GetNextRandom(rng)) - 0.5;
     }
-    int2 prevPos = int2(round(float2(pixelPosition)+motion.xy));
+    int2 prevPos = int2(round(RTXDI_ReprojectPixelPos(pixelPosition, motion.xy, params)));
     float expectedPrevLinearDepth = RAB_GetSurfaceLinearDepth(surface) + motion.z;
 
     // Some default initializations
@@ -811,6 +854,10 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResamplingWithPairwiseMIS(
         ? max(stparams.numDisocclusionBoostSamples, stparams.numSamples)
         : uint(int(stparams.numSamples));
 
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCHES, 1);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCH_FAILURES, foundTemporalSurface ? 0 : 1);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_DISOCCLUSION_BOOSTS, (numSpatialSamples > stparams.numSamples) ? 1 : 0);
+
     // Count how many of our spatiotemporal samples are valid and streamed via RIS
     int validSamples = 0;
 
@@ -848,11 +895,11 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResamplingWithPairwiseMIS(
     }
 
     // Look for valid (spatiotemporal) neighbors and stream them through the reservoir via pairwise MIS
-    uint startIdx = uint(RAB_GetNextRandom(rng) * params.neighborOffsetMask);
+    uint startIdx = RTXDI_GetNeighborSampleStartIndex(RAB_GetNextRandom(rng), params.neighborOffsetMask);
     for (i = 1; i < numSpatialSamples; ++i)
     {
         uint sampleIdx = (startIdx + i) & params.neighborOffsetMask;
-        int2 spatialOffset = int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * stparams.samplingRadius);
+        int2 spatialOffset = RTXDI_RotateNeighborOffset(int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * stparams.samplingRadius), pixelPosition);
         int2 idx = prevPos + spatialOffset;
 
         if (idx.x < 0 || idx.y < 0)
@@ -936,12 +983,12 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
     uint2 pixelPosition,
     RAB_Surface surface,
     RTXDI_DIReservoir curSample,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_RuntimeParameters params,
     RTXDI_ReservoirBufferParameters reservoirParams,
     RTXDI_DISpatioTemporalResamplingParameters stparams,
-    out int2 temporalSamplePixelPos,
-    inout RAB_LightSample selectedLightSample)
+    RTXDI_OUT(int2) temporalSamplePixelPos,
+    RTXDI_INOUT(RAB_LightSample) selectedLightSample)
 {
     if (stparams.biasCorrectionMode == RTXDI_BIAS_CORRECTION_PAIRWISE)
     {
@@ -949,7 +996,7 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
             curSample, rng, params, reservoirParams, stparams, temporalSamplePixelPos, selectedLightSample);
     }
 
-    uint historyLimit = min(RTXDI_PackedDIReservoir_MaxM, uint(stparams.maxHistoryLength * curSample.M));
+    uint historyLimit = min(RTXDI_DIReservoir_MaxM, uint(stparams.maxHistoryLength * curSample.M));
 
     int selectedLightPrevID = -1;
 
@@ -963,7 +1010,7 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
     RTXDI_DIReservoir state = RTXDI_EmptyDIReservoir();
     RTXDI_CombineDIReservoirs(state, curSample, /* random = */ 0.5, curSample.targetPdf);
 
-    uint startIdx = uint(RAB_GetNextRandom(rng) * params.neighborOffsetMask);
+    uint startIdx = RTXDI_GetNeighborSampleStartIndex(RAB_GetNextRandom(rng), params.neighborOffsetMask);
 
     // Backproject this pixel to last frame
     float3 motion = stparams.screenSpaceMotion;
@@ -973,7 +1020,7 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
         motion.xy += float2(RAB_GetNextRandom(rng), RAB_GetNextRandom(rng)) - 0.5;
     }
 
-    float2 reprojectedSamplePosition = float2(pixelPosition) + motion.xy;
+    float2 reprojectedSamplePosition = RTXDI_ReprojectPixelPos(pixelPosition, motion.xy, params);
     int2 prevPos = int2(round(reprojectedSamplePosition));
 
     float expectedPrevLinearDepth = RAB_GetSurfaceLinearDepth(surface) + motion.z;
@@ -1028,6 +1075,10 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
     if (!foundTemporalSurface)
         numSamples = clamp(stparams.numDisocclusionBoostSamples, numSamples, 32);
 
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCHES, 1);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCH_FAILURES, foundTemporalSurface ? 0 : 1);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_DISOCCLUSION_BOOSTS, (numSamples > clamp(stparams.numSamples, 1, 32)) ? 1 : 0);
+
     // We loop through neighbors twice.  Cache the validity / edge-stopping function
     //   results for the 2nd time through.
     uint cachedResult = 0;
@@ -1049,7 +1100,7 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
         else
         {
             uint sampleIdx = (startIdx + i) & params.neighborOffsetMask;
-            spatialOffset = int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * stparams.samplingRadius);
+            spatialOffset = RTXDI_RotateNeighborOffset(int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * stparams.samplingRadius), pixelPosition);
 
             idx = prevPos + spatialOffset;
 
@@ -1160,7 +1211,7 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
                     // Get the screen-space location of our neighbor
                     int2 spatialOffset = (i == 0 && foundTemporalSurface) 
                         ? temporalSpatialOffset 
-                        : int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * stparams.samplingRadius);
+                        : RTXDI_RotateNeighborOffset(int2(float2(RTXDI_NEIGHBOR_OFFSETS_BUFFER[sampleIdx].xy) * stparams.samplingRadius), pixelPosition);
                     int2 idx = prevPos + spatialOffset;
 
                     if (!(i == 0 && foundTemporalSurface))
@@ -1189,6 +1240,7 @@ RTXDI_DIReservoir RTXDI_DISpatioTemporalResampling(
                         else
                             fallbackSurface = neighborSurface;
 
+                        RTXDI_IncrementCounter(RTXDI_COUNTER_BIAS_CORRECTION_RAYS, 1);
                         if (!RAB_GetTemporalConservativeVisibility(fallbackSurface, neighborSurface, selectedSampleAtNeighbor))
                         {
                             ps = 0;
@@ -15,7 +15,11 @@
 #include "RtxdiHelpers.hlsli"
 
 #ifndef RTXDI_LIGHT_RESERVOIR_BUFFER
-#error "RTXDI_LIGHT_RESERVOIR_BUFFER must be defined to point to a RWStructuredBuffer<RTXDI_PackedDIReservoir> type resource"
+#error "RTXDI_LIGHT_RESERVOIR_BUFFER must be defined to point to a RWStructuredBuffer<RTXDI_PackedDIReservoir> type resource, or RWStructuredBuffer<RTXDI_CompactDIReservoir> if RTXDI_COMPACT_DI_RESERVOIR is 1, or RWStructuredBuffer<uint2> if RTXDI_SOA_DI_RESERVOIR is 1"
+#endif
+
+#if RTXDI_COMPACT_DI_RESERVOIR && RTXDI_SOA_DI_RESERVOIR
+#error "RTXDI_COMPACT_DI_RESERVOIR and RTXDI_SOA_DI_RESERVOIR cannot be used together"
 #endif
 
 // Define this macro to 0 if your shader needs read-only access to the reservoirs, 
@@ -75,10 +79,40 @@ static const uint RTXDI_PackedDIReservoir_MaxAge = 0xff;
 static const uint RTXDI_PackedDIReservoir_DistanceMask = (1u << RTXDI_PackedDIReservoir_DistanceChannelBits) - 1;
 static const  int RTXDI_PackedDIReservoir_MaxDistance = int((1u << (RTXDI_PackedDIReservoir_DistanceChannelBits - 1)) - 1);
 
+// Encoding helper constants for RTXDI_CompactDIReservoir
+static const uint RTXDI_CompactDIReservoir_UVChannelBits = 12;
+static const uint RTXDI_CompactDIReservoir_UVChannelMask = 0xfff;
+static const uint RTXDI_CompactDIReservoir_MShift = 24;
+static const uint RTXDI_CompactDIReservoir_MaxM = 0xff;
+static const uint RTXDI_CompactDIReservoir_VisibilityChannelBits = 5;
+static const uint RTXDI_CompactDIReservoir_VisibilityChannelMask = 0x1f;
+static const uint RTXDI_CompactDIReservoir_DistanceChannelBits = 6;
+static const uint RTXDI_CompactDIReservoir_DistanceXShift = 15;
+static const uint RTXDI_CompactDIReservoir_DistanceYShift = 21;
+static const uint RTXDI_CompactDIReservoir_AgeShift = 27;
+static const uint RTXDI_CompactDIReservoir_MaxAge = 0x1f;
+static const uint RTXDI_CompactDIReservoir_DistanceMask = (1u << RTXDI_CompactDIReservoir_DistanceChannelBits) - 1;
+static const  int RTXDI_CompactDIReservoir_MaxDistance = int((1u << (RTXDI_CompactDIReservoir_DistanceChannelBits - 1)) - 1);
+static const float RTXDI_CompactDIReservoir_MaxHalf = 65504.0;
+
+// Largest M that the reservoir storage format can represent
+#if RTXDI_COMPACT_DI_RESERVOIR
+static const uint RTXDI_DIReservoir_MaxM = RTXDI_CompactDIReservoir_MaxM;
+#else
+static const uint RTXDI_DIReservoir_MaxM = RTXDI_PackedDIReservoir_MaxM;
+#endif
+
 // Light index helpers
 static const uint RTXDI_DIReservoir_LightValidBit = 0x80000000;
 static const uint RTXDI_DIReservoir_LightIndexMask = 0x7FFFFFFF;
 
+// Field groups of RTXDI_DIReservoir for RTXDI_LoadDIReservoirFields and RTXDI_StoreDIReservoirFields,
+// each group is one plane of the SoA layout
+static const uint RTXDI_DIReservoirFields_Sample = 0x1;     // lightData, uvData
+static const uint RTXDI_DIReservoirFields_Weights = 0x2;    // targetPdf, weightSum
+static const uint RTXDI_DIReservoirFields_Reuse = 0x4;      // M, packedVisibility, spatialDistance, age
+static const uint RTXDI_DIReservoirFields_All = 0x7;
+
 RTXDI_PackedDIReservoir RTXDI_PackDIReservoir(const RTXDI_DIReservoir reservoir)
 {
     int2 clampedSpatialDistance = clamp(reservoir.spatialDistance, -RTXDI_PackedDIReservoir_MaxDistance, RTXDI_PackedDIReservoir_MaxDistance);
@@ -102,6 +136,99 @@ RTXDI_PackedDIReservoir RTXDI_PackDIReservoir(const RTXDI_DIReservoir reservoir)
     return data;
 }
 
+RTXDI_CompactDIReservoir RTXDI_PackCompactDIReservoir(const RTXDI_DIReservoir reservoir)
+{
+    int2 clampedSpatialDistance = clamp(reservoir.spatialDistance, -RTXDI_CompactDIReservoir_MaxDistance, RTXDI_CompactDIReservoir_MaxDistance);
+    uint clampedAge = clamp(reservoir.age, 0, RTXDI_CompactDIReservoir_MaxAge);
+
+    // Drop the low bits of the 16-bit UV and 6-bit visibility channels
+    uint u = (reservoir.uvData & 0xffff) >> (16 - RTXDI_CompactDIReservoir_UVChannelBits);
+    uint v = (reservoir.uvData >> 16) >> (16 - RTXDI_CompactDIReservoir_UVChannelBits);
+    uint visibility =
+          (((reservoir.packedVisibility) & RTXDI_PackedDIReservoir_VisibilityChannelMax) >> 1)
+        | (((reservoir.packedVisibility >> RTXDI_PackedDIReservoir_VisibilityChannelShift) & RTXDI_PackedDIReservoir_VisibilityChannelMax) >> 1) << RTXDI_CompactDIReservoir_VisibilityChannelBits
+        | (((reservoir.packedVisibility >> (RTXDI_PackedDIReservoir_VisibilityChannelShift * 2)) & RTXDI_PackedDIReservoir_VisibilityChannelMax) >> 1) << (RTXDI_CompactDIReservoir_VisibilityChannelBits * 2);
+
+    RTXDI_CompactDIReservoir data;
+    data.lightData = reservoir.lightData;
+    data.targetPdfWeight = f32tof16(min(reservoir.targetPdf, RTXDI_CompactDIReservoir_MaxHalf))
+        | (f32tof16(min(reservoir.weightSum, RTXDI_CompactDIReservoir_MaxHalf)) << 16);
+    data.uvM = u
+        | (v << RTXDI_CompactDIReservoir_UVChannelBits)
+        | (min(uint(reservoir.M), RTXDI_CompactDIReservoir_MaxM) << RTXDI_CompactDIReservoir_MShift);
+    data.visibilityDistanceAge = visibility
+        | ((clampedSpatialDistance.x & RTXDI_CompactDIReservoir_DistanceMask) << RTXDI_CompactDIReservoir_DistanceXShift)
+        | ((clampedSpatialDistance.y & RTXDI_CompactDIReservoir_DistanceMask) << RTXDI_CompactDIReservoir_DistanceYShift)
+        | (clampedAge << RTXDI_CompactDIReservoir_AgeShift);
+
+    return data;
+}
+
+#if RTXDI_SOA_DI_RESERVOIR
+// Reads the requested planes of a reservoir stored in the SoA layout, the fields of the other planes are zero
+RTXDI_PackedDIReservoir RTXDI_LoadDIReservoirPlanes(
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+
+    RTXDI_PackedDIReservoir data;
+    data.lightData = 0;
+    data.uvData = 0;
+    data.mVisibility = 0;
+    data.distanceAge = 0;
+    data.targetPdf = 0;
+    data.weight = 0;
+
+    if ((fields & RTXDI_DIReservoirFields_Sample) != 0)
+    {
+        uint2 plane = RTXDI_LIGHT_RESERVOIR_BUFFER[pointer];
+        data.lightData = plane.x;
+        data.uvData = plane.y;
+    }
+
+    if ((fields & RTXDI_DIReservoirFields_Weights) != 0)
+    {
+        uint2 plane = RTXDI_LIGHT_RESERVOIR_BUFFER[pointer + reservoirParams.reservoirPlanePitch];
+        data.targetPdf = asfloat(plane.x);
+        data.weight = asfloat(plane.y);
+    }
+
+    if ((fields & RTXDI_DIReservoirFields_Reuse) != 0)
+    {
+        uint2 plane = RTXDI_LIGHT_RESERVOIR_BUFFER[pointer + reservoirParams.reservoirPlanePitch * 2];
+        data.mVisibility = plane.x;
+        data.distanceAge = plane.y;
+    }
+
+    return data;
+}
+
+#if RTXDI_ENABLE_STORE_RESERVOIR
+// Writes the requested planes of a reservoir in the SoA layout
+void RTXDI_StoreDIReservoirPlanes(
+    const RTXDI_PackedDIReservoir data,
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+
+    if ((fields & RTXDI_DIReservoirFields_Sample) != 0)
+        RTXDI_LIGHT_RESERVOIR_BUFFER[pointer] = uint2(data.lightData, data.uvData);
+
+    if ((fields & RTXDI_DIReservoirFields_Weights) != 0)
+        RTXDI_LIGHT_RESERVOIR_BUFFER[pointer + reservoirParams.reservoirPlanePitch] = uint2(asuint(data.targetPdf), asuint(data.weight));
+
+    if ((fields & RTXDI_DIReservoirFields_Reuse) != 0)
+        RTXDI_LIGHT_RESERVOIR_BUFFER[pointer + reservoirParams.reservoirPlanePitch * 2] = uint2(data.mVisibility, data.distanceAge);
+}
+#endif // RTXDI_ENABLE_STORE_RESERVOIR
+#endif // RTXDI_SOA_DI_RESERVOIR
+
 #if RTXDI_ENABLE_STORE_RESERVOIR
 void RTXDI_StoreDIReservoir(
     const RTXDI_DIReservoir reservoir,
@@ -109,8 +236,16 @@ void RTXDI_StoreDIReservoir(
     uint2 reservoirPosition,
     uint reservoirArrayIndex)
 {
+#if RTXDI_SOA_DI_RESERVOIR
+    RTXDI_StoreDIReservoirPlanes(RTXDI_PackDIReservoir(reservoir), reservoirParams, reservoirPosition, reservoirArrayIndex, RTXDI_DIReservoirFields_All);
+#else
     uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+#if RTXDI_COMPACT_DI_RESERVOIR
+    RTXDI_LIGHT_RESERVOIR_BUFFER[pointer] = RTXDI_PackCompactDIReservoir(reservoir);
+#else
     RTXDI_LIGHT_RESERVOIR_BUFFER[pointer] = RTXDI_PackDIReservoir(reservoir);
+#endif
+#endif
 }
 #endif // RTXDI_ENABLE_STORE_RESERVOIR
 
@@ -152,17 +287,137 @@ RTXDI_DIReservoir RTXDI_UnpackDIReservoir(RTXDI_PackedDIReservoir data)
     return res;
 }
 
+RTXDI_DIReservoir RTXDI_UnpackCompactDIReservoir(RTXDI_CompactDIReservoir data)
+{
+    // Expand the truncated channels to the full range of the RTXDI_DIReservoir encoding
+    uint u = data.uvM & RTXDI_CompactDIReservoir_UVChannelMask;
+    uint v = (data.uvM >> RTXDI_CompactDIReservoir_UVChannelBits) & RTXDI_CompactDIReservoir_UVChannelMask;
+    u = (u << 4) | (u >> 8);
+    v = (v << 4) | (v >> 8);
+
+    uint visX = data.visibilityDistanceAge & RTXDI_CompactDIReservoir_VisibilityChannelMask;
+    uint visY = (data.visibilityDistanceAge >> RTXDI_CompactDIReservoir_VisibilityChannelBits) & RTXDI_CompactDIReservoir_VisibilityChannelMask;
+    uint visZ = (data.visibilityDistanceAge >> (RTXDI_CompactDIReservoir_VisibilityChannelBits * 2)) & RTXDI_CompactDIReservoir_VisibilityChannelMask;
+    visX = (visX << 1) | (visX >> 4);
+    visY = (visY << 1) | (visY >> 4);
+    visZ = (visZ << 1) | (visZ >> 4);
+
+    RTXDI_DIReservoir res;
+    res.lightData = data.lightData;
+    res.uvData = u | (v << 16);
+    res.targetPdf = f16tof32(data.targetPdfWeight & 0xffff);
+    res.weightSum = f16tof32(data.targetPdfWeight >> 16);
+    res.M = data.uvM >> RTXDI_CompactDIReservoir_MShift;
+    res.packedVisibility = visX
+        | (visY << RTXDI_PackedDIReservoir_VisibilityChannelShift)
+        | (visZ << (RTXDI_PackedDIReservoir_VisibilityChannelShift * 2));
+    // Sign extend the shift values
+    res.spatialDistance.x = int(data.visibilityDistanceAge << (32 - RTXDI_CompactDIReservoir_DistanceXShift - RTXDI_CompactDIReservoir_DistanceChannelBits)) >> (32 - RTXDI_CompactDIReservoir_DistanceChannelBits);
+    res.spatialDistance.y = int(data.visibilityDistanceAge << (32 - RTXDI_CompactDIReservoir_DistanceYShift - RTXDI_CompactDIReservoir_DistanceChannelBits)) >> (32 - RTXDI_CompactDIReservoir_DistanceChannelBits);
+    res.age = data.visibilityDistanceAge >> RTXDI_CompactDIReservoir_AgeShift;
+    res.canonicalWeight = 0.0f;
+
+    // Discard reservoirs that have Inf/NaN
+    if (isinf(res.weightSum) || isnan(res.weightSum)) {
+        res = RTXDI_EmptyDIReservoir();
+    }
+
+    return res;
+}
+
 RTXDI_DIReservoir RTXDI_LoadDIReservoir(
     RTXDI_ReservoirBufferParameters reservoirParams,
     uint2 reservoirPosition,
     uint reservoirArrayIndex)
 {
+#if RTXDI_SOA_DI_RESERVOIR
+    return RTXDI_UnpackDIReservoir(RTXDI_LoadDIReservoirPlanes(reservoirParams, reservoirPosition, reservoirArrayIndex, RTXDI_DIReservoirFields_All));
+#else
     uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+#if RTXDI_COMPACT_DI_RESERVOIR
+    return RTXDI_UnpackCompactDIReservoir(RTXDI_LIGHT_RESERVOIR_BUFFER[pointer]);
+#else
     return RTXDI_UnpackDIReservoir(RTXDI_LIGHT_RESERVOIR_BUFFER[pointer]);
+#endif
+#endif
+}
+
+// Loads only the given RTXDI_DIReservoirFields_* groups of a reservoir, the other fields are zero.
+// With RTXDI_SOA_DI_RESERVOIR, only the planes of these groups are read; otherwise the whole record is read
+// and the other fields are cleared, so that both layouts return the same reservoir.
+RTXDI_DIReservoir RTXDI_LoadDIReservoirFields(
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+#if RTXDI_SOA_DI_RESERVOIR
+    return RTXDI_UnpackDIReservoir(RTXDI_LoadDIReservoirPlanes(reservoirParams, reservoirPosition, reservoirArrayIndex, fields));
+#else
+    RTXDI_DIReservoir reservoir = RTXDI_LoadDIReservoir(reservoirParams, reservoirPosition, reservoirArrayIndex);
+    if ((fields & RTXDI_DIReservoirFields_Sample) == 0)
+    {
+        reservoir.lightData = 0;
+        reservoir.uvData = 0;
+    }
+    if ((fields & RTXDI_DIReservoirFields_Weights) == 0)
+    {
+        reservoir.targetPdf = 0;
+        reservoir.weightSum = 0;
+    }
+    if ((fields & RTXDI_DIReservoirFields_Reuse) == 0)
+    {
+        reservoir.M = 0;
+        reservoir.packedVisibility = 0;
+        reservoir.spatialDistance = int2(0, 0);
+        reservoir.age = 0;
+    }
+    return reservoir;
+#endif
 }
 
+#if RTXDI_ENABLE_STORE_RESERVOIR
+// Stores only the given RTXDI_DIReservoirFields_* groups of a reservoir, keeping the other fields in the buffer.
+// With RTXDI_SOA_DI_RESERVOIR, only the planes of these groups are written; otherwise the record is read back and merged.
+void RTXDI_StoreDIReservoirFields(
+    const RTXDI_DIReservoir reservoir,
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+#if RTXDI_SOA_DI_RESERVOIR
+    RTXDI_StoreDIReservoirPlanes(RTXDI_PackDIReservoir(reservoir), reservoirParams, reservoirPosition, reservoirArrayIndex, fields);
+#else
+    RTXDI_DIReservoir merged = reservoir;
+    if (fields != RTXDI_DIReservoirFields_All)
+    {
+        RTXDI_DIReservoir stored = RTXDI_LoadDIReservoir(reservoirParams, reservoirPosition, reservoirArrayIndex);
+        if ((fields & RTXDI_DIReservoirFields_Sample) == 0)
+        {
+            merged.lightData = stored.lightData;
+            merged.uvData = stored.uvData;
+        }
+        if ((fields & RTXDI_DIReservoirFields_Weights) == 0)
+        {
+            merged.targetPdf = stored.targetPdf;
+            merged.weightSum = stored.weightSum;
+        }
+        if ((fields & RTXDI_DIReservoirFields_Reuse) == 0)
+        {
+            merged.M = stored.M;
+            merged.packedVisibility = stored.packedVisibility;
+            merged.spatialDistance = stored.spatialDistance;
+            merged.age = stored.age;
+        }
+    }
+    RTXDI_StoreDIReservoir(merged, reservoirParams, reservoirPosition, reservoirArrayIndex);
+#endif
+}
+#endif // RTXDI_ENABLE_STORE_RESERVOIR
+
 void RTXDI_StoreVisibilityInDIReservoir(
-    inout RTXDI_DIReservoir reservoir,
+    RTXDI_INOUT(RTXDI_DIReservoir) reservoir,
     float3 visibility,
     bool discardIfInvisible)
 {
@@ -199,7 +454,7 @@ struct RTXDI_VisibilityReuseParameters
 bool RTXDI_GetDIReservoirVisibility(
     const RTXDI_DIReservoir reservoir,
     const RTXDI_VisibilityReuseParameters params,
-    out float3 o_visibility)
+    RTXDI_OUT(float3) o_visibility)
 {
     if (reservoir.age > 0 &&
         reservoir.age <= params.maxAge &&
@@ -239,7 +494,7 @@ float RTXDI_GetDIReservoirInvPdf(const RTXDI_DIReservoir reservoir)
 // Adds a new, non-reservoir light sample into the reservoir, returns true if this sample was selected.
 // Algorithm (3) from the ReSTIR paper, Streaming RIS using weighted reservoir sampling.
 bool RTXDI_StreamSample(
-    inout RTXDI_DIReservoir reservoir,
+    RTXDI_INOUT(RTXDI_DIReservoir) reservoir,
     uint lightIndex,
     float2 uv,
     float random,
@@ -275,7 +530,7 @@ bool RTXDI_StreamSample(
 // rather than computing them from `newReservoir`.  Named "internal" since these parameters take
 // different meanings (e.g., in RTXDI_CombineDIReservoirs() or RTXDI_StreamNeighborWithPairwiseMIS())
 bool RTXDI_InternalSimpleResample(
-    inout RTXDI_DIReservoir reservoir,
+    RTXDI_INOUT(RTXDI_DIReservoir) reservoir,
     const RTXDI_DIReservoir newReservoir,
     float random,
     float targetPdf RTXDI_DEFAULT(1.0f),            // Usually closely related to the sample normalization, 
@@ -313,7 +568,7 @@ bool RTXDI_InternalSimpleResample(
 // Algorithm (4) from the ReSTIR paper, Combining the streams of multiple reservoirs.
 // Normalization - Equation (6) - is postponed until all reservoirs are combined.
 bool RTXDI_CombineDIReservoirs(
-    inout RTXDI_DIReservoir reservoir,
+    RTXDI_INOUT(RTXDI_DIReservoir) reservoir,
     const RTXDI_DIReservoir newReservoir,
     float random,
     float targetPdf)
@@ -330,7 +585,7 @@ bool RTXDI_CombineDIReservoirs(
 
 // Performs normalization of the reservoir after streaming. Equation (6) from the ReSTIR paper.
 void RTXDI_FinalizeResampling(
-    inout RTXDI_DIReservoir reservoir,
+    RTXDI_INOUT(RTXDI_DIReservoir) reservoir,
     float normalizationNumerator,
     float normalizationDenominator)
 {
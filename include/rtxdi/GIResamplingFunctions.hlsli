@@ -26,7 +26,7 @@
 // This function assumes the newReservoir has been normalized, so its weightSum means "1/g * 1/M * \sum{g/p}"
 // and the targetPdf is a conversion factor from the newReservoir's space to the reservoir's space (integrand).
 bool RTXDI_CombineGIReservoirs(
-    inout RTXDI_GIReservoir reservoir,
+    RTXDI_INOUT(RTXDI_GIReservoir) reservoir,
     const RTXDI_GIReservoir newReservoir,
     float random,
     float targetPdf)
@@ -56,7 +56,7 @@ bool RTXDI_CombineGIReservoirs(
 
 // Performs normalization of the reservoir after streaming.
 void RTXDI_FinalizeGIResampling(
-    inout RTXDI_GIReservoir reservoir,
+    RTXDI_INOUT(RTXDI_GIReservoir) reservoir,
     float normalizationNumerator,
     float normalizationDenominator)
 {
@@ -65,7 +65,7 @@ void RTXDI_FinalizeGIResampling(
 
 // Calculate the elements of the Jacobian to transform the sample's solid angle.
 void RTXDI_CalculatePartialJacobian(const float3 recieverPos, const float3 samplePos, const float3 sampleNormal,
-    out float distanceToSurface, out float cosineEmissionAngle)
+    RTXDI_OUT(float) distanceToSurface, RTXDI_OUT(float) cosineEmissionAngle)
 {
     float3 vec = recieverPos - samplePos;
 
@@ -187,15 +187,15 @@ RTXDI_GIReservoir RTXDI_GITemporalResampling(
     const uint2 pixelPosition,
     const RAB_Surface surface,
     const RTXDI_GIReservoir inputReservoir,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     const RTXDI_RuntimeParameters params,
     const RTXDI_ReservoirBufferParameters reservoirParams,
     const RTXDI_GITemporalResamplingParameters tparams)
 {
     // Backproject this pixel to last frame
-    int2 prevPos = int2(round(float2(pixelPosition) + tparams.screenSpaceMotion.xy));
+    int2 prevPos = int2(round(RTXDI_ReprojectPixelPos(pixelPosition, tparams.screenSpaceMotion.xy, params)));
     const float expectedPrevLinearDepth = RAB_GetSurfaceLinearDepth(surface) + tparams.screenSpaceMotion.z;
-    const int radius = (params.activeCheckerboardField == 0) ? 1 : 2;
+    const int radius = max((params.activeCheckerboardField == 0) ? 1 : 2, 1 << RTXDI_GetReservoirDownscaleLog2(reservoirParams));
 
     RTXDI_GIReservoir temporalReservoir;
     bool foundTemporalReservoir = false;
@@ -231,7 +231,7 @@ RTXDI_GIReservoir RTXDI_GITemporalResampling(
             RTXDI_ApplyPermutationSampling(idx, tparams.uniformRandomNumber);
         }
 
-        RTXDI_ActivateCheckerboardPixel(idx, true, params.activeCheckerboardField);
+        RTXDI_ActivateGIReservoirPixel(idx, true, params.activeCheckerboardField, reservoirParams);
         
         // Grab shading / g-buffer data from last frame
         temporalSurface = RAB_GetGBufferSurface(idx, true);
@@ -258,8 +258,8 @@ RTXDI_GIReservoir RTXDI_GITemporalResampling(
         }
 
         // Read temporal reservoir.
-        uint2 prevReservoirPos = RTXDI_PixelPosToReservoirPos(idx, params.activeCheckerboardField);
-        temporalReservoir = RTXDI_LoadGIReservoir(reservoirParams, prevReservoirPos, tparams.sourceBufferIndex);
+        uint2 prevReservoirPos = RTXDI_GIPixelPosToReservoirPos(idx, params.activeCheckerboardField, reservoirParams);
+        temporalReservoir = RTXDI_LoadGIReservoirAtSurface(reservoirParams, prevReservoirPos, tparams.sourceBufferIndex, RAB_GetSurfaceWorldPos(temporalSurface));
 
         // Check if the reservoir is a valid one.
         if (!RTXDI_IsValidGIReservoir(temporalReservoir))
@@ -271,6 +271,9 @@ RTXDI_GIReservoir RTXDI_GITemporalResampling(
         break;
     }
 
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCHES, 1);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCH_FAILURES, foundTemporalReservoir ? 0 : 1);
+
     RTXDI_GIReservoir curReservoir = RTXDI_EmptyGIReservoir();
 
     float selectedTargetPdf = 0;
@@ -330,6 +333,7 @@ RTXDI_GIReservoir RTXDI_GITemporalResampling(
 #if RTXDI_GI_ALLOWED_BIAS_CORRECTION >= RTXDI_BIAS_CORRECTION_RAY_TRACED
             if (tparams.biasCorrectionMode == RTXDI_BIAS_CORRECTION_RAY_TRACED && temporalP > 0)
             {
+                RTXDI_IncrementCounter(RTXDI_COUNTER_BIAS_CORRECTION_RAYS, 1);
                 if (!RAB_GetTemporalConservativeVisibility(surface, temporalSurface, curReservoir.position))
                 {
                     temporalP = 0;
@@ -392,7 +396,7 @@ RTXDI_GIReservoir RTXDI_GISpatialResampling(
     const uint2 pixelPosition,
     const RAB_Surface surface,
     const RTXDI_GIReservoir inputReservoir,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     const RTXDI_RuntimeParameters params,
     const RTXDI_ReservoirBufferParameters reservoirParams,
     const RTXDI_GISpatialResamplingParameters sparams)
@@ -416,17 +420,17 @@ RTXDI_GIReservoir RTXDI_GISpatialResampling(
     // Since we're using our bias correction scheme, we need to remember which light selection we made
     int selected = -1;
 
-    const int neighborSampleStartIdx = int(RAB_GetNextRandom(rng) * params.neighborOffsetMask);
+    const int neighborSampleStartIdx = int(RTXDI_GetNeighborSampleStartIndex(RAB_GetNextRandom(rng), params.neighborOffsetMask));
 
     // Walk the specified number of spatial neighbors, resampling using RIS
     for (int i = 0; i < numSamples; ++i)
     {
         // Get screen-space location of neighbor
-        int2 idx = int2(pixelPosition) + RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, sparams.samplingRadius, params.neighborOffsetMask);
+        int2 idx = int2(pixelPosition) + RTXDI_RotateNeighborOffset(RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, sparams.samplingRadius, params.neighborOffsetMask), pixelPosition);
 
         idx = RAB_ClampSamplePositionIntoView(idx, false);
 
-        RTXDI_ActivateCheckerboardPixel(idx, false, params.activeCheckerboardField);
+        RTXDI_ActivateGIReservoirPixel(idx, false, params.activeCheckerboardField, reservoirParams);
 
         RAB_Surface neighborSurface = RAB_GetGBufferSurface(idx, false);
 
@@ -445,8 +449,8 @@ RTXDI_GIReservoir RTXDI_GISpatialResampling(
             continue;
         }
 
-        const uint2 neighborReservoirPos = RTXDI_PixelPosToReservoirPos(idx, params.activeCheckerboardField);
-        RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoir(reservoirParams, neighborReservoirPos, sparams.sourceBufferIndex);
+        const uint2 neighborReservoirPos = RTXDI_GIPixelPosToReservoirPos(idx, params.activeCheckerboardField, reservoirParams);
+        RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoirAtSurface(reservoirParams, neighborReservoirPos, sparams.sourceBufferIndex, RAB_GetSurfaceWorldPos(neighborSurface));
 
         if (!RTXDI_IsValidGIReservoir(neighborReservoir))
         {
@@ -496,17 +500,17 @@ RTXDI_GIReservoir RTXDI_GISpatialResampling(
             if ((cachedResult & (1u << uint(i))) == 0) continue;
 
             // Get the screen-space location of our neighbor
-            int2 idx = int2(pixelPosition) + RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, sparams.samplingRadius, params.neighborOffsetMask);
+            int2 idx = int2(pixelPosition) + RTXDI_RotateNeighborOffset(RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, sparams.samplingRadius, params.neighborOffsetMask), pixelPosition);
 
             idx = RAB_ClampSamplePositionIntoView(idx, false);
 
-            RTXDI_ActivateCheckerboardPixel(idx, false, params.activeCheckerboardField);
+            RTXDI_ActivateGIReservoirPixel(idx, false, params.activeCheckerboardField, reservoirParams);
 
             // Load our neighbor's G-buffer and its GI reservoir again.
             RAB_Surface neighborSurface = RAB_GetGBufferSurface(idx, false);
 
-            const uint2 neighborReservoirPos = RTXDI_PixelPosToReservoirPos(idx, params.activeCheckerboardField);
-            RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoir(reservoirParams, neighborReservoirPos, sparams.sourceBufferIndex);
+            const uint2 neighborReservoirPos = RTXDI_GIPixelPosToReservoirPos(idx, params.activeCheckerboardField, reservoirParams);
+            RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoirAtSurface(reservoirParams, neighborReservoirPos, sparams.sourceBufferIndex, RAB_GetSurfaceWorldPos(neighborSurface));
 
             // Get the PDF of the sample RIS selected in the first loop, above, *at this neighbor*
             float ps = RAB_GetGISampleTargetPdfForSurface(curReservoir.position, curReservoir.radiance, neighborSurface);
@@ -515,6 +519,7 @@ RTXDI_GIReservoir RTXDI_GISpatialResampling(
 #if RTXDI_GI_ALLOWED_BIAS_CORRECTION >= RTXDI_BIAS_CORRECTION_RAY_TRACED
             if (sparams.biasCorrectionMode == RTXDI_BIAS_CORRECTION_RAY_TRACED && ps > 0)
             {
+                RTXDI_IncrementCounter(RTXDI_COUNTER_BIAS_CORRECTION_RAYS, 1);
                 if (!RAB_GetConservativeVisibility(neighborSurface, curReservoir.position))
                 {
                     ps = 0;
@@ -612,13 +617,13 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
     const uint2 pixelPosition,
     const RAB_Surface surface,
     RTXDI_GIReservoir inputReservoir,
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     const RTXDI_RuntimeParameters params,
     const RTXDI_ReservoirBufferParameters reservoirParams,
     const RTXDI_GISpatioTemporalResamplingParameters stparams)
 {
     // Backproject this pixel to last frame
-    int2 prevPos = int2(round(float2(pixelPosition) + stparams.screenSpaceMotion.xy));
+    int2 prevPos = int2(round(RTXDI_ReprojectPixelPos(pixelPosition, stparams.screenSpaceMotion.xy, params)));
     const float expectedPrevLinearDepth = RAB_GetSurfaceLinearDepth(surface) + stparams.screenSpaceMotion.z;
 
     // The current reservoir.
@@ -657,8 +662,8 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
     const int totalSampleCount = min(totalTemporalSampleCount + int(stparams.numSpatialSamples), 32);
 
     const int temporalSampleStartIdx = int(RAB_GetNextRandom(rng) * 8);
-    const int temporalJitterRadius = (params.activeCheckerboardField == 0) ? 1 : 2;
-    const int neighborSampleStartIdx = int(RAB_GetNextRandom(rng) * params.neighborOffsetMask);
+    const int temporalJitterRadius = max((params.activeCheckerboardField == 0) ? 1 : 2, 1 << RTXDI_GetReservoirDownscaleLog2(reservoirParams));
+    const int neighborSampleStartIdx = int(RTXDI_GetNeighborSampleStartIndex(RAB_GetNextRandom(rng), params.neighborOffsetMask));
 
     // Walk the specified number of spatial neighbors, resampling using RIS
     for (int i = 0; i < totalSampleCount; ++i)
@@ -706,11 +711,11 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
         }
         else
         {
-            idx = prevPos + RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, stparams.samplingRadius, params.neighborOffsetMask);
+            idx = prevPos + RTXDI_RotateNeighborOffset(RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, stparams.samplingRadius, params.neighborOffsetMask), pixelPosition);
             idx = RAB_ClampSamplePositionIntoView(idx, true);
         }
 
-        RTXDI_ActivateCheckerboardPixel(idx, true, params.activeCheckerboardField);
+        RTXDI_ActivateGIReservoirPixel(idx, true, params.activeCheckerboardField, reservoirParams);
 
         RAB_Surface neighborSurface = RAB_GetGBufferSurface(idx, true);
 
@@ -730,8 +735,8 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
             continue;
         }
 
-        const uint2 neighborReservoirPos = RTXDI_PixelPosToReservoirPos(idx, params.activeCheckerboardField);
-        RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoir(reservoirParams, neighborReservoirPos, stparams.sourceBufferIndex);
+        const uint2 neighborReservoirPos = RTXDI_GIPixelPosToReservoirPos(idx, params.activeCheckerboardField, reservoirParams);
+        RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoirAtSurface(reservoirParams, neighborReservoirPos, stparams.sourceBufferIndex, RAB_GetSurfaceWorldPos(neighborSurface));
 
         if (!RTXDI_IsValidGIReservoir(neighborReservoir))
         {
@@ -777,6 +782,9 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
         }
     }
 
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCHES, 1);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_TEMPORAL_SEARCH_FAILURES, foundTemporalSurface ? 0 : 1);
+
 #if RTXDI_GI_ALLOWED_BIAS_CORRECTION >= RTXDI_BIAS_CORRECTION_BASIC
     if (stparams.biasCorrectionMode >= RTXDI_BIAS_CORRECTION_BASIC)
     {
@@ -814,17 +822,17 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
             }
             else
             {
-                idx = prevPos + RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, stparams.samplingRadius, params.neighborOffsetMask);
+                idx = prevPos + RTXDI_RotateNeighborOffset(RTXDI_CalculateSpatialResamplingOffset(neighborSampleStartIdx + i, stparams.samplingRadius, params.neighborOffsetMask), pixelPosition);
                 idx = RAB_ClampSamplePositionIntoView(idx, true);
             }
 
-            RTXDI_ActivateCheckerboardPixel(idx, true, params.activeCheckerboardField);
+            RTXDI_ActivateGIReservoirPixel(idx, true, params.activeCheckerboardField, reservoirParams);
 
             // Load our neighbor's G-buffer and its GI reservoir again.
             RAB_Surface neighborSurface = RAB_GetGBufferSurface(idx, true);
 
-            const uint2 neighborReservoirPos = RTXDI_PixelPosToReservoirPos(idx, params.activeCheckerboardField);
-            RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoir(reservoirParams, neighborReservoirPos, stparams.sourceBufferIndex);
+            const uint2 neighborReservoirPos = RTXDI_GIPixelPosToReservoirPos(idx, params.activeCheckerboardField, reservoirParams);
+            RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoirAtSurface(reservoirParams, neighborReservoirPos, stparams.sourceBufferIndex, RAB_GetSurfaceWorldPos(neighborSurface));
 
             // Clamp history length
             neighborReservoir.M = min(neighborReservoir.M, stparams.maxHistoryLength);
@@ -842,6 +850,7 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
                 else
                     fallbackSurface = neighborSurface;
 
+                RTXDI_IncrementCounter(RTXDI_COUNTER_BIAS_CORRECTION_RAYS, 1);
                 if (!RAB_GetTemporalConservativeVisibility(fallbackSurface, neighborSurface, curReservoir.position))
                 {
                     ps = 0;
@@ -879,17 +888,95 @@ RTXDI_GIReservoir RTXDI_GISpatioTemporalResampling(
     return curReservoir;
 }
 
+// Reconstructs a reservoir for a full-resolution pixel from quarter-resolution GI reservoirs, for final shading.
+// The samples of the 2x2 reservoirs whose quads are nearest to the pixel are reweighted for the pixel's surface
+// using their stored positions and combined with RIS, skipping reservoirs whose surfaces are not similar to it.
+// The result is normalized with 1/M; it should not be stored for temporal reuse.
+RTXDI_GIReservoir RTXDI_GIUpsampleReservoir(
+    const uint2 pixelPosition,
+    const RAB_Surface surface,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    const RTXDI_RuntimeParameters params,
+    const RTXDI_ReservoirBufferParameters reservoirParams,
+    const uint sourceBufferIndex,
+    const float depthThreshold,
+    const float normalThreshold)
+{
+    const uint downscaleLog2 = RTXDI_GetReservoirDownscaleLog2(reservoirParams);
+
+    // Quad whose center is the nearest one above and to the left of the pixel center
+    const int2 baseQuad = (int2(pixelPosition) - ((1 << downscaleLog2) >> 1)) >> downscaleLog2;
+
+    RTXDI_GIReservoir curReservoir = RTXDI_EmptyGIReservoir();
+    float selectedTargetPdf = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int2 idx = (baseQuad + int2(i & 1, i >> 1)) * (1 << downscaleLog2);
+
+        idx = RAB_ClampSamplePositionIntoView(idx, false);
+
+        RTXDI_ActivateGIReservoirPixel(idx, false, params.activeCheckerboardField, reservoirParams);
+
+        RAB_Surface neighborSurface = RAB_GetGBufferSurface(idx, false);
+
+        if (!RTXDI_IsValidNeighbor(
+            RAB_GetSurfaceNormal(surface), RAB_GetSurfaceNormal(neighborSurface),
+            RAB_GetSurfaceLinearDepth(surface), RAB_GetSurfaceLinearDepth(neighborSurface),
+            normalThreshold, depthThreshold))
+        {
+            continue;
+        }
+
+        if (!RAB_AreMaterialsSimilar(surface, neighborSurface))
+        {
+            continue;
+        }
+
+        const uint2 neighborReservoirPos = RTXDI_GIPixelPosToReservoirPos(idx, params.activeCheckerboardField, reservoirParams);
+        RTXDI_GIReservoir neighborReservoir = RTXDI_LoadGIReservoirAtSurface(reservoirParams, neighborReservoirPos, sourceBufferIndex, RAB_GetSurfaceWorldPos(neighborSurface));
+
+        if (!RTXDI_IsValidGIReservoir(neighborReservoir))
+        {
+            continue;
+        }
+
+        float jacobian = RTXDI_CalculateJacobian(RAB_GetSurfaceWorldPos(surface), RAB_GetSurfaceWorldPos(neighborSurface), neighborReservoir);
+
+        if (!RAB_ValidateGISampleWithJacobian(jacobian))
+        {
+            continue;
+        }
+
+        neighborReservoir.weightSum *= jacobian;
+
+        float targetPdf = RAB_GetGISampleTargetPdfForSurface(neighborReservoir.position, neighborReservoir.radiance, surface);
+
+        if (RTXDI_CombineGIReservoirs(curReservoir, neighborReservoir, RAB_GetNextRandom(rng), targetPdf))
+        {
+            selectedTargetPdf = targetPdf;
+        }
+    }
+
+    RTXDI_FinalizeGIResampling(curReservoir, 1.0, curReservoir.M * selectedTargetPdf);
+
+    return curReservoir;
+}
+
 #ifdef RTXDI_ENABLE_BOILING_FILTER
 
 // Same as RTXDI_BoilingFilter but for GI reservoirs.
 void RTXDI_GIBoilingFilter(
     uint2 LocalIndex,
     float filterStrength, // (0..1]
-    inout RTXDI_GIReservoir reservoir)
+    RTXDI_INOUT(RTXDI_GIReservoir) reservoir)
 {
     float weight = RTXDI_Luminance(reservoir.radiance) * reservoir.weightSum;
 
-    if (RTXDI_BoilingFilterInternal(LocalIndex, filterStrength, weight))
+    bool discard = RTXDI_BoilingFilterInternal(LocalIndex, filterStrength, weight);
+    RTXDI_IncrementCounter(RTXDI_COUNTER_BOILING_FILTER_REJECTIONS, discard ? 1 : 0);
+
+    if (discard)
         reservoir = RTXDI_EmptyGIReservoir();
 }
 
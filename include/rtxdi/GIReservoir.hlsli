@@ -21,7 +21,11 @@
 #endif
 
 #ifndef RTXDI_GI_RESERVOIR_BUFFER
-#error "RTXDI_GI_RESERVOIR_BUFFER must be defined to point to a RWStructuredBuffer<RTXDI_PackedGIReservoir> type resource"
+#error "RTXDI_GI_RESERVOIR_BUFFER must be defined to point to a RWStructuredBuffer<RTXDI_PackedGIReservoir> type resource, or RWStructuredBuffer<RTXDI_CompactGIReservoir> if RTXDI_COMPACT_GI_RESERVOIR is 1, or RWStructuredBuffer<uint4> if RTXDI_SOA_GI_RESERVOIR is 1"
+#endif
+
+#if RTXDI_COMPACT_GI_RESERVOIR && RTXDI_SOA_GI_RESERVOIR
+#error "RTXDI_COMPACT_GI_RESERVOIR and RTXDI_SOA_GI_RESERVOIR cannot be used together"
 #endif
 
 // This structure represents a indirect lighting reservoir that stores the radiance and weight
@@ -48,6 +52,40 @@ struct RTXDI_GIReservoir
     uint age;
 };
 
+// Pixel to reservoir mapping of the GI reservoir buffers. With quarter-resolution reservoirs, each reservoir covers
+// a 2x2 pixel quad and belongs to the top-left pixel of the quad, whose surface is used to resample it;
+// the checkerboard field is ignored. Otherwise the mapping is the same as for DI reservoirs.
+uint2 RTXDI_GIPixelPosToReservoirPos(uint2 pixelPosition, uint activeCheckerboardField, RTXDI_ReservoirBufferParameters reservoirParams)
+{
+    uint downscaleLog2 = RTXDI_GetReservoirDownscaleLog2(reservoirParams);
+    if (downscaleLog2 != 0)
+        return pixelPosition >> downscaleLog2;
+
+    return RTXDI_PixelPosToReservoirPos(pixelPosition, activeCheckerboardField);
+}
+
+uint2 RTXDI_GIReservoirPosToPixelPos(uint2 reservoirPosition, uint activeCheckerboardField, RTXDI_ReservoirBufferParameters reservoirParams)
+{
+    uint downscaleLog2 = RTXDI_GetReservoirDownscaleLog2(reservoirParams);
+    if (downscaleLog2 != 0)
+        return reservoirPosition << downscaleLog2;
+
+    return RTXDI_ReservoirPosToPixelPos(reservoirPosition, activeCheckerboardField);
+}
+
+// Moves a pixel position to the pixel that owns the GI reservoir covering it
+void RTXDI_ActivateGIReservoirPixel(RTXDI_INOUT(int2) pixelPosition, bool previousFrame, uint activeCheckerboardField, RTXDI_ReservoirBufferParameters reservoirParams)
+{
+    uint downscaleLog2 = RTXDI_GetReservoirDownscaleLog2(reservoirParams);
+    if (downscaleLog2 != 0)
+    {
+        pixelPosition = (pixelPosition >> downscaleLog2) << downscaleLog2;
+        return;
+    }
+
+    RTXDI_ActivateCheckerboardPixel(pixelPosition, previousFrame, activeCheckerboardField);
+}
+
 // Encoding helper constants for RTXDI_PackedGIReservoir
 static const uint RTXDI_PackedGIReservoir_MShift = 0;
 static const uint RTXDI_PackedGIReservoir_MaxM = 0x0ff;
@@ -84,7 +122,7 @@ RTXDI_PackedGIReservoir RTXDI_PackGIReservoir(const RTXDI_GIReservoir reservoir,
 
 // Converts a PackedGIReservoir into its unpacked form.
 // This function should be used only when the application wants to retrieve the misc data stored in the gap field of the packed form.
-RTXDI_GIReservoir RTXDI_UnpackGIReservoir(RTXDI_PackedGIReservoir data, out uint miscData)
+RTXDI_GIReservoir RTXDI_UnpackGIReservoir(RTXDI_PackedGIReservoir data, RTXDI_OUT(uint) miscData)
 {
     RTXDI_GIReservoir res;
 
@@ -111,35 +149,196 @@ RTXDI_GIReservoir RTXDI_UnpackGIReservoir(RTXDI_PackedGIReservoir data)
     return RTXDI_UnpackGIReservoir(data, miscFlags);
 }
 
+// Encoding helper constants for RTXDI_CompactGIReservoir.packed_distance_age_M
+static const uint RTXDI_CompactGIReservoir_DistanceMask = 0xffff;
+static const uint RTXDI_CompactGIReservoir_AgeShift = 16;
+static const uint RTXDI_CompactGIReservoir_MaxAge = 0x0ff;
+static const uint RTXDI_CompactGIReservoir_MShift = 24;
+static const uint RTXDI_CompactGIReservoir_MaxM = 0x0ff;
+static const float RTXDI_CompactGIReservoir_MaxDistance = 65504.0;
+
+// Converts a GIReservoir into its compact form. The sample position is stored as a direction and a distance
+// from receiverPosition, which is the position of the surface that owns the reservoir.
+RTXDI_CompactGIReservoir RTXDI_PackCompactGIReservoir(const RTXDI_GIReservoir reservoir, float3 receiverPosition)
+{
+    float3 offset = reservoir.position - receiverPosition;
+    float distance = length(offset);
+
+    RTXDI_CompactGIReservoir data;
+    data.packed_direction = (distance > 0.0) ? RTXDI_EncodeNormalizedVectorToSnorm2x16(offset / distance) : 0;
+    data.packed_normal = RTXDI_EncodeNormalizedVectorToSnorm2x16(reservoir.normal);
+    data.packed_radiance = RTXDI_EncodeRGBToLogLuv(reservoir.radiance);
+    data.weight = reservoir.weightSum;
+    data.packed_distance_age_M = f32tof16(min(distance, RTXDI_CompactGIReservoir_MaxDistance))
+        | (min(reservoir.age, RTXDI_CompactGIReservoir_MaxAge) << RTXDI_CompactGIReservoir_AgeShift)
+        | (min(reservoir.M, RTXDI_CompactGIReservoir_MaxM) << RTXDI_CompactGIReservoir_MShift);
+
+    return data;
+}
+
+// Converts a CompactGIReservoir into its unpacked form, receiverPosition must be the position used to pack it.
+RTXDI_GIReservoir RTXDI_UnpackCompactGIReservoir(RTXDI_CompactGIReservoir data, float3 receiverPosition)
+{
+    float distance = f16tof32(data.packed_distance_age_M & RTXDI_CompactGIReservoir_DistanceMask);
+
+    RTXDI_GIReservoir res;
+    res.position = receiverPosition + RTXDI_DecodeNormalizedVectorFromSnorm2x16(data.packed_direction) * distance;
+    res.normal = RTXDI_DecodeNormalizedVectorFromSnorm2x16(data.packed_normal);
+    res.radiance = RTXDI_DecodeLogLuvToRGB(data.packed_radiance);
+    res.weightSum = data.weight;
+    res.M = (data.packed_distance_age_M >> RTXDI_CompactGIReservoir_MShift) & RTXDI_CompactGIReservoir_MaxM;
+    res.age = (data.packed_distance_age_M >> RTXDI_CompactGIReservoir_AgeShift) & RTXDI_CompactGIReservoir_MaxAge;
+
+    return res;
+}
+
+#if !RTXDI_COMPACT_GI_RESERVOIR
+
+// Field groups of RTXDI_GIReservoir for RTXDI_LoadGIReservoirFields and RTXDI_StoreGIReservoirFields,
+// each group is one plane of the SoA layout
+static const uint RTXDI_GIReservoirFields_Sample = 0x1;     // position, normal
+static const uint RTXDI_GIReservoirFields_Weights = 0x2;    // radiance, weightSum, M, age, misc data
+static const uint RTXDI_GIReservoirFields_All = 0x3;
+
+// Reads the requested field groups of a packed reservoir, the fields of the other groups are zero.
+// With RTXDI_SOA_GI_RESERVOIR, only the planes of these groups are read; otherwise the whole record is read
+// and the other fields are cleared, so that both layouts return the same reservoir.
+RTXDI_PackedGIReservoir RTXDI_LoadPackedGIReservoir(
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+#if RTXDI_SOA_GI_RESERVOIR
+    RTXDI_PackedGIReservoir data;
+    data.position = float3(0.0, 0.0, 0.0);
+    data.packed_normal = 0;
+    data.packed_radiance = 0;
+    data.weight = 0;
+    data.packed_miscData_age_M = 0;
+    data.unused = 0;
+
+    if ((fields & RTXDI_GIReservoirFields_Sample) != 0)
+    {
+        uint4 plane = RTXDI_GI_RESERVOIR_BUFFER[pointer];
+        data.position = float3(asfloat(plane.x), asfloat(plane.y), asfloat(plane.z));
+        data.packed_normal = plane.w;
+    }
+
+    if ((fields & RTXDI_GIReservoirFields_Weights) != 0)
+    {
+        uint4 plane = RTXDI_GI_RESERVOIR_BUFFER[pointer + reservoirParams.reservoirPlanePitch];
+        data.packed_radiance = plane.x;
+        data.weight = asfloat(plane.y);
+        data.packed_miscData_age_M = plane.z;
+    }
+
+    return data;
+#else
+    RTXDI_PackedGIReservoir data = RTXDI_GI_RESERVOIR_BUFFER[pointer];
+    if ((fields & RTXDI_GIReservoirFields_Sample) == 0)
+    {
+        data.position = float3(0.0, 0.0, 0.0);
+        data.packed_normal = 0;
+    }
+    if ((fields & RTXDI_GIReservoirFields_Weights) == 0)
+    {
+        data.packed_radiance = 0;
+        data.weight = 0;
+        data.packed_miscData_age_M = 0;
+    }
+    return data;
+#endif
+}
+
 RTXDI_GIReservoir RTXDI_LoadGIReservoir(
     RTXDI_ReservoirBufferParameters reservoirParams,
     uint2 reservoirPosition,
     uint reservoirArrayIndex)
 {
-    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
-    return RTXDI_UnpackGIReservoir(RTXDI_GI_RESERVOIR_BUFFER[pointer]);
+    return RTXDI_UnpackGIReservoir(RTXDI_LoadPackedGIReservoir(reservoirParams, reservoirPosition, reservoirArrayIndex, RTXDI_GIReservoirFields_All));
 }
 
 RTXDI_GIReservoir RTXDI_LoadGIReservoir(
     RTXDI_ReservoirBufferParameters reservoirParams,
     uint2 reservoirPosition,
     uint reservoirArrayIndex,
-    out uint miscFlags)
+    RTXDI_OUT(uint) miscFlags)
 {
-    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
-    return RTXDI_UnpackGIReservoir(RTXDI_GI_RESERVOIR_BUFFER[pointer], miscFlags);
+    return RTXDI_UnpackGIReservoir(RTXDI_LoadPackedGIReservoir(reservoirParams, reservoirPosition, reservoirArrayIndex, RTXDI_GIReservoirFields_All), miscFlags);
+}
+
+// Loads only the given RTXDI_GIReservoirFields_* groups of a reservoir, see RTXDI_LoadPackedGIReservoir
+RTXDI_GIReservoir RTXDI_LoadGIReservoirFields(
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+    return RTXDI_UnpackGIReservoir(RTXDI_LoadPackedGIReservoir(reservoirParams, reservoirPosition, reservoirArrayIndex, fields));
 }
 
 #if RTXDI_ENABLE_STORE_RESERVOIR
 
+// Writes the requested field groups of a packed reservoir, keeping the other fields in the buffer.
+// With RTXDI_SOA_GI_RESERVOIR, only the planes of these groups are written; otherwise the record is read back and merged.
+void RTXDI_StorePackedGIReservoirFields(
+    const RTXDI_PackedGIReservoir packedGIReservoir,
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+#if RTXDI_SOA_GI_RESERVOIR
+    if ((fields & RTXDI_GIReservoirFields_Sample) != 0)
+        RTXDI_GI_RESERVOIR_BUFFER[pointer] = uint4(asuint(packedGIReservoir.position.x), asuint(packedGIReservoir.position.y),
+            asuint(packedGIReservoir.position.z), packedGIReservoir.packed_normal);
+
+    if ((fields & RTXDI_GIReservoirFields_Weights) != 0)
+        RTXDI_GI_RESERVOIR_BUFFER[pointer + reservoirParams.reservoirPlanePitch] = uint4(packedGIReservoir.packed_radiance,
+            asuint(packedGIReservoir.weight), packedGIReservoir.packed_miscData_age_M, 0);
+#else
+    RTXDI_PackedGIReservoir merged = packedGIReservoir;
+    if (fields != RTXDI_GIReservoirFields_All)
+    {
+        RTXDI_PackedGIReservoir stored = RTXDI_GI_RESERVOIR_BUFFER[pointer];
+        if ((fields & RTXDI_GIReservoirFields_Sample) == 0)
+        {
+            merged.position = stored.position;
+            merged.packed_normal = stored.packed_normal;
+        }
+        if ((fields & RTXDI_GIReservoirFields_Weights) == 0)
+        {
+            merged.packed_radiance = stored.packed_radiance;
+            merged.weight = stored.weight;
+            merged.packed_miscData_age_M = stored.packed_miscData_age_M;
+        }
+    }
+    RTXDI_GI_RESERVOIR_BUFFER[pointer] = merged;
+#endif
+}
+
 void RTXDI_StorePackedGIReservoir(
     const RTXDI_PackedGIReservoir packedGIReservoir,
     RTXDI_ReservoirBufferParameters reservoirParams,
     uint2 reservoirPosition,
     uint reservoirArrayIndex)
 {
-    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
-    RTXDI_GI_RESERVOIR_BUFFER[pointer] = packedGIReservoir;
+    RTXDI_StorePackedGIReservoirFields(packedGIReservoir, reservoirParams, reservoirPosition, reservoirArrayIndex, RTXDI_GIReservoirFields_All);
+}
+
+// Stores only the given RTXDI_GIReservoirFields_* groups of a reservoir, see RTXDI_StorePackedGIReservoirFields
+void RTXDI_StoreGIReservoirFields(
+    const RTXDI_GIReservoir reservoir,
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    uint fields)
+{
+    RTXDI_StorePackedGIReservoirFields(
+        RTXDI_PackGIReservoir(reservoir, 0), reservoirParams, reservoirPosition, reservoirArrayIndex, fields);
 }
 
 void RTXDI_StoreGIReservoir(
@@ -165,6 +364,44 @@ void RTXDI_StoreGIReservoir(
 
 #endif // RTXDI_ENABLE_STORE_RESERVOIR
 
+#endif // !RTXDI_COMPACT_GI_RESERVOIR
+
+// Loads a reservoir owned by the surface at receiverPosition. Works with every storage format,
+// receiverPosition is only used by RTXDI_COMPACT_GI_RESERVOIR.
+RTXDI_GIReservoir RTXDI_LoadGIReservoirAtSurface(
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex,
+    float3 receiverPosition)
+{
+#if RTXDI_COMPACT_GI_RESERVOIR
+    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+    return RTXDI_UnpackCompactGIReservoir(RTXDI_GI_RESERVOIR_BUFFER[pointer], receiverPosition);
+#else
+    RTXDI_UNUSED(receiverPosition);
+    return RTXDI_LoadGIReservoir(reservoirParams, reservoirPosition, reservoirArrayIndex);
+#endif
+}
+
+#if RTXDI_ENABLE_STORE_RESERVOIR
+// Stores a reservoir owned by the surface at receiverPosition, see RTXDI_LoadGIReservoirAtSurface
+void RTXDI_StoreGIReservoirAtSurface(
+    const RTXDI_GIReservoir reservoir,
+    float3 receiverPosition,
+    RTXDI_ReservoirBufferParameters reservoirParams,
+    uint2 reservoirPosition,
+    uint reservoirArrayIndex)
+{
+#if RTXDI_COMPACT_GI_RESERVOIR
+    uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, reservoirArrayIndex);
+    RTXDI_GI_RESERVOIR_BUFFER[pointer] = RTXDI_PackCompactGIReservoir(reservoir, receiverPosition);
+#else
+    RTXDI_UNUSED(receiverPosition);
+    RTXDI_StoreGIReservoir(reservoir, reservoirParams, reservoirPosition, reservoirArrayIndex);
+#endif
+}
+#endif // RTXDI_ENABLE_STORE_RESERVOIR
+
 RTXDI_GIReservoir RTXDI_EmptyGIReservoir()
 {
     RTXDI_GIReservoir s;
@@ -11,15 +11,18 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "rtxdi/ReSTIRDI.h"
 #include "rtxdi/ReGIR.h"
 #include "rtxdi/ReSTIRGI.h"
+#include "rtxdi/ImportanceSamplingParameters.h"
 
 namespace rtxdi
 {
 
 class RISBufferSegmentAllocator;
+struct RISBufferSegmentMove;
 struct ReSTIRDIStaticParameters;
 struct ReGIRStaticParameters;
 struct ReSTIRGIStaticParameters;
@@ -34,24 +37,58 @@ struct ImportanceSamplingContext_StaticParameters
     uint32_t NeighborOffsetCount = 8192;
     uint32_t renderWidth = 0;
     uint32_t renderHeight = 0;
+    // Largest render size accepted by resize() without reallocating the reservoir buffers, 0 means the initial size
+    uint32_t maxRenderWidth = 0;
+    uint32_t maxRenderHeight = 0;
     CheckerboardMode CheckerboardSamplingMode = CheckerboardMode::Off;
+    ReservoirLayout DIReservoirLayout = ReservoirLayout::ArrayOfStructures;
+    ReservoirLayout GIReservoirLayout = ReservoirLayout::ArrayOfStructures;
+    uint32_t reservoirBlockSize = RTXDI_RESERVOIR_BLOCK_SIZE;
+    ReservoirBlockOrder reservoirBlockOrder = ReservoirBlockOrder::RowMajor;
+    // Quarter resolution GI reservoirs use CheckerboardMode::Off regardless of CheckerboardSamplingMode
+    ReSTIRGI_ReservoirResolution GIReservoirResolution = ReSTIRGI_ReservoirResolution::Full;
+
+    // Number of views (split-screen players, stereo eyes) rendered with the context.
+    // All views share the light presampling RIS tiles and the ReGIR structure.
+    // Each view has its own ReSTIR DI and GI contexts, whose reservoirs are stored in consecutive
+    // arrays of shared reservoir buffers: view V uses the DI arrays starting at V * c_NumReSTIRDIReservoirBuffers
+    // and the GI arrays starting at V * c_NumReSTIRGIReservoirBuffers.
+    uint32_t viewCount = 1;
 
     // ReGIR params
     ReGIRStaticParameters regirStaticParams = {};
 };
 
+// Sections of RTXDI_ImportanceSamplingParameters that are tracked separately by packConstantBuffer
+enum class ImportanceSamplingContext_ConstantBufferSection : uint32_t
+{
+    LightBuffer,
+    RuntimeParams,
+    RISBufferSegments,
+    ReSTIRDI,
+    ReSTIRGI,
+    ReGIR,
+
+    Count
+};
+
 class ImportanceSamplingContext
 {
 public:
     ImportanceSamplingContext(const ImportanceSamplingContext_StaticParameters& isParams);
     ~ImportanceSamplingContext();
 
-    ReSTIRDIContext& getReSTIRDIContext();
-    const ReSTIRDIContext& getReSTIRDIContext() const;
+    ReSTIRDIContext& getReSTIRDIContext(uint32_t viewIndex = 0);
+    const ReSTIRDIContext& getReSTIRDIContext(uint32_t viewIndex = 0) const;
     ReGIRContext& getReGIRContext();
     const ReGIRContext& getReGIRContext() const;
-    ReSTIRGIContext& getReSTIRGIContext();
-    const ReSTIRGIContext& getReSTIRGIContext() const;
+    ReSTIRGIContext& getReSTIRGIContext(uint32_t viewIndex = 0);
+    const ReSTIRGIContext& getReSTIRGIContext(uint32_t viewIndex = 0) const;
+
+    uint32_t getViewCount() const;
+    // Number of reservoir arrays to allocate in the DI and GI reservoir buffers for all views
+    uint32_t getReSTIRDIReservoirArrayCount() const;
+    uint32_t getReSTIRGIReservoirArrayCount() const;
 
     const RISBufferSegmentAllocator& getRISBufferSegmentAllocator() const;
 
@@ -61,20 +98,66 @@ public:
     uint32_t getNeighborOffsetCount() const;
 
     bool isLocalLightPowerRISEnabled() const;
+    bool isLocalLightAliasRISEnabled() const;
     bool isReGIREnabled() const;
 
     void setLightBufferParams(const RTXDI_LightBufferParameters& lightBufferParams);
 
+    // Change the presampling RIS tiles or the ReGIR static parameters without recreating the context.
+    // The segment of the owner is released and a new one is allocated in the RIS buffer, possibly at another offset,
+    // which packConstantBuffer picks up. The contents of the new segment are undefined until the next presampling
+    // or ReGIR build pass. Returns false if the RIS buffer must be reallocated, because the allocator's total size grew.
+    bool setLocalLightRISBufferParams(const RISBufferSegmentParameters& localLightRISBufferParams);
+    bool setEnvironmentLightRISBufferParams(const RISBufferSegmentParameters& environmentLightRISBufferParams);
+    bool setReGIRStaticParameters(const ReGIRStaticParameters& regirStaticParams);
+
+    // Compacts the RIS buffer, see RISBufferSegmentAllocator::compact, and moves the segments of all owners.
+    // The application must execute the appended copies in order before the next pass that reads the RIS buffer,
+    // and can then shrink the buffer to getRISBufferSegmentAllocator().getTotalSizeInElements() elements.
+    void compactRISBuffer(std::vector<RISBufferSegmentMove>& moves);
+
+    // Resizes the ReSTIR DI and GI contexts of all views, see ReSTIRDIContext::resize.
+    // Returns false if the reservoir buffers must be reallocated for the new size.
+    bool resize(uint32_t renderWidth, uint32_t renderHeight);
+
+    // Writes the parameters of the shared contexts and the contexts of one view into a RTXDI_ImportanceSamplingParameters block in caller memory,
+    // which must be 16-byte aligned and getConstantBufferSize() bytes large.
+    // Only the sections that changed since the previous call are written, so the memory must keep its contents
+    // between calls, unless writeAllSections is set. Returns a mask of the written sections,
+    // (1 << ImportanceSamplingContext_ConstantBufferSection), which can be used to upload only these byte ranges.
+    // Changes are tracked per view, so each view needs its own constant buffer.
+    uint32_t packConstantBuffer(void* destination, bool writeAllSections = false, uint32_t viewIndex = 0);
+
+    // Incremented every time packConstantBuffer finds that the contents of the section changed for the view
+    uint64_t getConstantBufferSectionGeneration(ImportanceSamplingContext_ConstantBufferSection section, uint32_t viewIndex = 0) const;
+
+    static uint32_t getConstantBufferSize();
+    static uint32_t getConstantBufferSectionOffset(ImportanceSamplingContext_ConstantBufferSection section);
+    static uint32_t getConstantBufferSectionSize(ImportanceSamplingContext_ConstantBufferSection section);
+
 private:
+    // Contents of the last packConstantBuffer call for a view, used to detect changes
+    struct ConstantBufferPackState
+    {
+        RTXDI_ImportanceSamplingParameters packedConstants;
+        uint64_t generations[uint32_t(ImportanceSamplingContext_ConstantBufferSection::Count)];
+        bool valid;
+    };
+
     std::unique_ptr<RISBufferSegmentAllocator> m_risBufferSegmentAllocator;
-    std::unique_ptr<ReSTIRDIContext> m_restirDIContext;
+    std::vector<std::unique_ptr<ReSTIRDIContext>> m_restirDIContexts;
     std::unique_ptr<ReGIRContext> m_regirContext;
-    std::unique_ptr<ReSTIRGIContext> m_restirGIContext;
+    std::vector<std::unique_ptr<ReSTIRGIContext>> m_restirGIContexts;
 
     // Common buffer params
     RTXDI_LightBufferParameters m_lightBufferParams;
     RTXDI_RISBufferSegmentParameters m_localLightRISBufferSegmentParams;
     RTXDI_RISBufferSegmentParameters m_environmentLightRISBufferSegmentParams;
+
+    std::vector<ConstantBufferPackState> m_constantBufferPackStates;
+
+    void reallocateRISBufferSegment(RTXDI_RISBufferSegmentParameters& segmentParams, const RISBufferSegmentParameters& params);
+    void fillConstantBufferSection(ImportanceSamplingContext_ConstantBufferSection section, uint32_t viewIndex, RTXDI_ImportanceSamplingParameters& params) const;
 };
 
 }
\ No newline at end of file
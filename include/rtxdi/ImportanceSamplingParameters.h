@@ -0,0 +1,33 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef RTXDI_IMPORTANCE_SAMPLING_PARAMETERS_H
+#define RTXDI_IMPORTANCE_SAMPLING_PARAMETERS_H
+
+#include "RtxdiTypes.h"
+#include "RtxdiParameters.h"
+#include "ReSTIRDIParameters.h"
+#include "ReSTIRGIParameters.h"
+#include "ReGIRParameters.h"
+
+// Constant block written by ImportanceSamplingContext::packConstantBuffer.
+// Every member is a multiple of 16 bytes, so the layout is the same in C++ and in a constant buffer.
+struct RTXDI_ImportanceSamplingParameters
+{
+    RTXDI_LightBufferParameters lightBufferParams;
+    RTXDI_RuntimeParameters runtimeParams;
+    RTXDI_RISBufferSegmentParameters localLightsRISBufferSegmentParams;
+    RTXDI_RISBufferSegmentParameters environmentLightRISBufferSegmentParams;
+    ReSTIRDI_Parameters restirDI;
+    ReSTIRGI_Parameters restirGI;
+    ReGIR_Parameters regir;
+};
+
+#endif // RTXDI_IMPORTANCE_SAMPLING_PARAMETERS_H
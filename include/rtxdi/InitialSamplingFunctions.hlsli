@@ -118,7 +118,7 @@ float RTXDI_LightBrdfMisWeight(RAB_Surface surface, RAB_LightSample lightSample,
 // Local light UV selection and reservoir streaming
 //
 
-float2 RTXDI_RandomlySelectLocalLightUV(inout RAB_RandomSamplerState rng)
+float2 RTXDI_RandomlySelectLocalLightUV(RTXDI_INOUT(RAB_RandomSamplerState) rng)
 {
     float2 uv;
     uv.x = RAB_GetNextRandom(rng);
@@ -127,15 +127,15 @@ float2 RTXDI_RandomlySelectLocalLightUV(inout RAB_RandomSamplerState rng)
 }
 
 bool RTXDI_StreamLocalLightAtUVIntoReservoir(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_SampleParameters sampleParams,
     RAB_Surface surface,
     uint lightIndex,
     float2 uv,
     float invSourcePdf,
     RAB_LightInfo lightInfo,
-    inout RTXDI_DIReservoir state,
-    inout RAB_LightSample o_selectedSample)
+    RTXDI_INOUT(RTXDI_DIReservoir) state,
+    RTXDI_INOUT(RAB_LightSample) o_selectedSample)
 {
     RAB_LightSample candidateSample = RAB_SamplePolymorphicLight(lightInfo, surface, uv);
     float blendedSourcePdf = RTXDI_LightBrdfMisWeight(surface, candidateSample, 1.0 / invSourcePdf,
@@ -163,7 +163,7 @@ bool RTXDI_StreamLocalLightAtUVIntoReservoir(
 #if RTXDI_REGIR_MODE != RTXDI_REGIR_DISABLED
 
 int RTXDI_CalculateReGIRCellIndex(
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     ReGIR_Parameters regirParams,
     RAB_Surface surface)
 {
@@ -179,9 +179,42 @@ int RTXDI_CalculateReGIRCellIndex(
     samplingPos += cellJitter * jitterScale;
 
     cellIndex = RTXDI_ReGIR_WorldPosToCellIndex(regirParams, samplingPos);
+
+#if RTXDI_REGIR_MODE == RTXDI_REGIR_HASHED
+    // Only the cells that contain visible surfaces are allocated, so the jittered position may miss
+    if (cellIndex < 0)
+        cellIndex = RTXDI_ReGIR_WorldPosToCellIndex(regirParams, RAB_GetSurfaceWorldPos(surface));
+#endif
+
     return cellIndex;
 }
 
+#if RTXDI_REGIR_MODE == RTXDI_REGIR_HASHED
+// ReGIR hashed cell allocation pass, runs on the visible surfaces after the hash table is cleared
+// and before the ReGIR build pass. Returns the cell index, or -1 if the cell couldn't be allocated.
+int RTXDI_AllocateReGIRCell(
+    ReGIR_Parameters regirParams,
+    RAB_Surface surface)
+{
+    return RTXDI_ReGIR_HashedInsertCell(regirParams, RAB_GetSurfaceWorldPos(surface));
+}
+#endif // RTXDI_REGIR_MODE == RTXDI_REGIR_HASHED
+
+#ifdef RTXDI_REGIR_ACTIVE_CELL_BUFFER
+// ReGIR occupancy pass, runs on the visible surfaces before the build pass.
+// Marks the cell that the local light sampling of the surface will use: coherentRng must be initialized
+// like in the sampling pass so that the jitter is the same. Returns the cell index.
+int RTXDI_MarkReGIRCell(
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
+    ReGIR_Parameters regirParams,
+    RAB_Surface surface)
+{
+    int cellIndex = RTXDI_CalculateReGIRCellIndex(coherentRng, regirParams, surface);
+    RTXDI_ReGIR_MarkCellActive(regirParams, cellIndex);
+    return cellIndex;
+}
+#endif // RTXDI_REGIR_ACTIVE_CELL_BUFFER
+
 RTXDI_RISTileInfo RTXDI_SelectLocalLightReGIRRISTile(
     int cellIndex,
     ReGIR_CommonParameters regirCommon)
@@ -199,7 +232,7 @@ RTXDI_RISTileInfo RTXDI_SelectLocalLightReGIRRISTile(
 #if RTXDI_ENABLE_PRESAMPLING
 #if RTXDI_REGIR_MODE != RTXDI_REGIR_DISABLED
 RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContextReGIRRIS(
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     RTXDI_LightBufferRegion localLightBufferRegion,
     RTXDI_RISBufferSegmentParameters localLightRISBufferSegmentParams,
     ReGIR_Parameters regirParams,
@@ -207,6 +240,11 @@ RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContextReGIR
 {
     RTXDI_LocalLightSelectionContext ctx;
     int cellIndex = RTXDI_CalculateReGIRCellIndex(coherentRng, regirParams, surface);
+#ifdef RTXDI_REGIR_ACTIVE_CELL_BUFFER
+    // Cells that were not marked this frame have not been built
+    if (!RTXDI_ReGIR_IsCellActive(cellIndex))
+        cellIndex = -1;
+#endif
     if (cellIndex >= 0)
     {
         ctx = RTXDI_InitializeLocalLightSelectionContextRIS(RTXDI_SelectLocalLightReGIRRISTile(cellIndex, regirParams.commonParams));
@@ -225,7 +263,7 @@ RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContextReGIR
 #endif // RTXDI_ENABLE_PRESAMPLING
 
 RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContext(
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     ReSTIRDI_LocalLightSamplingMode localLightSamplingMode,
     RTXDI_LightBufferRegion localLightBufferRegion
 #if RTXDI_ENABLE_PRESAMPLING
@@ -246,7 +284,8 @@ RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContext(
     }
     else
 #endif // RTXDI_REGIR_MODE != RTXDI_REGIR_DISABLED
-    if (localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode_POWER_RIS)
+    if (localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode_POWER_RIS ||
+        localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode_ALIAS_RIS)
     {
         ctx = RTXDI_InitializeLocalLightSelectionContextRIS(coherentRng, localLightRISBufferSegmentParams);
     }
@@ -259,8 +298,8 @@ RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContext(
 }
 
 RTXDI_DIReservoir RTXDI_SampleLocalLightsInternal(
-    inout RAB_RandomSamplerState rng,
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     RAB_Surface surface,
     RTXDI_SampleParameters sampleParams,
     ReSTIRDI_LocalLightSamplingMode localLightSamplingMode,
@@ -271,7 +310,7 @@ RTXDI_DIReservoir RTXDI_SampleLocalLightsInternal(
     ReGIR_Parameters regirParams,
 #endif
 #endif
-    out RAB_LightSample o_selectedSample)
+    RTXDI_OUT(RAB_LightSample) o_selectedSample)
 {
     RTXDI_DIReservoir state = RTXDI_EmptyDIReservoir();
 
@@ -310,8 +349,8 @@ RTXDI_DIReservoir RTXDI_SampleLocalLightsInternal(
 //
 
 RTXDI_DIReservoir RTXDI_SampleLocalLights(
-    inout RAB_RandomSamplerState rng,
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     RAB_Surface surface,
     RTXDI_SampleParameters sampleParams,
     ReSTIRDI_LocalLightSamplingMode localLightSamplingMode,
@@ -322,7 +361,7 @@ RTXDI_DIReservoir RTXDI_SampleLocalLights(
     ReGIR_Parameters regirParams,
 #endif
 #endif
-    out RAB_LightSample o_selectedSample)
+    RTXDI_OUT(RAB_LightSample) o_selectedSample)
 {
     o_selectedSample = RAB_EmptyLightSample();
 
@@ -346,7 +385,7 @@ RTXDI_DIReservoir RTXDI_SampleLocalLights(
 // Uniform sampling for infinite lights
 //
 
-float2 RTXDI_RandomlySelectInfiniteLightUV(inout RAB_RandomSamplerState rng)
+float2 RTXDI_RandomlySelectInfiniteLightUV(RTXDI_INOUT(RAB_RandomSamplerState) rng)
 {
     float2 uv;
     uv.x = RAB_GetNextRandom(rng);
@@ -355,14 +394,14 @@ float2 RTXDI_RandomlySelectInfiniteLightUV(inout RAB_RandomSamplerState rng)
 }
 
 void RTXDI_StreamInfiniteLightAtUVIntoReservoir(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RAB_LightInfo lightInfo,
     RAB_Surface surface,
     uint lightIndex,
     float2 uv,
     float invSourcePdf,
-    inout RTXDI_DIReservoir state,
-    inout RAB_LightSample o_selectedSample)
+    RTXDI_INOUT(RTXDI_DIReservoir) state,
+    RTXDI_INOUT(RAB_LightSample) o_selectedSample)
 {
     RAB_LightSample candidateSample = RAB_SamplePolymorphicLight(lightInfo, surface, uv);
     float targetPdf = RAB_GetLightSampleTargetPdfForSurface(candidateSample, surface);
@@ -376,11 +415,11 @@ void RTXDI_StreamInfiniteLightAtUVIntoReservoir(
 }
 
 RTXDI_DIReservoir RTXDI_SampleInfiniteLights(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RAB_Surface surface,
     uint numSamples,
     RTXDI_LightBufferRegion infiniteLightBufferRegion,
-    inout RAB_LightSample o_selectedSample)
+    RTXDI_INOUT(RAB_LightSample) o_selectedSample)
 {
     RTXDI_DIReservoir state = RTXDI_EmptyDIReservoir();
     o_selectedSample = RAB_EmptyLightSample();
@@ -416,8 +455,8 @@ RTXDI_DIReservoir RTXDI_SampleInfiniteLights(
 
 void RTXDI_UnpackEnvironmentLightDataFromRISData(
     uint2 tileData,
-    out float2 uv,
-    out float invSourcePdf
+    RTXDI_OUT(float2) uv,
+    RTXDI_OUT(float) invSourcePdf
 )
 {
     uint packedUv = tileData.x;
@@ -426,10 +465,10 @@ void RTXDI_UnpackEnvironmentLightDataFromRISData(
 }
 
 void RTXDI_RandomlySelectEnvironmentLightUVFromRISTile(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_RISTileInfo risTileInfo,
-    out float2 uv,
-    out float invSourcePdf
+    RTXDI_OUT(float2) uv,
+    RTXDI_OUT(float) invSourcePdf
 )
 {
     uint2 tileData;
@@ -439,15 +478,15 @@ void RTXDI_RandomlySelectEnvironmentLightUVFromRISTile(
 }
 
 void RTXDI_StreamEnvironmentLightAtUVIntoReservoir(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_SampleParameters sampleParams,
     RAB_Surface surface,
     RAB_LightInfo lightInfo,
     uint environmentLightIndex,
     float2 uv,
     float invSourcePdf,
-    inout RTXDI_DIReservoir state,
-    inout RAB_LightSample o_selectedSample)
+    RTXDI_INOUT(RTXDI_DIReservoir) state,
+    RTXDI_INOUT(RAB_LightSample) o_selectedSample)
 {
     RAB_LightSample candidateSample = RAB_SamplePolymorphicLight(lightInfo, surface, uv);
     float blendedSourcePdf = RTXDI_LightBrdfMisWeight(surface, candidateSample, 1.0 / invSourcePdf,
@@ -463,13 +502,13 @@ void RTXDI_StreamEnvironmentLightAtUVIntoReservoir(
 }
 
 RTXDI_DIReservoir RTXDI_SampleEnvironmentMap(
-    inout RAB_RandomSamplerState rng,
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     RAB_Surface surface,
     RTXDI_SampleParameters sampleParams,
     RTXDI_EnvironmentLightBufferParameters params,
     RTXDI_RISBufferSegmentParameters risBufferSegmentParams,
-    out RAB_LightSample o_selectedSample)
+    RTXDI_OUT(RAB_LightSample) o_selectedSample)
 {
     RTXDI_DIReservoir state = RTXDI_EmptyDIReservoir();
     o_selectedSample = RAB_EmptyLightSample();
@@ -505,11 +544,11 @@ RTXDI_DIReservoir RTXDI_SampleEnvironmentMap(
 //
 
 RTXDI_DIReservoir RTXDI_SampleBrdf(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RAB_Surface surface,
     RTXDI_SampleParameters sampleParams,
     RTXDI_LightBufferParameters lightBufferParams,
-    out RAB_LightSample o_selectedSample)
+    RTXDI_OUT(RAB_LightSample) o_selectedSample)
 {
     RTXDI_DIReservoir state = RTXDI_EmptyDIReservoir();
     
@@ -592,8 +631,8 @@ RTXDI_DIReservoir RTXDI_SampleBrdf(
 
 // Samples the local, infinite, and environment lights for a given surface
 RTXDI_DIReservoir RTXDI_SampleLightsForSurface(
-    inout RAB_RandomSamplerState rng,
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     RAB_Surface surface,
     RTXDI_SampleParameters sampleParams,
     RTXDI_LightBufferParameters lightBufferParams,
@@ -605,7 +644,7 @@ RTXDI_DIReservoir RTXDI_SampleLightsForSurface(
     ReGIR_Parameters regirParams,
 #endif
 #endif
-    out RAB_LightSample o_lightSample)
+    RTXDI_OUT(RAB_LightSample) o_lightSample)
 {
     o_lightSample = RAB_EmptyLightSample();
 
@@ -0,0 +1,50 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "RtxdiParameters.h"
+
+namespace rtxdi
+{
+
+// Builds the alias table used for ReSTIRDI_LocalLightSamplingMode::Alias_RIS.
+// Upload getEntries() into the buffer bound as RTXDI_LIGHT_ALIAS_TABLE, one entry per local light
+// in the order of the local light buffer region, and run RTXDI_PresampleLocalLightsAliasTable
+// instead of RTXDI_PresampleLocalLights.
+class LightAliasTable
+{
+public:
+    LightAliasTable();
+
+    // Builds the table over lights [0, lightCount) with selection probabilities proportional to lightPower.
+    // Negative and NaN power values are treated as zero. Runs in O(lightCount).
+    void build(const float* lightPower, uint32_t lightCount);
+
+    // CPU reference of RTXDI_SampleAliasTable, for random numbers in [0, 1)
+    uint32_t sample(float random0, float random1, float& pdf) const;
+
+    const RTXDI_AliasTableEntry* getEntries() const;
+    uint32_t getSize() const;
+    double getTotalPower() const;
+
+private:
+    std::vector<RTXDI_AliasTableEntry> m_entries;
+    double m_totalPower;
+
+    std::vector<double> m_scaledProbabilities;
+    std::vector<uint32_t> m_small;
+    std::vector<uint32_t> m_large;
+};
+
+}
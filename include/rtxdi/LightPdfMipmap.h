@@ -0,0 +1,60 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace rtxdi
+{
+
+// Builds the local light PDF texture sampled by RTXDI_SamplePdfMipmap and RTXDI_PresampleLocalLights on the CPU.
+// Light i is stored in the mip 0 texel RTXDI_LinearIndexToZCurve(i), and every coarser mip holds the sums
+// of 2x2 texels of the previous one. The texture size comes from ComputePdfTextureSize.
+// Each mip level is stored as a tightly packed row-major float array, ready to be uploaded
+// to an R32_FLOAT texture or wrapped with rtxdi::host::Texture2D.
+class LightPdfMipmap
+{
+public:
+    LightPdfMipmap(uint32_t maxLights);
+
+    // Rebuilds all mip levels from the power of lights [0, lightCount).
+    // Texels of the lights beyond lightCount are cleared.
+    void build(const float* lightPower, uint32_t lightCount);
+
+    // Sets the power of the listed lights and refreshes only the texels of the coarser mips that depend on them.
+    void update(const uint32_t* lightIndices, const float* lightPower, uint32_t count);
+
+    uint32_t getMaxLights() const;
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+    uint32_t getMipLevels() const;
+    uint32_t getMipWidth(uint32_t mipLevel) const;
+    uint32_t getMipHeight(uint32_t mipLevel) const;
+    const float* getMipData(uint32_t mipLevel) const;
+    // Array of getMipLevels() pointers, one per mip level
+    const float* const* getMipDataPointers() const;
+
+private:
+    uint32_t m_maxLights;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_mipLevels;
+
+    std::vector<float> m_data;
+    std::vector<float*> m_mipPointers;
+    std::vector<uint32_t> m_dirtyTexels;
+
+    void reduceMip(uint32_t mipLevel);
+    void reduceTexel(uint32_t mipLevel, uint32_t x, uint32_t y);
+};
+
+}
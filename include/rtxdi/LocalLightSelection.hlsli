@@ -50,7 +50,7 @@ RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContextRIS(R
 }
 
 RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContextRIS(
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     RTXDI_RISBufferSegmentParameters risBufferSegmentParams)
 {
     RTXDI_LocalLightSelectionContext ctx;
@@ -62,9 +62,9 @@ RTXDI_LocalLightSelectionContext RTXDI_InitializeLocalLightSelectionContextRIS(
 void RTXDI_UnpackLocalLightFromRISLightData(
     uint2 tileData,
     uint risBufferPtr,
-    out RAB_LightInfo lightInfo,
-    out uint lightIndex,
-    out float invSourcePdf)
+    RTXDI_OUT(RAB_LightInfo) lightInfo,
+    RTXDI_OUT(uint) lightIndex,
+    RTXDI_OUT(float) invSourcePdf)
 {
     lightIndex = tileData.x & RTXDI_LIGHT_INDEX_MASK;
     invSourcePdf = asfloat(tileData.y);
@@ -80,11 +80,11 @@ void RTXDI_UnpackLocalLightFromRISLightData(
 }
 
 void RTXDI_RandomlySelectLocalLightFromRISTile(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     const RTXDI_RISTileInfo risTileInfo,
-    out RAB_LightInfo lightInfo,
-    out uint lightIndex,
-    out float invSourcePdf)
+    RTXDI_OUT(RAB_LightInfo) lightInfo,
+    RTXDI_OUT(uint) lightIndex,
+    RTXDI_OUT(float) invSourcePdf)
 {
     uint2 risTileData;
     uint risBufferPtr;
@@ -95,10 +95,10 @@ void RTXDI_RandomlySelectLocalLightFromRISTile(
 
 void RTXDI_SelectNextLocalLight(
     RTXDI_LocalLightSelectionContext ctx,
-    inout RAB_RandomSamplerState rng,
-    out RAB_LightInfo lightInfo,
-    out uint lightIndex,
-    out float invSourcePdf)
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    RTXDI_OUT(RAB_LightInfo) lightInfo,
+    RTXDI_OUT(uint) lightIndex,
+    RTXDI_OUT(float) invSourcePdf)
 {
     switch (ctx.mode)
     {
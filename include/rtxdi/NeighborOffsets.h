@@ -0,0 +1,91 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rtxdi
+{
+
+// Distributions of the offsets in the buffer bound as RTXDI_NEIGHBOR_OFFSETS_BUFFER.
+// Spatial resampling reads runs of consecutive offsets starting at a random index, so the distributions
+// are built so that runs of up to setSize offsets are well spread over the disc.
+enum class NeighborOffsetDistribution : uint32_t
+{
+    R2 = 0,                 // R2 low-discrepancy sequence, the contents written by FillNeighborOffsetBuffer
+    PoissonDisc = 1,        // Best-candidate sampling against the previous setSize - 1 offsets, a progressive approximation of Poisson disc sampling
+    BlueNoiseRotated = 2,   // One best-candidate set, rotated by a different angle for each set
+    StratifiedRings = 3     // Each set has one offset per equal-area ring, in bit-reversed ring order and rotated per set
+};
+
+// Element formats of the neighbor offset buffer, to be matched by the format of its shader resource view
+enum class NeighborOffsetFormat : uint32_t
+{
+    RG8_SNORM = 0,      // 2 bytes per offset
+    RG16_SNORM = 1,     // 4 bytes per offset
+    RG32_FLOAT = 2      // 8 bytes per offset
+};
+
+struct NeighborOffsetParameters
+{
+    // Number of offsets, a power of two. RTXDI_RuntimeParameters::neighborOffsetMask is count - 1.
+    uint32_t count = 8192;
+
+    NeighborOffsetDistribution distribution = NeighborOffsetDistribution::R2;
+    NeighborOffsetFormat format = NeighborOffsetFormat::RG8_SNORM;
+
+    // The offsets cover the annulus between these radii, relative to the spatial sampling radius.
+    // A non-zero inner radius keeps the neighbors away from the center pixel.
+    float innerRadius = 0.f;
+    float outerRadius = 1.f;
+
+    // Number of offsets per set, a power of two. Runs of up to setSize consecutive offsets are spread the best,
+    // so it should match the typical spatial sample count. Poisson disc generation time grows with it.
+    uint32_t setSize = 8;
+
+    // Seed of the random distributions, ignored by R2
+    uint32_t seed = 0;
+
+    bool operator==(const NeighborOffsetParameters& other) const;
+};
+
+uint32_t GetNeighborOffsetSizeInBytes(NeighborOffsetFormat format);
+
+uint64_t GetNeighborOffsetBufferSizeInBytes(const NeighborOffsetParameters& params);
+
+// Writes GetNeighborOffsetBufferSizeInBytes(params) bytes of offsets into buffer
+void GenerateNeighborOffsets(const NeighborOffsetParameters& params, void* buffer);
+
+// Keeps the generated offset buffers, so that contexts created with the same parameters don't rebuild them.
+// Thread-safe. The returned contents stay valid after clear() for as long as they are referenced.
+class NeighborOffsetCache
+{
+public:
+    std::shared_ptr<const std::vector<uint8_t>> get(const NeighborOffsetParameters& params);
+
+    void clear();
+    uint32_t getEntryCount() const;
+
+private:
+    struct Entry
+    {
+        NeighborOffsetParameters params;
+        std::shared_ptr<const std::vector<uint8_t>> contents;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+};
+
+}
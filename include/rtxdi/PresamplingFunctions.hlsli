@@ -28,11 +28,11 @@
 #endif
 
 void RTXDI_SamplePdfMipmap(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_TEX2D pdfTexture, // full mip chain starting from unnormalized sampling pdf in mip 0
     uint2 pdfTextureSize,   // dimensions of pdfTexture at mip 0; must be 16k or less
-    out uint2 position,
-    out float pdf)
+    RTXDI_OUT(uint2) position,
+    RTXDI_OUT(float) pdf)
 {
     int lastMipLevel = max(0, int(floor(log2(max(pdfTextureSize.x, pdfTextureSize.y)))) - 1);
 
@@ -94,7 +94,7 @@ void RTXDI_SamplePdfMipmap(
 }
 
 void RTXDI_PresampleLocalLights(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_TEX2D pdfTexture,
     uint2 pdfTextureSize,
     uint tileIndex,
@@ -132,8 +132,74 @@ void RTXDI_PresampleLocalLights(
     RTXDI_RIS_BUFFER[risBufferPtr] = uint2(lightIndex, asuint(invSourcePdf));
 }
 
+#ifdef RTXDI_LIGHT_ALIAS_TABLE
+// Selects an entry of the alias table in O(1) with a single buffer load.
+// RTXDI_LIGHT_ALIAS_TABLE must point to a StructuredBuffer<RTXDI_AliasTableEntry> built by rtxdi::LightAliasTable.
+void RTXDI_SampleAliasTable(
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    uint tableSize,
+    RTXDI_OUT(uint) index,
+    RTXDI_OUT(float) pdf)
+{
+    uint entryIndex = min(uint(RAB_GetNextRandom(rng) * float(tableSize)), tableSize - 1);
+    RTXDI_AliasTableEntry entry = RTXDI_LIGHT_ALIAS_TABLE[entryIndex];
+
+    if (RAB_GetNextRandom(rng) < entry.threshold)
+    {
+        index = entryIndex;
+        pdf = entry.pdf;
+    }
+    else
+    {
+        index = entry.alias;
+        pdf = entry.aliasPdf;
+    }
+}
+
+// Alternative to RTXDI_PresampleLocalLights for ReSTIRDI_LocalLightSamplingMode_ALIAS_RIS,
+// filling the same RIS buffer tiles with lights selected proportionally to their power.
+void RTXDI_PresampleLocalLightsAliasTable(
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    uint tileIndex,
+    uint sampleInTile,
+    RTXDI_LightBufferRegion localLightBufferRegion,
+    RTXDI_RISBufferSegmentParameters localLightsRISBufferSegmentParams)
+{
+    uint risBufferPtr = sampleInTile + tileIndex * localLightsRISBufferSegmentParams.tileSize;
+
+    if (localLightBufferRegion.numLights == 0)
+    {
+        RTXDI_RIS_BUFFER[risBufferPtr] = uint2(0, 0);
+        return;
+    }
+
+    uint lightIndex;
+    float pdf;
+    RTXDI_SampleAliasTable(rng, localLightBufferRegion.numLights, lightIndex, pdf);
+
+    bool compact = false;
+    float invSourcePdf = 0;
+
+    if (pdf > 0)
+    {
+        invSourcePdf = 1.0 / pdf;
+
+        RAB_LightInfo lightInfo = RAB_LoadLightInfo(lightIndex + localLightBufferRegion.firstLightIndex, false);
+        compact = RAB_StoreCompactLightInfo(risBufferPtr, lightInfo);
+    }
+
+    lightIndex += localLightBufferRegion.firstLightIndex;
+
+    if (compact) {
+        lightIndex |= RTXDI_LIGHT_COMPACT_BIT;
+    }
+
+    RTXDI_RIS_BUFFER[risBufferPtr] = uint2(lightIndex, asuint(invSourcePdf));
+}
+#endif // RTXDI_LIGHT_ALIAS_TABLE
+
 void RTXDI_PresampleEnvironmentMap(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_TEX2D pdfTexture,
     uint2 pdfTextureSize,
     uint tileIndex,
@@ -163,11 +229,23 @@ void RTXDI_PresampleEnvironmentMap(
 
 #if RTXDI_REGIR_MODE != RTXDI_REGIR_DISABLED
 
+// Maps a thread of the ReGIR build pass to the light slot that it fills in this frame.
+// The pass runs ReGIRContext::getReGIRBuildThreadCount() threads, which is the light slot count
+// unless only a fraction of the slots is rebuilt. Returns false for the threads past the last slot.
+bool RTXDI_GetReGIRBuildLightSlot(
+    ReGIR_Parameters regirParams,
+    uint buildThreadIndex,
+    RTXDI_OUT(uint) lightSlot)
+{
+    lightSlot = buildThreadIndex * regirParams.temporalParams.rebuildPeriod + regirParams.temporalParams.rebuildPhase;
+    return lightSlot < regirParams.temporalParams.lightSlotCount;
+}
+
 // ReGIR grid build pass.
 // Each thread populates one light slot in a grid cell.
 void RTXDI_PresampleLocalLightsForReGIR(
-    inout RAB_RandomSamplerState rng,
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     uint lightSlot,
     RTXDI_LightBufferRegion localLightBufferRegion,
     RTXDI_RISBufferSegmentParameters localLightRISBufferSegmentParams,
@@ -202,6 +280,36 @@ void RTXDI_PresampleLocalLightsForReGIR(
 
     float invNumSamples = 1.0 / float(regirParams.commonParams.numRegirBuildSamples);
 
+#ifndef RTXDI_REGIR_ACTIVE_CELL_BUFFER
+    // Active cell builds never merge: the slots of a newly active cell may hold lights from an old frame or no data at all
+    if (regirParams.temporalParams.mergeHistory != 0)
+    {
+        // The previous light of the slot is resampled with the new candidates, as if it had been selected
+        // from as many candidates as this frame takes, so both sources have the same weight.
+        invNumSamples *= 0.5;
+
+        const uint2 previousData = RTXDI_RIS_BUFFER[risBufferPtr];
+        const float previousWeight = asfloat(previousData.y);
+        if (previousWeight > 0)
+        {
+            const uint previousLight = previousData.x & RTXDI_LIGHT_INDEX_MASK;
+            RAB_LightInfo previousLightInfo = ((previousData.x & RTXDI_LIGHT_COMPACT_BIT) != 0)
+                ? RAB_LoadCompactLightInfo(risBufferPtr)
+                : RAB_LoadLightInfo(previousLight, false);
+
+            const float targetPdf = RAB_GetLightTargetPdfForVolume(previousLightInfo, cellCenter, cellRadius);
+            weightSum = targetPdf * previousWeight * 0.5;
+
+            if (weightSum > 0)
+            {
+                selectedLightInfo = previousLightInfo;
+                selectedLight = previousLight;
+                selectedTargetPdf = targetPdf;
+            }
+        }
+    }
+#endif // RTXDI_REGIR_ACTIVE_CELL_BUFFER
+
     RTXDI_LocalLightSelectionContext ctx;
     if (regirParams.commonParams.localLightPresamplingMode == REGIR_LOCAL_LIGHT_PRESAMPLING_MODE_POWER_RIS)
         ctx = RTXDI_InitializeLocalLightSelectionContextRIS(coherentRng, localLightRISBufferSegmentParams);
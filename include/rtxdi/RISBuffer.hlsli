@@ -18,10 +18,10 @@ struct RTXDI_RISTileInfo
 };
 
 void RTXDI_RandomlySelectLightDataFromRISTile(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_RISTileInfo bufferInfo,
-    out uint2 tileData,
-    out uint risBufferPtr)
+    RTXDI_OUT(uint2) tileData,
+    RTXDI_OUT(uint) risBufferPtr)
 {
     float rnd = RAB_GetNextRandom(rng);
     uint risSample = min(uint(floor(rnd * bufferInfo.risTileSize)), bufferInfo.risTileSize - 1);
@@ -30,7 +30,7 @@ void RTXDI_RandomlySelectLightDataFromRISTile(
 }
 
 RTXDI_RISTileInfo RTXDI_RandomlySelectRISTile(
-    inout RAB_RandomSamplerState coherentRng,
+    RTXDI_INOUT(RAB_RandomSamplerState) coherentRng,
     RTXDI_RISBufferSegmentParameters params)
 {
     RTXDI_RISTileInfo risTileInfo;
@@ -11,22 +11,89 @@
 #pragma once
 
 #include <stdint.h>
+#include <vector>
 
 #include "RISBufferSegmentParameters.h"
 
 namespace rtxdi
 {
 
+// A copy of live RIS buffer data that the application must perform after compaction.
+// Offsets and sizes are in elements.
+struct RISBufferSegmentMove
+{
+    uint32_t srcOffset;
+    uint32_t dstOffset;
+    uint32_t sizeInElements;
+};
+
+// Returns the offset of the segment that started at 'offset' before the moves reported by compact().
+uint32_t GetMovedRISBufferSegmentOffset(const std::vector<RISBufferSegmentMove>& moves, uint32_t offset);
+
+struct RISBufferSegmentAllocatorStatistics
+{
+    uint32_t segmentCount = 0;
+    uint32_t freeRangeCount = 0;
+    // Elements in live segments, excluding alignment padding
+    uint32_t allocatedElements = 0;
+    // Elements in free ranges below the end of the buffer, including alignment padding
+    uint32_t freeElements = 0;
+    uint32_t totalSizeInElements = 0;
+    uint32_t highWaterMarkInElements = 0;
+};
+
+// Sub-allocates segments of the RIS buffer.
+// Freed segments are reused first-fit; new segments that don't fit into a free range
+// are placed at the end of the buffer. getTotalSizeInElements() is the buffer size
+// currently required, and the high-water mark is the largest size ever required.
 class RISBufferSegmentAllocator
 {
 public:
-    RISBufferSegmentAllocator();
+    // The default alignment applies to allocateSegment calls without an explicit alignment.
+    // Alignments must be powers of 2.
+    RISBufferSegmentAllocator(uint32_t defaultAlignmentInElements = 1);
     // Returns starting offset of segment in buffer
     uint32_t allocateSegment(uint32_t sizeInElements);
+    uint32_t allocateSegment(uint32_t sizeInElements, uint32_t alignmentInElements);
+    // Releases a segment previously returned by allocateSegment. Its range becomes available for reuse.
+    // Zero-size segments are not tracked and don't need to be released.
+    void releaseSegment(uint32_t offset);
+
+    // Moves all live segments towards the start of the buffer, preserving their order and alignment,
+    // and appends the required copies to 'moves' in ascending offset order.
+    // Destinations never overlap later sources, so the copies can be executed in order
+    // within the same buffer, but a single copy may overlap its own source.
+    // Owners of the moved segments must update their offsets.
+    void compact(std::vector<RISBufferSegmentMove>& moves);
+
     uint32_t getTotalSizeInElements() const;
+    uint32_t getHighWaterMarkInElements() const;
+    RISBufferSegmentAllocatorStatistics getStatistics() const;
 
 private:
+    struct Segment
+    {
+        uint32_t offset;
+        uint32_t sizeInElements;
+        uint32_t alignmentInElements;
+    };
+
+    struct FreeRange
+    {
+        uint32_t offset;
+        uint32_t sizeInElements;
+    };
+
+    // Both sorted by offset
+    std::vector<Segment> m_segments;
+    std::vector<FreeRange> m_freeRanges;
+
+    uint32_t m_defaultAlignmentInElements;
     uint32_t m_totalSizeInElements;
+    uint32_t m_highWaterMarkInElements;
+
+    void addFreeRange(uint32_t offset, uint32_t sizeInElements);
+    void trimEnd();
 };
 
 }
@@ -21,6 +21,7 @@ struct RTXDI_RuntimeParameters;
 namespace rtxdi
 {
     class RISBufferSegmentAllocator;
+    struct RISBufferSegmentMove;
 
     struct uint3
     {
@@ -40,7 +41,9 @@ namespace rtxdi
     {
         Disabled = 0,
         Grid = RTXDI_REGIR_GRID,
-        Onion = RTXDI_REGIR_ONION
+        Onion = RTXDI_REGIR_ONION,
+        Hashed = RTXDI_REGIR_HASHED,
+        Clipmap = RTXDI_REGIR_CLIPMAP
     };
 
     struct ReGIRGridStaticParameters
@@ -66,8 +69,29 @@ namespace rtxdi
         uint32_t OnionCoverageLayers = 10;
     };
 
+    struct ReGIRClipmapStaticParameters
+    {
+        // Grid dimensions of every level, in cells.
+        uint3 GridSize = { 16, 16, 16 };
+
+        // Number of nested grids around the center. Level L has cells of regirCellSize * 2^L,
+        // so it covers 2^L times the extent of level 0. Acceptable values are 1 to RTXDI_REGIR_CLIPMAP_MAX_LEVELS.
+        uint32_t LevelCount = 4;
+    };
+
+    struct ReGIRHashedStaticParameters
+    {
+        // Number of cells that the hash table can hold, rounded up to a power of 2.
+        // See CalculateReGIRHashTableCapacity.
+        uint32_t HashTableCapacity = 4096;
+
+        // Number of table entries tried by an insertion or a lookup before giving up.
+        // Surfaces whose cell can't be found use the fallback sampling mode.
+        uint32_t MaxProbes = 16;
+    };
+
     // ReGIR parameters that are used to generate ReGIR data structures
-    // Changing these requires recreating the ReGIR context and the associated buffers
+    // Changing these requires ReGIRContext::setStaticParameters and reallocating the associated buffers
     struct ReGIRStaticParameters
     {
         ReGIRMode Mode = ReGIRMode::Onion;
@@ -75,21 +99,36 @@ namespace rtxdi
         // Number of light reservoirs computed and stored for each cell.
         uint32_t LightsPerCell = 512;
 
+        // Set when the build pass only fills the cells marked by RTXDI_MarkReGIRCell, see ReGIRActiveCellBufferParameters.
+        // Newly active cells don't hold lights from previous frames, so every frame is a full rebuild.
+        bool BuildActiveCellsOnly = false;
+
         ReGIRGridStaticParameters gridParameters;
         ReGIROnionStaticParameters onionParameters;
+        ReGIRHashedStaticParameters hashedParameters;
+        ReGIRClipmapStaticParameters clipmapParameters;
     };
 
     // ReGIR parameters generated from the ReGIRGridStaticParameters
     // Changing these requires changing the ReGIRStaticParameters and
-    // therefore recreating the ReGIRcontext
+    // therefore a call to ReGIRContext::setStaticParameters
     struct ReGIRGridCalculatedParameters
     {
         uint32_t lightSlotCount = 0;
     };
 
+    // Element of the Buffer<float4> bound as RTXDI_REGIR_ONION_CELL_BUFFER,
+    // with the results of the analytic RTXDI_ReGIR_CellIndexToWorldPos for one onion cell
+    struct ReGIROnionCell
+    {
+        // Relative to the onion center
+        float3 center;
+        float radius;
+    };
+
     // ReGIR parameters generated from the ReGIROnionStaticParameters
     // Changing these requires changing the ReGIRStaticParameters and
-    // therefore recreating the ReGIRcontext
+    // therefore a call to ReGIRContext::setStaticParameters
     struct ReGIROnionCalculatedParameters
     {
         uint32_t lightSlotCount = 0;
@@ -98,6 +137,31 @@ namespace rtxdi
         std::vector<ReGIR_OnionRing> regirOnionRings;
         float regirOnionCubicRootFactor = 0.f;
         float regirOnionLinearFactor = 0.f;
+        // One entry per cell, to be uploaded into RTXDI_REGIR_ONION_CELL_BUFFER
+        std::vector<ReGIROnionCell> regirOnionCellTable;
+    };
+
+    // ReGIR parameters generated from the ReGIRClipmapStaticParameters
+    // Changing these requires changing the ReGIRStaticParameters and
+    // therefore a call to ReGIRContext::setStaticParameters
+    struct ReGIRClipmapCalculatedParameters
+    {
+        uint32_t lightSlotCount = 0;
+        uint32_t levelCount = 0;
+        uint32_t cellsPerLevel = 0;
+        // Offset of the first light slot of each level in the RIS buffer.
+        // The levels are consecutive in the ReGIR segment, finest first.
+        std::vector<uint32_t> levelRISBufferOffsets;
+    };
+
+    // ReGIR parameters generated from the ReGIRHashedStaticParameters
+    // Changing these requires changing the ReGIRStaticParameters and
+    // therefore a call to ReGIRContext::setStaticParameters
+    struct ReGIRHashedCalculatedParameters
+    {
+        uint32_t lightSlotCount = 0;
+        // Number of elements of the RWBuffer<uint> bound as RTXDI_REGIR_HASH_BUFFER
+        uint32_t hashTableCapacity = 0;
     };
 
     enum class LocalLightReGIRPresamplingMode : uint32_t
@@ -136,9 +200,45 @@ namespace rtxdi
 
         // Number of lights samples to take when filling a ReGIR cell.
         uint32_t regirNumBuildSamples = 8;
+
+        // Distance from the center, in units of regirCellSize, up to which the hashed mode uses regirCellSize cells.
+        // Farther away, the cell size doubles every time the distance doubles. Acceptable values are 1 to 255.
+        float regirHashedLevelDistance = 16.0f;
+
+        // Fraction of the light slots that the build pass fills every frame, rounded to 1/N.
+        // Each frame rebuilds a different subset, and the rebuilt slots resample their previous light
+        // together with the new candidates. 1 rebuilds every slot from scratch every frame.
+        // The hashed mode and ReGIRStaticParameters::BuildActiveCellsOnly always rebuild every slot.
+        // See ReGIRContext::setFrameIndex and getReGIRBuildThreadCount.
+        float regirRebuildFraction = 1.0f;
+
+        // Motion of the center since the last full rebuild, in units of regirCellSize, that forces a full rebuild.
+        // The cells move with the center, so the previous lights of the slots were selected for other positions.
+        float regirFullRebuildCenterMotion = 0.25f;
     };
     
 
+    // Layout of the RWBuffer<uint> bound as RTXDI_REGIR_ACTIVE_CELL_BUFFER, used to build only the cells
+    // marked by RTXDI_MarkReGIRCell. Offsets and sizes are in elements. At most RTXDI_REGIR_MAX_ACTIVE_CELLS
+    // cells are built in a frame, the surfaces in the other marked cells use the fallback sampling mode.
+    // Requires ReGIRStaticParameters::BuildActiveCellsOnly.
+    struct ReGIRActiveCellBufferParameters
+    {
+        uint32_t elementCount = 0;
+        uint32_t occupancyOffset = 0;
+        uint32_t occupancyElementCount = 0;
+        uint32_t activeCellListOffset = 0;
+        uint32_t maxActiveCells = 0;
+    };
+
+    // Indirect dispatch arguments of the active cell build pass, stored at the start of RTXDI_REGIR_ACTIVE_CELL_BUFFER
+    struct ReGIRBuildIndirectArguments
+    {
+        uint32_t threadGroupCountX = 0;
+        uint32_t threadGroupCountY = 0;
+        uint32_t threadGroupCountZ = 0;
+    };
+
     // Make this take static ReGIR params, update its dynamic ones
     class ReGIRContext
     {
@@ -149,25 +249,128 @@ namespace rtxdi
 
         uint32_t getReGIRCellOffset() const;
         uint32_t getReGIRLightSlotCount() const;
+        uint32_t getReGIRCellCount() const;
         ReGIRGridCalculatedParameters getReGIRGridCalculatedParameters() const;
-        ReGIROnionCalculatedParameters getReGIROnionCalculatedParameters() const;
+        const ReGIROnionCalculatedParameters& getReGIROnionCalculatedParameters() const;
+        ReGIRHashedCalculatedParameters getReGIRHashedCalculatedParameters() const;
+        const ReGIRClipmapCalculatedParameters& getReGIRClipmapCalculatedParameters() const;
+        // Onion layers and rings in the constant buffer layout, computed once at construction.
+        const ReGIR_OnionParameters& getReGIROnionParameters() const;
         ReGIRDynamicParameters getReGIRDynamicParameters() const;
         ReGIRStaticParameters getReGIRStaticParameters() const;
 
+        ReGIRActiveCellBufferParameters getReGIRActiveCellBufferParameters() const;
+
+        // Values that the application writes to the start of RTXDI_REGIR_ACTIVE_CELL_BUFFER every frame
+        // before the occupancy pass, together with zeroing the counter and the occupancy bits:
+        // no active cell yet, and enough thread groups of threadGroupSize threads for the light slots of a cell.
+        ReGIRBuildIndirectArguments getReGIRBuildInitialIndirectArguments(uint32_t threadGroupSize) const;
+
+        // Arguments of the build pass when every cell is active, for comparison or for a direct dispatch
+        ReGIRBuildIndirectArguments getReGIRBuildMaxIndirectArguments(uint32_t threadGroupSize) const;
+
         void setDynamicParameters(const ReGIRDynamicParameters& dynamicParameters);
 
+        // Replaces the static parameters without recreating the context. The RIS buffer segment of the previous
+        // parameters is released into the allocator and a segment for the new ones is allocated, possibly at
+        // another offset, and the next frame is a full rebuild. The application must grow the RIS buffer if the
+        // allocator's total size exceeds it, and reallocate the hash table, active cell and onion cell buffers.
+        void setStaticParameters(const ReGIRStaticParameters& params, RISBufferSegmentAllocator& risBufferSegmentAllocator);
+
+        // Updates the RIS buffer offsets with the moves reported by RISBufferSegmentAllocator::compact.
+        void applyRISBufferSegmentMoves(const std::vector<RISBufferSegmentMove>& moves);
+
+        // Selects the light slots rebuilt in the frame when ReGIRDynamicParameters::regirRebuildFraction is below 1.
+        // Call it once per frame, after setDynamicParameters and before filling the constant buffers.
+        // Changes of the dynamic parameters that affect the build, and center motion, make the frame a full rebuild.
+        void setFrameIndex(uint32_t frameIndex);
+
+        // Makes the next frame rebuild every light slot from scratch. Call it when the local lights were added,
+        // removed or changed, since the slots keep light indices and weights from previous frames.
+        void requestFullRebuild();
+
+        // True if the build pass of the current frame fills every light slot without merging the previous lights
+        bool isFullRebuild() const;
+
+        // Number of threads of the build pass in the current frame, see RTXDI_GetReGIRBuildLightSlot
+        uint32_t getReGIRBuildThreadCount() const;
+
+        // Fills the common, grid, clipmap, hashed, temporal and onion sections of the ReGIR constant buffer
+        // parameters in place. All sections are written regardless of the active mode.
+        // Doesn't allocate, so it can be called for every view on every frame.
+        void fillReGIRParameters(ReGIR_Parameters& params) const;
+
     private:
         void InitializeOnion(const ReGIRStaticParameters& params);
+        void ComputeOnionCellTable();
         void ComputeOnionJitterCurve();
+        void ComputeOnionGPUParameters();
         void ComputeGridLightSlotCount();
+        void ComputeHashedLightSlotCount();
+        void ComputeClipmapLightSlotCount();
         void AllocateRISBufferSegment(RISBufferSegmentAllocator& risBufferSegmentAllocator);
+        void ReleaseRISBufferSegment(RISBufferSegmentAllocator& risBufferSegmentAllocator);
+        void ComputeClipmapLevelOffsets();
+        uint32_t GetRebuildPeriod() const;
 
         uint32_t m_regirCellOffset = 0;
 
         ReGIRStaticParameters m_regirStaticParameters;
         ReGIRDynamicParameters m_regirDynamicParameters;
         ReGIROnionCalculatedParameters m_regirOnionCalculatedParameters;
+        ReGIR_OnionParameters m_regirOnionParameters;
         ReGIRGridCalculatedParameters m_regirGridCalculatedParameters;
+        ReGIRHashedCalculatedParameters m_regirHashedCalculatedParameters;
+        ReGIRClipmapCalculatedParameters m_regirClipmapCalculatedParameters;
+
+        uint32_t m_frameIndex = 0;
+        uint32_t m_rebuildPeriod = 1;
+        bool m_fullRebuild = true;
+        bool m_fullRebuildRequested = true;
+        float3 m_fullRebuildCenter = { 0.0f, 0.0f, 0.0f };
+    };
+
+    // Smallest hash table capacity that keeps the load factor of expectedCellCount cells under maxLoadFactor.
+    // With linear probing, load factors above 0.5 quickly increase the probe sequence lengths.
+    uint32_t CalculateReGIRHashTableCapacity(uint32_t expectedCellCount, float maxLoadFactor = 0.5f);
+
+    // CPU reference of the hash table of ReGIRMode::Hashed, with the same keys, hash and probing
+    // as RTXDI_ReGIR_HashedInsertCell and RTXDI_ReGIR_WorldPosToCellIndex in ReGIRSampling.hlsli.
+    // Inserting the surface positions of a frame measures the occupancy and the collisions of a table capacity,
+    // and the keys can be compared with a readback of RTXDI_REGIR_HASH_BUFFER.
+    class ReGIRHashTable
+    {
+    public:
+        struct Statistics
+        {
+            uint32_t insertions = 0;
+            // Insertions that added a new cell to the table
+            uint32_t allocatedCells = 0;
+            // Insertions that reached the probe limit or whose position is out of the key range
+            uint32_t failedInsertions = 0;
+            // Entries visited after the first one, summed over the insertions
+            uint64_t extraProbes = 0;
+            uint32_t longestProbeSequence = 0;
+        };
+
+        ReGIRHashTable(uint32_t capacity, uint32_t maxProbes);
+
+        void clear();
+
+        // The cell size, center and level distance are taken from params.
+        // Both functions return the cell index, or -1 like the shader functions.
+        int insert(const ReGIR_Parameters& params, const float3& worldPos);
+        int lookup(const ReGIR_Parameters& params, const float3& worldPos) const;
+
+        uint32_t getCapacity() const;
+        float getLoadFactor() const;
+        const std::vector<uint32_t>& getKeys() const;
+        const Statistics& getStatistics() const;
+
+    private:
+        uint32_t m_maxProbes;
+        std::vector<uint32_t> m_keys;
+        Statistics m_statistics;
     };
 }
 
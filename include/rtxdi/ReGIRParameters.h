@@ -19,6 +19,14 @@
 #define RTXDI_REGIR_DISABLED 0
 #define RTXDI_REGIR_GRID 1
 #define RTXDI_REGIR_ONION 2
+#define RTXDI_REGIR_HASHED 3
+#define RTXDI_REGIR_CLIPMAP 4
+
+// Number of nested grids in the clipmap mode
+#define RTXDI_REGIR_CLIPMAP_MAX_LEVELS 8
+
+// Number of cell sizes in the hashed mode, each level doubles the cell size of the previous one
+#define RTXDI_REGIR_HASHED_MAX_LEVELS 7
 
 #ifndef RTXDI_REGIR_MODE
 #define RTXDI_REGIR_MODE RTXDI_REGIR_DISABLED
@@ -50,6 +58,16 @@ struct ReGIR_OnionRing
     int cellCount;
 };
 
+// Layout of the RWBuffer<uint> bound as RTXDI_REGIR_ACTIVE_CELL_BUFFER: the indirect dispatch arguments
+// of the build pass (light slot groups per cell, active cell count, 1), the number of marked cells,
+// the occupancy bits of the cells, then the list of active cells.
+#define RTXDI_REGIR_ACTIVE_CELL_DISPATCH_ARGS_OFFSET 0
+#define RTXDI_REGIR_ACTIVE_CELL_COUNTER_OFFSET 3
+#define RTXDI_REGIR_ACTIVE_CELL_OCCUPANCY_OFFSET 4
+
+// The active cell count is the Y thread group count of the build pass, limited by the API
+#define RTXDI_REGIR_MAX_ACTIVE_CELLS 65535
+
 #define REGIR_LOCAL_LIGHT_PRESAMPLING_MODE_UNIFORM 0
 #define REGIR_LOCAL_LIGHT_PRESAMPLING_MODE_POWER_RIS 1
 
@@ -70,8 +88,8 @@ struct ReGIR_CommonParameters
 
     uint32_t localLightPresamplingMode;
     uint32_t numRegirBuildSamples; // PresampleReGIR.hlsl -> RTXDI_PresampleLocalLightsForReGIR
-    uint32_t pad1;
-    uint32_t pad2;
+    uint32_t activeCellListOffset; // Layout of RTXDI_REGIR_ACTIVE_CELL_BUFFER, see ReGIRActiveCellBufferParameters
+    uint32_t maxActiveCells;
 };
 
 struct ReGIR_GridParameters
@@ -82,6 +100,32 @@ struct ReGIR_GridParameters
     uint32_t pad1;
 };
 
+struct ReGIR_ClipmapParameters
+{
+    // Cells per axis of every level
+    uint32_t cellsX;
+    uint32_t cellsY;
+    uint32_t cellsZ;
+    uint32_t numLevels;
+};
+
+struct ReGIR_HashedParameters
+{
+    uint32_t capacity; // Number of hash table entries, a power of 2
+    uint32_t maxProbes;
+    float levelDistance; // Distance from the center where the cells start growing, in units of cellSize
+    uint32_t pad1;
+};
+
+struct ReGIR_TemporalParameters
+{
+    // The build pass fills the light slots whose index modulo rebuildPeriod is rebuildPhase
+    uint32_t rebuildPeriod;
+    uint32_t rebuildPhase;
+    uint32_t lightSlotCount;
+    uint32_t mergeHistory; // Rebuilt slots keep their previous light as a candidate
+};
+
 struct ReGIR_OnionParameters
 {
     ReGIR_OnionLayerGroup layers[RTXDI_ONION_MAX_LAYER_GROUPS];
@@ -90,13 +134,16 @@ struct ReGIR_OnionParameters
     uint32_t numLayerGroups;
     float cubicRootFactor;
     float linearFactor;
-    float pad1;
+    uint32_t numCells;
 };
 
 struct ReGIR_Parameters
 {
     ReGIR_CommonParameters commonParams;
     ReGIR_GridParameters gridParams;
+    ReGIR_ClipmapParameters clipmapParams;
+    ReGIR_HashedParameters hashedParams;
+    ReGIR_TemporalParameters temporalParams;
     ReGIR_OnionParameters onionParams;
 };
 
@@ -33,7 +33,7 @@ int RTXDI_ReGIR_WorldPosToCellIndex(ReGIR_Parameters params, float3 worldPos)
     return gridCell.x + (gridCell.y + (gridCell.z * gridCellCount.y)) * gridCellCount.x;
 }
 
-bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, out float3 cellCenter, out float cellRadius)
+bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, RTXDI_OUT(float3) cellCenter, RTXDI_OUT(float) cellRadius)
 {
     const float3 gridCenter = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
     const int3 gridCellCount = int3(params.gridParams.cellsX, params.gridParams.cellsY, params.gridParams.cellsZ);
@@ -124,7 +124,30 @@ int RTXDI_ReGIR_WorldPosToCellIndex(ReGIR_Parameters params, float3 worldPos)
     return int(cellIndex + ringCellOffset + layerIndex * layerGroup.cellsPerLayer + layerGroup.layerCellOffset);
 }
 
-bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, out float3 cellCenter, out float cellRadius)
+#ifdef RTXDI_REGIR_ONION_CELL_BUFFER
+
+// Reads the cell from the table of ReGIRContext, see ReGIROnionCalculatedParameters::regirOnionCellTable.
+// RTXDI_REGIR_ONION_CELL_BUFFER must point to a Buffer<float4> type resource with the contents of the table.
+bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, RTXDI_OUT(float3) cellCenter, RTXDI_OUT(float) cellRadius)
+{
+    const float3 onionCenter = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
+
+    cellCenter = float3(0, 0, 0);
+    cellRadius = 0;
+
+    if (cellIndex < 0 || uint(cellIndex) >= params.onionParams.numCells)
+        return false;
+
+    const float4 cell = RTXDI_REGIR_ONION_CELL_BUFFER[cellIndex];
+    cellCenter = cell.xyz + onionCenter;
+    cellRadius = cell.w;
+
+    return true;
+}
+
+#else // RTXDI_REGIR_ONION_CELL_BUFFER
+
+bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, RTXDI_OUT(float3) cellCenter, RTXDI_OUT(float) cellRadius)
 {
     const float3 onionCenter = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
 
@@ -212,8 +235,308 @@ bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, out
     return true;
 }
 
+#endif // RTXDI_REGIR_ONION_CELL_BUFFER
+
+#elif RTXDI_REGIR_MODE == RTXDI_REGIR_CLIPMAP
+
+// The clipmap mode has nested grids of the same cell counts around the center, where level L has cells
+// of cellSize * 2^L. Positions use the finest level that contains them, and the cells of level L
+// follow the cells of the finer levels in the cell index order.
+
+float RTXDI_ReGIR_GetClipmapCellSize(ReGIR_Parameters params, uint level)
+{
+    return params.commonParams.cellSize * float(1u << level);
+}
+
+// Returns the finest level that contains the position, or numLevels if none does
+uint RTXDI_ReGIR_GetClipmapLevel(ReGIR_Parameters params, float3 worldPos)
+{
+    const float3 center = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
+    const float3 halfExtent = float3(params.clipmapParams.cellsX, params.clipmapParams.cellsY, params.clipmapParams.cellsZ) * (params.commonParams.cellSize * 0.5);
+
+    // Distance to the center relative to the half extent of level 0, per axis
+    const float3 ratio = abs(worldPos - center) / halfExtent;
+    const float maxRatio = max(ratio.x, max(ratio.y, ratio.z));
+
+    if (maxRatio < 1.0)
+        return 0;
+
+    // Level L contains the ratios below 2^L
+    return min(uint(floor(log2(maxRatio))) + 1, params.clipmapParams.numLevels);
+}
+
+int RTXDI_ReGIR_GetClipmapCellIndex(ReGIR_Parameters params, float3 worldPos, uint level)
+{
+    const float3 center = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
+    const int3 gridCellCount = int3(params.clipmapParams.cellsX, params.clipmapParams.cellsY, params.clipmapParams.cellsZ);
+    const float cellSize = RTXDI_ReGIR_GetClipmapCellSize(params, level);
+    const float3 gridOrigin = center - float3(gridCellCount) * (cellSize * 0.5);
+
+    int3 gridCell = int3(floor((worldPos - gridOrigin) / cellSize));
+
+    if (gridCell.x < 0 || gridCell.y < 0 || gridCell.z < 0 ||
+        gridCell.x >= gridCellCount.x || gridCell.y >= gridCellCount.y || gridCell.z >= gridCellCount.z)
+        return -1;
+
+    const int cellsPerLevel = gridCellCount.x * gridCellCount.y * gridCellCount.z;
+    return gridCell.x + (gridCell.y + (gridCell.z * gridCellCount.y)) * gridCellCount.x + int(level) * cellsPerLevel;
+}
+
+float RTXDI_ReGIR_GetJitterScale(ReGIR_Parameters params, float3 worldPos)
+{
+    const uint level = min(RTXDI_ReGIR_GetClipmapLevel(params, worldPos), params.clipmapParams.numLevels - 1);
+    return params.commonParams.samplingJitter * RTXDI_ReGIR_GetClipmapCellSize(params, level);
+}
+
+int RTXDI_ReGIR_WorldPosToCellIndex(ReGIR_Parameters params, float3 worldPos)
+{
+    const uint level = RTXDI_ReGIR_GetClipmapLevel(params, worldPos);
+    if (level >= params.clipmapParams.numLevels)
+        return -1;
+
+    int cellIndex = RTXDI_ReGIR_GetClipmapCellIndex(params, worldPos, level);
+
+    // Positions on the boundary of a level can round outside of it
+    if (cellIndex < 0 && level + 1 < params.clipmapParams.numLevels)
+        cellIndex = RTXDI_ReGIR_GetClipmapCellIndex(params, worldPos, level + 1);
+
+    return cellIndex;
+}
+
+bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, RTXDI_OUT(float3) cellCenter, RTXDI_OUT(float) cellRadius)
+{
+    cellCenter = float3(0.0, 0.0, 0.0);
+    cellRadius = 0.0;
+
+    if (cellIndex < 0)
+        return false;
+
+    const uint cellsPerLevel = params.clipmapParams.cellsX * params.clipmapParams.cellsY * params.clipmapParams.cellsZ;
+    const uint level = uint(cellIndex) / cellsPerLevel;
+    if (level >= params.clipmapParams.numLevels)
+        return false;
+
+    const float3 center = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
+    const int3 gridCellCount = int3(params.clipmapParams.cellsX, params.clipmapParams.cellsY, params.clipmapParams.cellsZ);
+    const float cellSize = RTXDI_ReGIR_GetClipmapCellSize(params, level);
+    const float3 gridOrigin = center - float3(gridCellCount) * (cellSize * 0.5);
+
+    uint3 cellPosition;
+    cellPosition.x = uint(cellIndex) - level * cellsPerLevel;
+    cellPosition.y = cellPosition.x / params.clipmapParams.cellsX;
+    cellPosition.x %= params.clipmapParams.cellsX;
+    cellPosition.z = cellPosition.y / params.clipmapParams.cellsY;
+    cellPosition.y %= params.clipmapParams.cellsY;
+
+    cellCenter = (float3(cellPosition) + 0.5) * cellSize + gridOrigin;
+    cellRadius = cellSize * sqrt(3.0);
+
+    return true;
+}
+
+#elif RTXDI_REGIR_MODE == RTXDI_REGIR_HASHED
+
+#ifndef RTXDI_REGIR_HASH_BUFFER
+#error "RTXDI_REGIR_HASH_BUFFER must be defined to point to a RWBuffer<uint> type resource with ReGIR_HashedParameters::capacity elements"
 #endif
 
+// The hashed mode stores cells of an unbounded world-space grid in a hash table with a fixed capacity.
+// The table in RTXDI_REGIR_HASH_BUFFER holds the keys of the cells, and cell (entry) N uses the light slots
+// of the RIS buffer segment like cell N of the other modes. Every frame, the application clears the table
+// to zero and calls RTXDI_AllocateReGIRCell for the visible surfaces before the ReGIR build pass,
+// which leaves the light slots of the empty entries unused.
+//
+// Cells are aligned to the world origin so that they don't move with the center. Their size is cellSize
+// up to levelDistance cells from the center, and doubles every time the distance to the center doubles.
+// A key packs the level (plus one, so that zero means an empty entry) and the cell coordinates
+// wrapped to 10 bits on X and Z and 9 bits on Y, which are unwrapped around the cell of the center.
+
+uint RTXDI_ReGIR_GetHashedLevel(ReGIR_Parameters params, float3 worldPos)
+{
+    const float3 center = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
+    const float distanceToCenter = length(worldPos - center) / (params.hashedParams.levelDistance * params.commonParams.cellSize);
+
+    if (distanceToCenter <= 1.0)
+        return 0;
+
+    return min(uint(floor(log2(distanceToCenter))) + 1, uint(RTXDI_REGIR_HASHED_MAX_LEVELS - 1));
+}
+
+float RTXDI_ReGIR_GetHashedCellSize(ReGIR_Parameters params, uint level)
+{
+    return params.commonParams.cellSize * float(1u << level);
+}
+
+// Returns false if the position is too far from the center to be represented by a key
+bool RTXDI_ReGIR_GetHashedCellKey(ReGIR_Parameters params, float3 worldPos, RTXDI_OUT(uint) key)
+{
+    const float3 center = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
+    const uint level = RTXDI_ReGIR_GetHashedLevel(params, worldPos);
+    const float cellSize = RTXDI_ReGIR_GetHashedCellSize(params, level);
+
+    const int3 cell = int3(floor(worldPos / cellSize));
+    const int3 offset = cell - int3(floor(center / cellSize));
+
+    key = 0;
+    if (abs(offset.x) > 511 || abs(offset.y) > 255 || abs(offset.z) > 511)
+        return false;
+
+    key = ((level + 1) << 29) | ((uint(cell.y) & 0x1ff) << 20) | ((uint(cell.z) & 0x3ff) << 10) | (uint(cell.x) & 0x3ff);
+    return true;
+}
+
+uint RTXDI_ReGIR_GetHashedEntryIndex(ReGIR_Parameters params, uint key, uint probe)
+{
+    return (RTXDI_JenkinsHash(key) + probe) & (params.hashedParams.capacity - 1);
+}
+
+// Adds the cell that contains worldPos to the hash table, if it's not there yet.
+// Returns the cell index, or -1 if the position is out of range or the probe limit is reached.
+int RTXDI_ReGIR_HashedInsertCell(ReGIR_Parameters params, float3 worldPos)
+{
+    uint key;
+    if (!RTXDI_ReGIR_GetHashedCellKey(params, worldPos, key))
+        return -1;
+
+    for (uint probe = 0; probe < params.hashedParams.maxProbes; probe++)
+    {
+        const uint entryIndex = RTXDI_ReGIR_GetHashedEntryIndex(params, key, probe);
+
+        // Most surfaces find their cell already allocated, so look before using the atomic
+        uint storedKey = RTXDI_REGIR_HASH_BUFFER[entryIndex];
+        if (storedKey == 0)
+            InterlockedCompareExchange(RTXDI_REGIR_HASH_BUFFER[entryIndex], 0, key, storedKey);
+
+        if (storedKey == 0 || storedKey == key)
+            return int(entryIndex);
+    }
+
+    return -1;
+}
+
+float RTXDI_ReGIR_GetJitterScale(ReGIR_Parameters params, float3 worldPos)
+{
+    const uint level = RTXDI_ReGIR_GetHashedLevel(params, worldPos);
+    return params.commonParams.samplingJitter * RTXDI_ReGIR_GetHashedCellSize(params, level);
+}
+
+int RTXDI_ReGIR_WorldPosToCellIndex(ReGIR_Parameters params, float3 worldPos)
+{
+    uint key;
+    if (!RTXDI_ReGIR_GetHashedCellKey(params, worldPos, key))
+        return -1;
+
+    for (uint probe = 0; probe < params.hashedParams.maxProbes; probe++)
+    {
+        const uint entryIndex = RTXDI_ReGIR_GetHashedEntryIndex(params, key, probe);
+        const uint storedKey = RTXDI_REGIR_HASH_BUFFER[entryIndex];
+
+        if (storedKey == key)
+            return int(entryIndex);
+
+        // Entries are never removed during a frame, so the probe sequence of the key ends at the first empty one
+        if (storedKey == 0)
+            return -1;
+    }
+
+    return -1;
+}
+
+bool RTXDI_ReGIR_CellIndexToWorldPos(ReGIR_Parameters params, int cellIndex, RTXDI_OUT(float3) cellCenter, RTXDI_OUT(float) cellRadius)
+{
+    cellCenter = float3(0.0, 0.0, 0.0);
+    cellRadius = 0.0;
+
+    if (cellIndex < 0 || uint(cellIndex) >= params.hashedParams.capacity)
+        return false;
+
+    const uint key = RTXDI_REGIR_HASH_BUFFER[cellIndex];
+    if (key == 0)
+        return false;
+
+    const uint level = (key >> 29) - 1;
+    const float cellSize = RTXDI_ReGIR_GetHashedCellSize(params, level);
+    const float3 center = float3(params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ);
+    const int3 centerCell = int3(floor(center / cellSize));
+
+    // Sign-extend the wrapped difference between the key and the cell of the center
+    int3 offset;
+    offset.x = int(((key - uint(centerCell.x)) & 0x3ff) << 22) >> 22;
+    offset.y = int((((key >> 20) - uint(centerCell.y)) & 0x1ff) << 23) >> 23;
+    offset.z = int((((key >> 10) - uint(centerCell.z)) & 0x3ff) << 22) >> 22;
+
+    cellCenter = (float3(centerCell + offset) + 0.5) * cellSize;
+    cellRadius = cellSize * sqrt(3.0);
+
+    return true;
+}
+
+#endif
+
+#if RTXDI_REGIR_MODE != RTXDI_REGIR_DISABLED && defined(RTXDI_REGIR_ACTIVE_CELL_BUFFER)
+
+// Active cells: the cells that the visible surfaces use in a frame are marked with RTXDI_MarkReGIRCell,
+// and the build pass only fills the light slots of these cells, with an indirect dispatch of
+// (ceil(lightsPerCell / group size), active cell count, 1) thread groups read from the start of the buffer.
+// Cells that are not marked keep stale light slots, so sampling treats them like positions outside the structure.
+
+bool RTXDI_ReGIR_IsCellActive(int cellIndex)
+{
+    if (cellIndex < 0)
+        return false;
+
+    const uint occupancy = RTXDI_REGIR_ACTIVE_CELL_BUFFER[RTXDI_REGIR_ACTIVE_CELL_OCCUPANCY_OFFSET + (uint(cellIndex) >> 5)];
+    return (occupancy & (1u << (uint(cellIndex) & 31))) != 0;
+}
+
+void RTXDI_ReGIR_MarkCellActive(ReGIR_Parameters params, int cellIndex)
+{
+    if (cellIndex < 0)
+        return;
+
+    const uint wordIndex = RTXDI_REGIR_ACTIVE_CELL_OCCUPANCY_OFFSET + (uint(cellIndex) >> 5);
+    const uint cellBit = 1u << (uint(cellIndex) & 31);
+
+    // Most surfaces find their cell already marked, so look before using the atomic
+    if ((RTXDI_REGIR_ACTIVE_CELL_BUFFER[wordIndex] & cellBit) != 0)
+        return;
+
+    uint occupancy;
+    InterlockedOr(RTXDI_REGIR_ACTIVE_CELL_BUFFER[wordIndex], cellBit, occupancy);
+    if ((occupancy & cellBit) != 0)
+        return;
+
+    // The thread that sets the bit appends the cell to the list
+    uint listIndex;
+    RTXDI_INTERLOCKED_ADD(RTXDI_REGIR_ACTIVE_CELL_BUFFER[RTXDI_REGIR_ACTIVE_CELL_COUNTER_OFFSET], 1, listIndex);
+    if (listIndex < params.commonParams.maxActiveCells)
+    {
+        RTXDI_REGIR_ACTIVE_CELL_BUFFER[params.commonParams.activeCellListOffset + listIndex] = uint(cellIndex);
+        InterlockedAdd(RTXDI_REGIR_ACTIVE_CELL_BUFFER[RTXDI_REGIR_ACTIVE_CELL_DISPATCH_ARGS_OFFSET + 1], 1);
+    }
+    else
+    {
+        // The list is full, the cell won't be built
+        InterlockedAnd(RTXDI_REGIR_ACTIVE_CELL_BUFFER[wordIndex], ~cellBit, occupancy);
+    }
+}
+
+// Maps a thread of the indirect build pass to a light slot for RTXDI_PresampleLocalLightsForReGIR.
+// activeCellIndex is the Y thread group index, lightInCell the X thread index in the dispatch.
+// Returns false for the threads past the last light slot of the cell.
+bool RTXDI_ReGIR_GetActiveCellLightSlot(ReGIR_Parameters params, uint activeCellIndex, uint lightInCell, RTXDI_OUT(uint) lightSlot)
+{
+    lightSlot = 0;
+    if (lightInCell >= params.commonParams.lightsPerCell)
+        return false;
+
+    const uint cellIndex = RTXDI_REGIR_ACTIVE_CELL_BUFFER[params.commonParams.activeCellListOffset + activeCellIndex];
+    lightSlot = cellIndex * params.commonParams.lightsPerCell + lightInCell;
+    return true;
+}
+
+#endif // RTXDI_REGIR_MODE != RTXDI_REGIR_DISABLED && defined(RTXDI_REGIR_ACTIVE_CELL_BUFFER)
+
 #if RTXDI_REGIR_MODE != RTXDI_REGIR_DISABLED
 
 float3 RTXDI_VisualizeReGIRCells(ReGIR_Parameters params, float3 worldPos)
@@ -44,7 +44,24 @@ namespace rtxdi
         uint32_t RenderWidth = 0;
         uint32_t RenderHeight = 0;
 
+        // Largest render size that resize() accepts without reallocating the reservoir buffers.
+        // The reservoir buffers are sized for it. 0 means the initial render size.
+        uint32_t MaxRenderWidth = 0;
+        uint32_t MaxRenderHeight = 0;
+
         CheckerboardMode CheckerboardSamplingMode = CheckerboardMode::Off;
+
+        // First reservoir array used by the context, for several contexts sharing one reservoir buffer.
+        // The buffer indices returned by the context are in [ReservoirArrayOffset, ReservoirArrayOffset + NumReservoirBuffers).
+        uint32_t ReservoirArrayOffset = 0;
+
+        // Must be StructureOfArrays when the shaders are compiled with RTXDI_SOA_DI_RESERVOIR
+        ReservoirLayout ReservoirBufferLayout = ReservoirLayout::ArrayOfStructures;
+
+        // Size of the square blocks of the reservoir buffer, a power of two from 2 up. Matching it to the thread group
+        // shape of the passes, or using the Z-order within blocks, keeps the reservoirs of a group in fewer cache lines.
+        uint32_t ReservoirBlockSize = RTXDI_RESERVOIR_BLOCK_SIZE;
+        ReservoirBlockOrder ReservoirBlockAddressing = ReservoirBlockOrder::RowMajor;
     };
 
     constexpr ReSTIRDI_BufferIndices getDefaultReSTIRDIBufferIndices()
@@ -97,9 +114,30 @@ namespace rtxdi
         params.spatialDepthThreshold = 0.1f;
         params.spatialNormalThreshold = 0.5f;
         params.spatialSamplingRadius = 32.0f;
+        params.enableAdaptiveSampleCount = false;
+        params.minSpatialSamples = 1;
+        params.adaptiveConvergedM = 20;
+        params.adaptiveVarianceScale = 1.0f;
         return params;
     }
 
+    // Settings of the controller that tunes the spatial sample budget, see ReSTIRDIContext::updateAdaptiveSpatialSampling
+    struct ReSTIRDIAdaptiveSpatialSamplingParameters
+    {
+        // Average number of neighbors per pixel that the spatial pass should consider
+        float targetSamplesPerPixel = 2.0f;
+
+        // Range of the largest per-pixel neighbor count (numSpatialSamples) set by the controller
+        uint32_t minBudget = 1;
+        uint32_t maxBudget = 16;
+
+        // Exponent of the correction applied per frame, lower values react slower but don't oscillate
+        float responsiveness = 0.5f;
+
+        // Relative error below which the budget is kept, so it doesn't toggle between neighboring integer counts
+        float tolerance = 0.1f;
+    };
+
     constexpr ReSTIRDI_ShadingParameters getDefaultReSTIRDIShadingParams()
     {
         ReSTIRDI_ShadingParameters params = {};
@@ -123,6 +161,7 @@ namespace rtxdi
         ReSTIRDI_BufferIndices getBufferIndices() const;
         ReSTIRDI_InitialSamplingParameters getInitialSamplingParameters() const;
         ReSTIRDI_TemporalResamplingParameters getTemporalResamplingParameters() const;
+        // numSpatialSamples is replaced with the controller budget once updateAdaptiveSpatialSampling has run
         ReSTIRDI_SpatialResamplingParameters getSpatialResamplingParameters() const;
         ReSTIRDI_ShadingParameters getShadingParameters() const;
 
@@ -136,6 +175,21 @@ namespace rtxdi
         void setSpatialResamplingParameters(const ReSTIRDI_SpatialResamplingParameters& spatialResamplingParams);
         void setShadingParameters(const ReSTIRDI_ShadingParameters& shadingParams);
 
+        const ReSTIRDIAdaptiveSpatialSamplingParameters& getAdaptiveSpatialSamplingParameters() const;
+        void setAdaptiveSpatialSamplingParameters(const ReSTIRDIAdaptiveSpatialSamplingParameters& adaptiveParams);
+
+        // Tunes the largest per-pixel neighbor count of the adaptive spatial mode so that the average count approaches
+        // targetSamplesPerPixel. spatialSamplesTaken is the RTXDI_COUNTER_SPATIAL_SAMPLES counter of a recent frame,
+        // see ReSTIRCounters::spatialSamples. Does nothing unless enableAdaptiveSampleCount is set.
+        void updateAdaptiveSpatialSampling(uint64_t spatialSamplesTaken);
+
+        // Changes the render size without recreating the context. Call it after setFrameIndex
+        // for the first frame rendered at the new size; that frame reprojects into the previous frame
+        // with the scale in RTXDI_RuntimeParameters, so temporal history is kept.
+        // Returns false if the new size exceeds the maximum render size. The reservoir buffer parameters
+        // then grow to fit it and the reservoir buffers must be reallocated, which discards the history.
+        bool resize(uint32_t renderWidth, uint32_t renderHeight);
+
         static const uint32_t NumReservoirBuffers;
 
     private:
@@ -145,6 +199,8 @@ namespace rtxdi
         uint32_t m_frameIndex;
 
         ReSTIRDIStaticParameters m_staticParams;
+        uint32_t m_prevFrameRenderWidth;
+        uint32_t m_prevFrameRenderHeight;
 
         ReSTIRDI_ResamplingMode m_resamplingMode;
         RTXDI_ReservoirBufferParameters m_reservoirBufferParams;
@@ -156,7 +212,11 @@ namespace rtxdi
         ReSTIRDI_SpatialResamplingParameters m_spatialResamplingParams;
         ReSTIRDI_ShadingParameters m_shadingParams;
 
+        ReSTIRDIAdaptiveSpatialSamplingParameters m_adaptiveSpatialSamplingParams;
+        float m_adaptiveSpatialBudget = 0.f; // 0 until the controller runs
+
         void updateBufferIndices();
         void updateCheckerboardField();
+        void updatePrevFrameScale();
     };
 }
@@ -0,0 +1,119 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ReSTIRDI.h"
+
+namespace rtxdi
+{
+    // Parameters of the frame being executed, as they would be bound to the constant buffer of the GPU passes.
+    struct ReSTIRDIHostFrameParameters
+    {
+        ReSTIRDI_Parameters restirDI;
+        RTXDI_RuntimeParameters runtimeParams;
+        uint32_t frameIndex;
+    };
+
+    // Body of a pass for a single reservoir, the host equivalent of one compute shader thread.
+    // The reservoir position is the dispatch thread index; use RTXDI_ReservoirPosToPixelPos to get the pixel.
+    using ReSTIRDIHostPassFunction = std::function<void(uint32_t reservoirX, uint32_t reservoirY, const ReSTIRDIHostFrameParameters& params)>;
+
+    // Pass bodies for a ReSTIR DI frame, usually implemented with a host build of the shader headers (see RtxdiHostTypes.h).
+    // Passes that are not used by the context's resampling mode may be left empty.
+    struct ReSTIRDIHostPasses
+    {
+        ReSTIRDIHostPassFunction initialSampling;
+        ReSTIRDIHostPassFunction temporalResampling;
+        ReSTIRDIHostPassFunction spatialResampling;
+        ReSTIRDIHostPassFunction fusedSpatiotemporalResampling;
+        ReSTIRDIHostPassFunction shading;
+    };
+
+    // Wall-clock time of each pass of the last executeFrame call, in milliseconds. Passes that didn't run are 0.
+    struct ReSTIRDIHostPassTimings
+    {
+        double initialSampling = 0.0;
+        double temporalResampling = 0.0;
+        double spatialResampling = 0.0;
+        double fusedSpatiotemporalResampling = 0.0;
+        double shading = 0.0;
+    };
+
+    // Runs ReSTIR DI passes on the CPU using a pool of worker threads.
+    // Each pass is split into tiles of the size of the reservoir buffer blocks,
+    // which map to contiguous ranges of the reservoir buffer. Tiles are distributed evenly between the workers,
+    // and workers that run out of tiles steal from the others. Passes are separated by a full barrier,
+    // like consecutive GPU dispatches.
+    class ReSTIRDIHostExecutor
+    {
+    public:
+        // threadCount = 0 uses all hardware threads. The calling thread participates in the work.
+        ReSTIRDIHostExecutor(uint32_t threadCount = 0);
+        ~ReSTIRDIHostExecutor();
+
+        ReSTIRDIHostExecutor(const ReSTIRDIHostExecutor&) = delete;
+        ReSTIRDIHostExecutor& operator=(const ReSTIRDIHostExecutor&) = delete;
+
+        // Executes initial sampling, resampling and shading for the current frame of the context,
+        // reading and writing the reservoir buffers selected by getBufferIndices().
+        void executeFrame(const ReSTIRDIContext& context, const ReSTIRDIHostPasses& passes);
+
+        // Executes a single pass over a grid of reservoirs, split into tiles of tileSize x tileSize reservoirs.
+        void executePass(uint32_t reservoirWidth, uint32_t reservoirHeight, const ReSTIRDIHostPassFunction& pass, const ReSTIRDIHostFrameParameters& params,
+            uint32_t tileSize = RTXDI_RESERVOIR_BLOCK_SIZE);
+
+        uint32_t getThreadCount() const;
+        const ReSTIRDIHostPassTimings& getLastFrameTimings() const;
+
+        static ReSTIRDIHostFrameParameters getFrameParameters(const ReSTIRDIContext& context);
+
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            uint32_t begin = 0;
+            uint32_t end = 0;
+        };
+
+        std::vector<std::thread> m_threads;
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+        ReSTIRDIHostPassTimings m_lastFrameTimings;
+
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_workDone;
+        uint64_t m_passGeneration = 0;
+        uint32_t m_activeWorkers = 0;
+        bool m_shutdown = false;
+
+        const ReSTIRDIHostPassFunction* m_pass = nullptr;
+        const ReSTIRDIHostFrameParameters* m_params = nullptr;
+        uint32_t m_reservoirWidth = 0;
+        uint32_t m_reservoirHeight = 0;
+        uint32_t m_tilesX = 0;
+        uint32_t m_tileSize = RTXDI_RESERVOIR_BLOCK_SIZE;
+
+        void workerLoop(uint32_t workerIndex);
+        void processTiles(uint32_t workerIndex);
+        bool popTile(uint32_t workerIndex, uint32_t& tileIndex);
+        bool stealTiles(uint32_t workerIndex);
+        void processTile(uint32_t tileIndex);
+    };
+}
@@ -19,7 +19,8 @@ enum class ReSTIRDI_LocalLightSamplingMode : uint32_t
 {
     Uniform = ReSTIRDI_LocalLightSamplingMode_UNIFORM,
     Power_RIS = ReSTIRDI_LocalLightSamplingMode_POWER_RIS,
-    ReGIR_RIS = ReSTIRDI_LocalLightSamplingMode_REGIR_RIS
+    ReGIR_RIS = ReSTIRDI_LocalLightSamplingMode_REGIR_RIS,
+    Alias_RIS = ReSTIRDI_LocalLightSamplingMode_ALIAS_RIS
 };
 
 enum class ReSTIRDI_TemporalBiasCorrectionMode : uint32_t
@@ -98,6 +99,12 @@ struct ReSTIRDI_SpatialResamplingParameters
     float spatialSamplingRadius;
     uint32_t neighborOffsetMask;
     uint32_t discountNaiveSamples;
+
+    // Adaptive sample count, see RTXDI_GetAdaptiveSpatialSampleCount
+    uint32_t enableAdaptiveSampleCount;
+    uint32_t minSpatialSamples;
+    uint32_t adaptiveConvergedM;
+    float adaptiveVarianceScale;
 };
 
 struct ReSTIRDI_ShadingParameters
@@ -19,11 +19,40 @@ namespace rtxdi
 
 static constexpr uint32_t c_NumReSTIRGIReservoirBuffers = 2;
 
+// Resolution of the GI reservoirs relative to the render resolution
+enum class ReSTIRGI_ReservoirResolution : uint32_t
+{
+    Full = 0,
+    // One reservoir per 2x2 pixel quad, see RTXDI_GIPixelPosToReservoirPos and RTXDI_GIUpsampleReservoir.
+    // Not compatible with checkerboard sampling, ReSTIRGIContext turns it off.
+    Quarter = 1
+};
+
+// Log2 of the number of pixels covered by a reservoir along each axis, the downscaleLog2 of CalculateReservoirBufferParameters
+constexpr uint32_t GetReservoirDownscaleLog2(ReSTIRGI_ReservoirResolution resolution)
+{
+    return (resolution == ReSTIRGI_ReservoirResolution::Quarter) ? 1 : 0;
+}
+
 struct ReSTIRGIStaticParameters
 {
     uint32_t RenderWidth = 0;
     uint32_t RenderHeight = 0;
+    // Largest render size that resize() accepts without reallocating the reservoir buffers.
+    // 0 means the initial render size.
+    uint32_t MaxRenderWidth = 0;
+    uint32_t MaxRenderHeight = 0;
+    // Ignored with quarter-resolution reservoirs, see ReSTIRGI_ReservoirResolution::Quarter
     CheckerboardMode CheckerboardSamplingMode = CheckerboardMode::Off;
+    // First reservoir array used by the context, for several contexts sharing one reservoir buffer.
+    // The buffer indices returned by the context are in [ReservoirArrayOffset, ReservoirArrayOffset + c_NumReSTIRGIReservoirBuffers).
+    uint32_t ReservoirArrayOffset = 0;
+    // Must be StructureOfArrays when the shaders are compiled with RTXDI_SOA_GI_RESERVOIR
+    ReservoirLayout ReservoirBufferLayout = ReservoirLayout::ArrayOfStructures;
+    // Size of the square blocks of the reservoir buffer and the order within them, see ReSTIRDIStaticParameters
+    uint32_t ReservoirBlockSize = RTXDI_RESERVOIR_BLOCK_SIZE;
+    ReservoirBlockOrder ReservoirBlockAddressing = ReservoirBlockOrder::RowMajor;
+    ReSTIRGI_ReservoirResolution ReservoirResolution = ReSTIRGI_ReservoirResolution::Full;
 };
 
 enum class ReSTIRGI_ResamplingMode : uint32_t
@@ -95,16 +124,27 @@ public:
     ReSTIRGI_SpatialResamplingParameters getSpatialResamplingParameters() const;
     ReSTIRGI_FinalShadingParameters getFinalShadingParameters() const;
 
+    // Writes the previous frame scale of the GI temporal passes into runtimeParams, see RTXDI_ReprojectPixelPos.
+    // The other fields are left as they are: they come from ReSTIRDIContext::getRuntimeParams or the application.
+    void fillRuntimeParams(RTXDI_RuntimeParameters& runtimeParams) const;
+
     void setFrameIndex(uint32_t frameIndex);
     void setResamplingMode(ReSTIRGI_ResamplingMode resamplingMode);
     void setTemporalResamplingParameters(const ReSTIRGI_TemporalResamplingParameters& temporalResamplingParams);
     void setSpatialResamplingParameters(const ReSTIRGI_SpatialResamplingParameters& spatialResamplingParams);
     void setFinalShadingParameters(const ReSTIRGI_FinalShadingParameters& finalShadingParams);
 
+    // Changes the render size without recreating the context, see ReSTIRDIContext::resize.
+    // Call it after setFrameIndex for the first frame rendered at the new size.
+    // Returns false if the reservoir buffers must be reallocated for the new size.
+    bool resize(uint32_t renderWidth, uint32_t renderHeight);
+
     static uint32_t numReservoirBuffers;
 
 private:
     ReSTIRGIStaticParameters m_staticParams;
+    uint32_t m_prevFrameRenderWidth;
+    uint32_t m_prevFrameRenderHeight;
 
     uint32_t m_frameIndex;
     RTXDI_ReservoirBufferParameters m_reservoirBufferParams;
@@ -16,7 +16,7 @@
 
 struct RTXDI_PackedGIReservoir
 {
-#ifdef __cplusplus
+#if defined(__cplusplus) && !defined(RTXDI_HOST_SHADER_BUILD)
     using float3 = float[3];
 #endif
 
@@ -29,6 +29,23 @@ struct RTXDI_PackedGIReservoir
     float       unused;
 };
 
+// Define this macro to 1 to store GI reservoirs as RTXDI_CompactGIReservoir instead of RTXDI_PackedGIReservoir.
+// The compact format stores the sample position relative to the surface that the reservoir belongs to,
+// so it is loaded and stored with RTXDI_LoadGIReservoirAtSurface and RTXDI_StoreGIReservoirAtSurface.
+// It has no misc data field.
+#ifndef RTXDI_COMPACT_GI_RESERVOIR
+#define RTXDI_COMPACT_GI_RESERVOIR 0
+#endif
+
+struct RTXDI_CompactGIReservoir
+{
+    uint32_t    packed_direction;   // Direction from the receiver to the sample, stored as 2x 16-bit snorms in the octahedral mapping
+    uint32_t    packed_normal;      // Stored as 2x 16-bit snorms in the octahedral mapping
+    uint32_t    packed_radiance;    // Stored as 32bit LogLUV format.
+    float       weight;
+    uint32_t    packed_distance_age_M; // Distance from the receiver as a half, age and M, see GIReservoir.hlsli
+};
+
 #ifdef __cplusplus
 enum class ResTIRGI_TemporalBiasCorrectionMode : uint32_t
 {
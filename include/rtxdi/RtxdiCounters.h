@@ -0,0 +1,58 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include "RtxdiParameters.h"
+
+namespace rtxdi
+{
+    // Decoded contents of the instrumentation counter buffer (RTXDI_COUNTER_BUFFER)
+    // that the resampling functions fill when compiled with RTXDI_ENABLE_COUNTERS.
+    struct ReSTIRCounters
+    {
+        uint64_t temporalSearches = 0;
+        uint64_t temporalSearchFailures = 0;
+        uint64_t disocclusionBoosts = 0;
+        uint64_t boilingFilterRejections = 0;
+        uint64_t biasCorrectionRays = 0;
+        uint64_t spatialSamples = 0;
+
+        // Fraction of temporal neighbor searches that found no matching surface
+        float getTemporalSearchFailureRate() const;
+
+        ReSTIRCounters& operator+=(const ReSTIRCounters& other);
+    };
+
+    // Decodes a counter buffer of RTXDI_COUNTER_COUNT elements read back from the GPU
+    ReSTIRCounters DecodeReSTIRCounters(const uint32_t* counterBuffer);
+    // Decodes the counter buffer of a host build of the shader functions
+    ReSTIRCounters DecodeReSTIRCounters(const std::atomic<uint32_t>* counterBuffer);
+
+    // Accumulates the counters of consecutive frames.
+    class ReSTIRCounterAggregator
+    {
+    public:
+        void addFrame(const ReSTIRCounters& frameCounters);
+        void reset();
+
+        const ReSTIRCounters& getLastFrame() const;
+        const ReSTIRCounters& getTotal() const;
+        uint32_t getFrameCount() const;
+
+    private:
+        ReSTIRCounters m_lastFrame;
+        ReSTIRCounters m_total;
+        uint32_t m_frameCount = 0;
+    };
+}
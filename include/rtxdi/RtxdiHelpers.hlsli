@@ -12,6 +12,23 @@
 #define RTXDI_HELPERS_HLSLI
 
 #include "RtxdiMath.hlsli"
+#include "RtxdiParameters.h"
+
+#ifdef RTXDI_ENABLE_COUNTERS
+#ifndef RTXDI_COUNTER_BUFFER
+#error "RTXDI_COUNTER_BUFFER must be defined to point to a RWBuffer<uint> type resource with RTXDI_COUNTER_COUNT elements"
+#endif
+
+// Adds a value to one of the RTXDI_COUNTER_... counters, using one atomic per wave.
+void RTXDI_IncrementCounter(uint counterIndex, uint value)
+{
+    uint waveTotal = WaveActiveSum(value);
+    if (WaveIsFirstLane() && waveTotal != 0)
+        InterlockedAdd(RTXDI_COUNTER_BUFFER[counterIndex], waveTotal);
+}
+#else
+#define RTXDI_IncrementCounter(counterIndex, value)
+#endif
 
 bool RTXDI_IsActiveCheckerboardPixel(
     uint2 pixelPosition,
@@ -24,7 +41,7 @@ bool RTXDI_IsActiveCheckerboardPixel(
     return ((pixelPosition.x + pixelPosition.y + int(previousFrame)) & 1) == (activeCheckerboardField & 1);
 }
 
-void RTXDI_ActivateCheckerboardPixel(inout uint2 pixelPosition, bool previousFrame, uint activeCheckerboardField)
+void RTXDI_ActivateCheckerboardPixel(RTXDI_INOUT(uint2) pixelPosition, bool previousFrame, uint activeCheckerboardField)
 {
     if (RTXDI_IsActiveCheckerboardPixel(pixelPosition, previousFrame, activeCheckerboardField))
         return;
@@ -35,7 +52,7 @@ void RTXDI_ActivateCheckerboardPixel(inout uint2 pixelPosition, bool previousFra
         pixelPosition.x += (pixelPosition.y & 1) != 0 ? 1 : -1;
 }
 
-void RTXDI_ActivateCheckerboardPixel(inout int2 pixelPosition, bool previousFrame, uint activeCheckerboardField)
+void RTXDI_ActivateCheckerboardPixel(RTXDI_INOUT(int2) pixelPosition, bool previousFrame, uint activeCheckerboardField)
 {
     uint2 uPixelPosition = uint2(pixelPosition);
     RTXDI_ActivateCheckerboardPixel(uPixelPosition, previousFrame, activeCheckerboardField);
@@ -50,6 +67,17 @@ uint2 RTXDI_PixelPosToReservoirPos(uint2 pixelPosition, uint activeCheckerboardF
     return uint2(pixelPosition.x >> 1, pixelPosition.y);
 }
 
+// Maps a pixel position and its screen-space motion into the previous frame,
+// accounting for a render resolution change between the frames.
+// A scale of 0, as in runtime parameters not written by a context, means an unchanged resolution.
+float2 RTXDI_ReprojectPixelPos(uint2 pixelPosition, float2 motion, RTXDI_RuntimeParameters params)
+{
+    float2 prevFrameScale = float2(
+        (params.prevFrameScaleX != 0.0) ? params.prevFrameScaleX : 1.0,
+        (params.prevFrameScaleY != 0.0) ? params.prevFrameScaleY : 1.0);
+    return (float2(pixelPosition) + 0.5 + motion) * prevFrameScale - 0.5;
+}
+
 uint2 RTXDI_ReservoirPosToPixelPos(uint2 reservoirIndex, uint activeCheckerboardField)
 {
     if (activeCheckerboardField == 0)
@@ -60,8 +88,169 @@ uint2 RTXDI_ReservoirPosToPixelPos(uint2 reservoirIndex, uint activeCheckerboard
     return pixelPosition;
 }
 
+// Variable-rate sampling keeps a reservoir for every pixel, so RTXDI_PixelPosToReservoirPos and RTXDI_ReservoirPosToPixelPos
+// are used with activeCheckerboardField = 0. Pixels that are not active in the current frame store an empty reservoir
+// from initial sampling and rely on temporal and spatial resampling, each pixel is refreshed every 1, 2 or 4 frames.
+uint RTXDI_GetVariableSamplingRate(uint rateMapEntry)
+{
+    return rateMapEntry & RTXDI_VARIABLE_RATE_MASK;
+}
+
+// Position of the active pixel within its 2x2 quad at quarter rate, (x & 1) | ((y & 1) << 1).
+// The diagonal pixels go first so that consecutive frames are far apart: 0, 3, 1, 2.
+uint RTXDI_GetVariableRateQuadPixel(uint rateMapEntry)
+{
+    uint phase = (rateMapEntry >> RTXDI_VARIABLE_RATE_PHASE_SHIFT) & 3;
+    return (0x9Cu >> (phase * 2)) & 3;
+}
+
+// Returns whether the pixel takes new initial samples in the current frame.
+// rateMapEntry is the entry of the tile that contains the pixel, at pixelPosition / RTXDI_VARIABLE_RATE_TILE_SIZE.
+bool RTXDI_IsVariableRatePixelActive(uint2 pixelPosition, uint rateMapEntry)
+{
+    uint rate = RTXDI_GetVariableSamplingRate(rateMapEntry);
+    uint phase = (rateMapEntry >> RTXDI_VARIABLE_RATE_PHASE_SHIFT) & 3;
+
+    if (rate == RTXDI_SAMPLING_RATE_HALF)
+        return ((pixelPosition.x + pixelPosition.y + phase) & 1) == 0;
+
+    if (rate == RTXDI_SAMPLING_RATE_QUARTER)
+        return ((pixelPosition.x & 1) | ((pixelPosition.y & 1) << 1)) == RTXDI_GetVariableRateQuadPixel(rateMapEntry);
+
+    return true;
+}
+
+// Size in pixels of the part of a tile that is inside the render area, smaller than the tile at the right and bottom edges
+uint2 RTXDI_GetVariableRateTileExtent(uint2 tilePosition, uint2 renderSize)
+{
+    return min(renderSize - tilePosition * RTXDI_VARIABLE_RATE_TILE_SIZE, uint2(RTXDI_VARIABLE_RATE_TILE_SIZE, RTXDI_VARIABLE_RATE_TILE_SIZE));
+}
+
+// Number of active pixels of a tile inside the render area, for initial sampling dispatches that only launch threads
+// for the active pixels. Slots below this count map to active pixels inside the render area.
+uint RTXDI_GetVariableRateSlotCount(uint2 tilePosition, uint rateMapEntry, uint2 renderSize)
+{
+    uint2 extent = RTXDI_GetVariableRateTileExtent(tilePosition, renderSize);
+    uint rate = RTXDI_GetVariableSamplingRate(rateMapEntry);
+
+    if (rate == RTXDI_SAMPLING_RATE_HALF)
+    {
+        // Each pair of rows holds extent.x active pixels, an odd last row holds those of the first row of a pair
+        uint firstRowParity = (rateMapEntry >> RTXDI_VARIABLE_RATE_PHASE_SHIFT) & 1;
+        return (extent.y / 2) * extent.x + (extent.y & 1) * ((extent.x + 1 - firstRowParity) / 2);
+    }
+
+    if (rate == RTXDI_SAMPLING_RATE_QUARTER)
+    {
+        uint quadPixel = RTXDI_GetVariableRateQuadPixel(rateMapEntry);
+        return ((extent.x + 1 - (quadPixel & 1)) / 2) * ((extent.y + 1 - (quadPixel >> 1)) / 2);
+    }
+
+    return extent.x * extent.y;
+}
+
+// Maps the index of an active pixel within a tile to its pixel position, the variable-rate counterpart of RTXDI_ReservoirPosToPixelPos.
+// slotIndex must be below RTXDI_GetVariableRateSlotCount for the same tile and render size.
+uint2 RTXDI_VariableRateSlotToPixelPos(uint2 tilePosition, uint slotIndex, uint rateMapEntry, uint2 renderSize)
+{
+    uint2 extent = RTXDI_GetVariableRateTileExtent(tilePosition, renderSize);
+    uint rate = RTXDI_GetVariableSamplingRate(rateMapEntry);
+    uint2 offset;
+
+    if (rate == RTXDI_SAMPLING_RATE_HALF)
+    {
+        // Tiles start on even rows, so the first row of every pair has the same parity
+        uint firstRowParity = (rateMapEntry >> RTXDI_VARIABLE_RATE_PHASE_SHIFT) & 1;
+        uint firstRowCount = (extent.x + 1 - firstRowParity) / 2;
+        uint indexInPair = slotIndex % extent.x;
+        offset.y = (slotIndex / extent.x) * 2;
+
+        if (indexInPair < firstRowCount)
+        {
+            offset.x = indexInPair * 2 + firstRowParity;
+        }
+        else
+        {
+            offset.x = (indexInPair - firstRowCount) * 2 + (firstRowParity ^ 1);
+            offset.y += 1;
+        }
+    }
+    else if (rate == RTXDI_SAMPLING_RATE_QUARTER)
+    {
+        uint quadPixel = RTXDI_GetVariableRateQuadPixel(rateMapEntry);
+        uint columns = (extent.x + 1 - (quadPixel & 1)) / 2;
+        offset = uint2(slotIndex % columns, slotIndex / columns) * 2 + uint2(quadPixel & 1, quadPixel >> 1);
+    }
+    else
+    {
+        offset = uint2(slotIndex % extent.x, slotIndex / extent.x);
+    }
+
+    return tilePosition * RTXDI_VARIABLE_RATE_TILE_SIZE + offset;
+}
+
+// Inverse of RTXDI_VariableRateSlotToPixelPos for active pixels, the variable-rate counterpart of RTXDI_PixelPosToReservoirPos
+uint RTXDI_PixelPosToVariableRateSlot(uint2 pixelPosition, uint rateMapEntry, uint2 renderSize)
+{
+    uint2 extent = RTXDI_GetVariableRateTileExtent(pixelPosition / RTXDI_VARIABLE_RATE_TILE_SIZE, renderSize);
+    uint2 offset = pixelPosition % RTXDI_VARIABLE_RATE_TILE_SIZE;
+    uint rate = RTXDI_GetVariableSamplingRate(rateMapEntry);
+
+    if (rate == RTXDI_SAMPLING_RATE_HALF)
+    {
+        uint firstRowParity = (rateMapEntry >> RTXDI_VARIABLE_RATE_PHASE_SHIFT) & 1;
+        uint firstRowCount = (extent.x + 1 - firstRowParity) / 2;
+        return (offset.y / 2) * extent.x + (offset.y & 1) * firstRowCount + offset.x / 2;
+    }
+
+    if (rate == RTXDI_SAMPLING_RATE_QUARTER)
+    {
+        uint quadPixel = RTXDI_GetVariableRateQuadPixel(rateMapEntry);
+        uint columns = (extent.x + 1 - (quadPixel & 1)) / 2;
+        return (offset.y / 2) * columns + offset.x / 2;
+    }
+
+    return offset.y * extent.x + offset.x;
+}
+
+// Returns the first index into the neighbor offset buffer for spatial resampling, see RTXDI_NEIGHBOR_SELECTION_MODE.
+// The random number is drawn on every lane so that the sequences of the lanes don't depend on the mode.
+uint RTXDI_GetNeighborSampleStartIndex(float random, uint neighborOffsetMask)
+{
+    uint startIdx = uint(random * neighborOffsetMask);
+#if RTXDI_NEIGHBOR_SELECTION_MODE == RTXDI_NEIGHBOR_SELECTION_PER_WAVE
+    startIdx = WaveReadLaneFirst(startIdx);
+#elif RTXDI_NEIGHBOR_SELECTION_MODE == RTXDI_NEIGHBOR_SELECTION_PER_QUAD
+    startIdx = QuadReadLaneAt(startIdx, 0);
+#endif
+    return startIdx;
+}
+
+// Rotates a neighbor offset by a multiple of 90 degrees chosen by the position of the pixel within its 2x2 quad,
+// so that the pixels sharing a start index don't all reuse the same neighbors. With RTXDI_NEIGHBOR_ROTATION_PER_QUAD,
+// the rotation is chosen by the position of the quad instead and the pixels of a quad keep the same offset.
+// Identity in the per-pixel mode.
+int2 RTXDI_RotateNeighborOffset(int2 offset, uint2 pixelPosition)
+{
+#if RTXDI_NEIGHBOR_SELECTION_MODE != RTXDI_NEIGHBOR_SELECTION_PER_PIXEL
+#if RTXDI_NEIGHBOR_ROTATION_PER_QUAD
+    pixelPosition >>= 1;
+#endif
+    uint rotation = (pixelPosition.x & 1) | ((pixelPosition.y & 1) << 1);
+    if (rotation == 1)
+        return int2(-offset.y, offset.x);
+    if (rotation == 2)
+        return int2(offset.y, -offset.x);
+    if (rotation == 3)
+        return -offset;
+#else
+    RTXDI_UNUSED(pixelPosition);
+#endif
+    return offset;
+}
+
 // Internal SDK function that permutes the pixels sampled from the previous frame.
-void RTXDI_ApplyPermutationSampling(inout int2 prevPixelPos, uint uniformRandomNumber)
+void RTXDI_ApplyPermutationSampling(RTXDI_INOUT(int2) prevPixelPos, uint uniformRandomNumber)
 {
     int2 offset = int2(uniformRandomNumber & 3, (uniformRandomNumber >> 2) & 3);
     prevPixelPos += offset;
@@ -72,23 +261,43 @@ void RTXDI_ApplyPermutationSampling(inout int2 prevPixelPos, uint uniformRandomN
     prevPixelPos -= offset;
 }
 
+// Log2 of the number of pixels covered by a reservoir along each axis
+uint RTXDI_GetReservoirDownscaleLog2(RTXDI_ReservoirBufferParameters reservoirParams)
+{
+    return (reservoirParams.reservoirAddressing >> RTXDI_RESERVOIR_DOWNSCALE_LOG2_SHIFT) & RTXDI_RESERVOIR_DOWNSCALE_LOG2_MASK;
+}
+
+// Log2 of the block size of the reservoir buffer, where 0 in reservoirAddressing means the default block size
+uint RTXDI_GetReservoirBlockSizeLog2(RTXDI_ReservoirBufferParameters reservoirParams)
+{
+    uint blockSizeLog2 = reservoirParams.reservoirAddressing & RTXDI_RESERVOIR_BLOCK_SIZE_LOG2_MASK;
+    return (blockSizeLog2 != 0) ? blockSizeLog2 : RTXDI_RESERVOIR_BLOCK_SIZE_LOG2;
+}
+
 uint RTXDI_ReservoirPositionToPointer(
     RTXDI_ReservoirBufferParameters reservoirParams,
     uint2 reservoirPosition,
     uint reservoirArrayIndex)
 {
-    uint2 blockIdx = reservoirPosition / RTXDI_RESERVOIR_BLOCK_SIZE;
-    uint2 positionInBlock = reservoirPosition % RTXDI_RESERVOIR_BLOCK_SIZE;
+    uint blockSizeLog2 = RTXDI_GetReservoirBlockSizeLog2(reservoirParams);
+    uint2 blockIdx = reservoirPosition >> blockSizeLog2;
+    uint2 positionInBlock = reservoirPosition & ((1u << blockSizeLog2) - 1);
+
+    uint indexInBlock = ((reservoirParams.reservoirAddressing & RTXDI_RESERVOIR_BLOCK_ZORDER_BIT) != 0)
+        ? RTXDI_ZCurveToLinearIndex(positionInBlock)
+        : (positionInBlock.y << blockSizeLog2) + positionInBlock.x;
 
     return reservoirArrayIndex * reservoirParams.reservoirArrayPitch
         + blockIdx.y * reservoirParams.reservoirBlockRowPitch
-        + blockIdx.x * (RTXDI_RESERVOIR_BLOCK_SIZE * RTXDI_RESERVOIR_BLOCK_SIZE)
-        + positionInBlock.y * RTXDI_RESERVOIR_BLOCK_SIZE
-        + positionInBlock.x;
+        + (blockIdx.x << (blockSizeLog2 * 2))
+        + indexInBlock;
 }
 
 #ifdef RTXDI_ENABLE_BOILING_FILTER
 // RTXDI_BOILING_FILTER_GROUP_SIZE must be defined - 16 is a reasonable value
+#ifdef RTXDI_HOST_SHADER_BUILD
+#error "The boiling filter relies on thread group execution and is not available in host builds"
+#endif
 #define RTXDI_BOILING_FILTER_MIN_LANE_COUNT 32
 
 groupshared float s_weights[(RTXDI_BOILING_FILTER_GROUP_SIZE * RTXDI_BOILING_FILTER_GROUP_SIZE + RTXDI_BOILING_FILTER_MIN_LANE_COUNT - 1) / RTXDI_BOILING_FILTER_MIN_LANE_COUNT];
@@ -0,0 +1,575 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef RTXDI_HOST_TYPES_H
+#define RTXDI_HOST_TYPES_H
+
+// Host (C++) definitions of the HLSL types and intrinsics used by the RTXDI shader headers.
+// Include this header before any .hlsli file to compile the resampling functions on the CPU,
+// e.g. as a reference implementation for validating a GPU integration.
+//
+// The application provides the RAB_* bridge (structures and functions) in the same translation unit,
+// exactly like it does for the shader build. The shader functions are not declared inline,
+// so each .hlsli file must be included into a single translation unit of the program.
+//
+// Textures are accessed through rtxdi::host::Texture2D. Wave intrinsics operate on a single lane,
+// therefore features that depend on cross-lane or thread group communication
+// (RTXDI_ENABLE_BOILING_FILTER) are not available.
+
+#ifndef __cplusplus
+#error "RtxdiHostTypes.h must be compiled as C++"
+#endif
+
+#ifndef RTXDI_HOST_SHADER_BUILD
+#define RTXDI_HOST_SHADER_BUILD 1
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+typedef uint32_t uint;
+
+namespace rtxdi
+{
+namespace host
+{
+
+template<typename T>
+struct identity { typedef T type; };
+
+template<typename T, int N>
+struct vector;
+
+// Writable view of the leading M components of a vector, used for the .xy and .xyz swizzles.
+// Only prefix swizzles are provided so that the implicit copy of the storage is always correct.
+template<typename T, int M>
+struct swizzle
+{
+    T e[M];
+
+    operator vector<T, M>() const
+    {
+        vector<T, M> result;
+        for (int i = 0; i < M; ++i)
+            result.e[i] = e[i];
+        return result;
+    }
+
+    swizzle& operator=(const vector<T, M>& v)
+    {
+        for (int i = 0; i < M; ++i)
+            e[i] = v.e[i];
+        return *this;
+    }
+
+    swizzle& operator+=(const vector<T, M>& v) { return *this = vector<T, M>(*this) + v; }
+    swizzle& operator-=(const vector<T, M>& v) { return *this = vector<T, M>(*this) - v; }
+    swizzle& operator*=(const vector<T, M>& v) { return *this = vector<T, M>(*this) * v; }
+    swizzle& operator/=(const vector<T, M>& v) { return *this = vector<T, M>(*this) / v; }
+    swizzle& operator+=(T s) { return *this = vector<T, M>(*this) + s; }
+    swizzle& operator-=(T s) { return *this = vector<T, M>(*this) - s; }
+    swizzle& operator*=(T s) { return *this = vector<T, M>(*this) * s; }
+    swizzle& operator/=(T s) { return *this = vector<T, M>(*this) / s; }
+
+    friend vector<T, M> operator+(const swizzle& a, const vector<T, M>& b) { return vector<T, M>(a) + b; }
+    friend vector<T, M> operator-(const swizzle& a, const vector<T, M>& b) { return vector<T, M>(a) - b; }
+    friend vector<T, M> operator*(const swizzle& a, const vector<T, M>& b) { return vector<T, M>(a) * b; }
+    friend vector<T, M> operator/(const swizzle& a, const vector<T, M>& b) { return vector<T, M>(a) / b; }
+    friend vector<T, M> operator+(const swizzle& a, T b) { return vector<T, M>(a) + b; }
+    friend vector<T, M> operator-(const swizzle& a, T b) { return vector<T, M>(a) - b; }
+    friend vector<T, M> operator*(const swizzle& a, T b) { return vector<T, M>(a) * b; }
+    friend vector<T, M> operator/(const swizzle& a, T b) { return vector<T, M>(a) / b; }
+    friend vector<T, M> operator-(const swizzle& a) { return -vector<T, M>(a); }
+};
+
+template<typename T, int N>
+struct vector_storage;
+
+template<typename T>
+struct vector_storage<T, 2>
+{
+    union
+    {
+        T e[2];
+        struct { T x, y; };
+        swizzle<T, 2> xy;
+    };
+};
+
+template<typename T>
+struct vector_storage<T, 3>
+{
+    union
+    {
+        T e[3];
+        struct { T x, y, z; };
+        swizzle<T, 2> xy;
+        swizzle<T, 3> xyz;
+    };
+};
+
+template<typename T>
+struct vector_storage<T, 4>
+{
+    union
+    {
+        T e[4];
+        struct { T x, y, z, w; };
+        swizzle<T, 2> xy;
+        swizzle<T, 3> xyz;
+    };
+};
+
+template<typename T, int N>
+struct vector : vector_storage<T, N>
+{
+    using vector_storage<T, N>::e;
+
+    vector() = default;
+
+    explicit vector(T s)
+    {
+        for (int i = 0; i < N; ++i)
+            e[i] = s;
+    }
+
+    template<typename... A, typename = typename std::enable_if<sizeof...(A) == N && N >= 2>::type>
+    vector(A... components)
+    {
+        const T values[] = { T(components)... };
+        for (int i = 0; i < N; ++i)
+            e[i] = values[i];
+    }
+
+    // Constructs e.g. int3(int2, int) or float4(float3, float)
+    template<int M, typename... A, typename = typename std::enable_if<(M + int(sizeof...(A)) == N) && (M < N)>::type>
+    vector(const vector<T, M>& v, A... rest)
+    {
+        const T values[] = { T(rest)... };
+        for (int i = 0; i < M; ++i)
+            e[i] = v.e[i];
+        for (int i = M; i < N; ++i)
+            e[i] = values[i - M];
+    }
+
+    // HLSL converts between vector element types implicitly
+    template<typename U, typename = typename std::enable_if<!std::is_same<T, U>::value>::type>
+    vector(const vector<U, N>& v)
+    {
+        for (int i = 0; i < N; ++i)
+            e[i] = T(v.e[i]);
+    }
+
+    T& operator[](int i) { return e[i]; }
+    const T& operator[](int i) const { return e[i]; }
+
+    friend vector operator-(const vector& a) { vector r; for (int i = 0; i < N; ++i) r.e[i] = -a.e[i]; return r; }
+    friend vector operator~(const vector& a) { vector r; for (int i = 0; i < N; ++i) r.e[i] = ~a.e[i]; return r; }
+    friend vector<bool, N> operator!(const vector& a) { vector<bool, N> r; for (int i = 0; i < N; ++i) r.e[i] = !a.e[i]; return r; }
+
+#define RTXDI_HOST_VECTOR_BINARY_OP(op) \
+    friend vector operator op(const vector& a, const vector& b) { vector r; for (int i = 0; i < N; ++i) r.e[i] = T(a.e[i] op b.e[i]); return r; } \
+    friend vector operator op(const vector& a, T b) { vector r; for (int i = 0; i < N; ++i) r.e[i] = T(a.e[i] op b); return r; } \
+    friend vector operator op(T a, const vector& b) { vector r; for (int i = 0; i < N; ++i) r.e[i] = T(a op b.e[i]); return r; } \
+    vector& operator op##=(const vector& b) { for (int i = 0; i < N; ++i) e[i] = T(e[i] op b.e[i]); return *this; } \
+    vector& operator op##=(T b) { for (int i = 0; i < N; ++i) e[i] = T(e[i] op b); return *this; }
+
+    RTXDI_HOST_VECTOR_BINARY_OP(+)
+    RTXDI_HOST_VECTOR_BINARY_OP(-)
+    RTXDI_HOST_VECTOR_BINARY_OP(*)
+    RTXDI_HOST_VECTOR_BINARY_OP(/)
+    RTXDI_HOST_VECTOR_BINARY_OP(%)
+    RTXDI_HOST_VECTOR_BINARY_OP(&)
+    RTXDI_HOST_VECTOR_BINARY_OP(|)
+    RTXDI_HOST_VECTOR_BINARY_OP(^)
+    RTXDI_HOST_VECTOR_BINARY_OP(<<)
+    RTXDI_HOST_VECTOR_BINARY_OP(>>)
+#undef RTXDI_HOST_VECTOR_BINARY_OP
+
+#define RTXDI_HOST_VECTOR_COMPARE_OP(op) \
+    friend vector<bool, N> operator op(const vector& a, const vector& b) { vector<bool, N> r; for (int i = 0; i < N; ++i) r.e[i] = a.e[i] op b.e[i]; return r; } \
+    friend vector<bool, N> operator op(const vector& a, T b) { vector<bool, N> r; for (int i = 0; i < N; ++i) r.e[i] = a.e[i] op b; return r; }
+
+    RTXDI_HOST_VECTOR_COMPARE_OP(==)
+    RTXDI_HOST_VECTOR_COMPARE_OP(!=)
+    RTXDI_HOST_VECTOR_COMPARE_OP(<)
+    RTXDI_HOST_VECTOR_COMPARE_OP(<=)
+    RTXDI_HOST_VECTOR_COMPARE_OP(>)
+    RTXDI_HOST_VECTOR_COMPARE_OP(>=)
+#undef RTXDI_HOST_VECTOR_COMPARE_OP
+};
+
+template<typename T, int R, int C>
+struct matrix
+{
+    vector<T, C> rows[R];
+
+    matrix() = default;
+
+    template<typename... A, typename = typename std::enable_if<sizeof...(A) == R * C>::type>
+    matrix(A... elements)
+    {
+        const T values[] = { T(elements)... };
+        for (int r = 0; r < R; ++r)
+            for (int c = 0; c < C; ++c)
+                rows[r].e[c] = values[r * C + c];
+    }
+
+    vector<T, C>& operator[](int r) { return rows[r]; }
+    const vector<T, C>& operator[](int r) const { return rows[r]; }
+};
+
+// Non-owning view of a single-channel float texture with a mip chain, used in place of Texture2D<float>.
+// Each mip level is stored as a tightly packed row-major array of max(1, width >> mip) x max(1, height >> mip) values.
+struct Texture2D
+{
+    const float* const* mipLevels = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 0;
+
+    // Same semantics as Texture2D.Load in HLSL: out-of-bounds reads return zero.
+    vector<float, 4> Load(const vector<int, 3>& location) const
+    {
+        const int mip = location.e[2];
+        if (mip < 0 || uint32_t(mip) >= mipCount)
+            return vector<float, 4>(0.f);
+
+        const int mipWidth = int(std::max(width >> mip, 1u));
+        const int mipHeight = int(std::max(height >> mip, 1u));
+        if (location.e[0] < 0 || location.e[1] < 0 || location.e[0] >= mipWidth || location.e[1] >= mipHeight)
+            return vector<float, 4>(0.f);
+
+        return vector<float, 4>(mipLevels[mip][location.e[1] * mipWidth + location.e[0]], 0.f, 0.f, 1.f);
+    }
+};
+
+} // namespace host
+} // namespace rtxdi
+
+// Scalar intrinsics
+
+using std::abs;
+using std::floor;
+using std::ceil;
+using std::round;
+using std::trunc;
+using std::sqrt;
+using std::exp;
+using std::exp2;
+using std::log;
+using std::log2;
+using std::pow;
+using std::sin;
+using std::cos;
+using std::tan;
+using std::asin;
+using std::acos;
+using std::atan;
+using std::atan2;
+
+template<typename A, typename B, typename = typename std::enable_if<std::is_arithmetic<A>::value && std::is_arithmetic<B>::value>::type>
+inline typename std::common_type<A, B>::type min(A a, B b)
+{
+    typedef typename std::common_type<A, B>::type T;
+    return T(a) < T(b) ? T(a) : T(b);
+}
+
+template<typename A, typename B, typename = typename std::enable_if<std::is_arithmetic<A>::value && std::is_arithmetic<B>::value>::type>
+inline typename std::common_type<A, B>::type max(A a, B b)
+{
+    typedef typename std::common_type<A, B>::type T;
+    return T(a) > T(b) ? T(a) : T(b);
+}
+
+template<typename A, typename B, typename C, typename = typename std::enable_if<std::is_arithmetic<A>::value && std::is_arithmetic<B>::value && std::is_arithmetic<C>::value>::type>
+inline typename std::common_type<A, B, C>::type clamp(A x, B lo, C hi)
+{
+    return min(max(x, lo), hi);
+}
+
+inline float saturate(float x) { return clamp(x, 0.f, 1.f); }
+inline float frac(float x) { return x - std::floor(x); }
+inline float rcp(float x) { return 1.f / x; }
+inline float rsqrt(float x) { return 1.f / std::sqrt(x); }
+inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
+inline float step(float edge, float x) { return x >= edge ? 1.f : 0.f; }
+inline void sincos(float x, float& s, float& c) { s = std::sin(x); c = std::cos(x); }
+inline bool isinf(float x) { return std::isinf(x); }
+inline bool isnan(float x) { return std::isnan(x); }
+inline bool isfinite(float x) { return std::isfinite(x); }
+
+template<typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+inline int sign(T x) { return (T(0) < x) - (x < T(0)); }
+
+inline uint asuint(float x) { uint r; std::memcpy(&r, &x, sizeof(r)); return r; }
+inline uint asuint(uint x) { return x; }
+inline uint asuint(int x) { return uint(x); }
+inline int asint(float x) { int r; std::memcpy(&r, &x, sizeof(r)); return r; }
+inline float asfloat(uint x) { float r; std::memcpy(&r, &x, sizeof(r)); return r; }
+inline float asfloat(int x) { return asfloat(uint(x)); }
+inline float asfloat(float x) { return x; }
+
+inline uint countbits(uint x) { uint n = 0; for (; x; x &= x - 1) ++n; return n; }
+inline uint reversebits(uint x)
+{
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+}
+inline uint firstbitlow(uint x) { if (x == 0) return ~0u; uint n = 0; while (!(x & 1u)) { x >>= 1; ++n; } return n; }
+inline uint firstbithigh(uint x) { if (x == 0) return ~0u; uint n = 31; while (!(x & 0x80000000u)) { x <<= 1; --n; } return n; }
+
+// IEEE 754 binary16 conversion with round-to-nearest-even, matching the GPU behavior for finite values.
+inline uint f32tof16(float value)
+{
+    const uint f = asuint(value);
+    const uint sign = (f >> 16) & 0x8000u;
+    const int exponent = int((f >> 23) & 0xffu) - 127 + 15;
+    uint mantissa = f & 0x7fffffu;
+
+    if (((f >> 23) & 0xffu) == 0xffu)
+        return sign | 0x7c00u | (mantissa ? 0x200u : 0u);
+
+    if (exponent >= 31)
+        return sign | 0x7c00u;
+
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return sign;
+        mantissa |= 0x800000u;
+        const uint shift = uint(14 - exponent);
+        uint half = mantissa >> shift;
+        const uint remainder = mantissa & ((1u << shift) - 1u);
+        const uint halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (half & 1u)))
+            ++half;
+        return sign | half;
+    }
+
+    uint half = (uint(exponent) << 10) | (mantissa >> 13);
+    const uint remainder = mantissa & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+        ++half; // may carry into the exponent, which correctly rounds up to the next power of two or infinity
+    return sign | half;
+}
+
+inline float f16tof32(uint value)
+{
+    const uint sign = (value & 0x8000u) << 16;
+    const uint exponent = (value >> 10) & 0x1fu;
+    const uint mantissa = value & 0x3ffu;
+
+    if (exponent == 0)
+    {
+        const float magnitude = float(mantissa) * (1.f / 16777216.f); // 2^-24
+        return (sign ? -magnitude : magnitude);
+    }
+
+    if (exponent == 31)
+        return asfloat(sign | 0x7f800000u | (mantissa << 13));
+
+    return asfloat(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+}
+
+// Vector types
+
+typedef rtxdi::host::vector<float, 2> float2;
+typedef rtxdi::host::vector<float, 3> float3;
+typedef rtxdi::host::vector<float, 4> float4;
+typedef rtxdi::host::vector<int, 2> int2;
+typedef rtxdi::host::vector<int, 3> int3;
+typedef rtxdi::host::vector<int, 4> int4;
+typedef rtxdi::host::vector<uint, 2> uint2;
+typedef rtxdi::host::vector<uint, 3> uint3;
+typedef rtxdi::host::vector<uint, 4> uint4;
+typedef rtxdi::host::vector<bool, 2> bool2;
+typedef rtxdi::host::vector<bool, 3> bool3;
+typedef rtxdi::host::vector<bool, 4> bool4;
+typedef rtxdi::host::matrix<float, 2, 2> float2x2;
+typedef rtxdi::host::matrix<float, 3, 3> float3x3;
+typedef rtxdi::host::matrix<float, 4, 4> float4x4;
+
+namespace rtxdi
+{
+namespace host
+{
+
+// Component-wise versions of the scalar intrinsics, found through argument-dependent lookup
+
+#define RTXDI_HOST_VECTOR_UNARY_FUNC(func, scalarFunc) \
+    template<typename T, int N> vector<T, N> func(const vector<T, N>& v) \
+    { vector<T, N> r; for (int i = 0; i < N; ++i) r.e[i] = T(scalarFunc(v.e[i])); return r; }
+
+RTXDI_HOST_VECTOR_UNARY_FUNC(abs, std::abs)
+RTXDI_HOST_VECTOR_UNARY_FUNC(floor, std::floor)
+RTXDI_HOST_VECTOR_UNARY_FUNC(ceil, std::ceil)
+RTXDI_HOST_VECTOR_UNARY_FUNC(round, std::round)
+RTXDI_HOST_VECTOR_UNARY_FUNC(trunc, std::trunc)
+RTXDI_HOST_VECTOR_UNARY_FUNC(sqrt, std::sqrt)
+RTXDI_HOST_VECTOR_UNARY_FUNC(exp, std::exp)
+RTXDI_HOST_VECTOR_UNARY_FUNC(exp2, std::exp2)
+RTXDI_HOST_VECTOR_UNARY_FUNC(log, std::log)
+RTXDI_HOST_VECTOR_UNARY_FUNC(log2, std::log2)
+RTXDI_HOST_VECTOR_UNARY_FUNC(sin, std::sin)
+RTXDI_HOST_VECTOR_UNARY_FUNC(cos, std::cos)
+RTXDI_HOST_VECTOR_UNARY_FUNC(frac, ::frac)
+RTXDI_HOST_VECTOR_UNARY_FUNC(rcp, ::rcp)
+RTXDI_HOST_VECTOR_UNARY_FUNC(rsqrt, ::rsqrt)
+RTXDI_HOST_VECTOR_UNARY_FUNC(saturate, ::saturate)
+RTXDI_HOST_VECTOR_UNARY_FUNC(sign, ::sign)
+#undef RTXDI_HOST_VECTOR_UNARY_FUNC
+
+template<int N> vector<uint, N> asuint(const vector<float, N>& v) { vector<uint, N> r; for (int i = 0; i < N; ++i) r.e[i] = ::asuint(v.e[i]); return r; }
+template<int N> vector<float, N> asfloat(const vector<uint, N>& v) { vector<float, N> r; for (int i = 0; i < N; ++i) r.e[i] = ::asfloat(v.e[i]); return r; }
+
+template<typename T, int N> vector<T, N> min(const vector<T, N>& a, const vector<T, N>& b) { vector<T, N> r; for (int i = 0; i < N; ++i) r.e[i] = ::min(a.e[i], b.e[i]); return r; }
+template<typename T, int N> vector<T, N> min(const vector<T, N>& a, typename identity<T>::type b) { return min(a, vector<T, N>(b)); }
+template<typename T, int N> vector<T, N> max(const vector<T, N>& a, const vector<T, N>& b) { vector<T, N> r; for (int i = 0; i < N; ++i) r.e[i] = ::max(a.e[i], b.e[i]); return r; }
+template<typename T, int N> vector<T, N> max(const vector<T, N>& a, typename identity<T>::type b) { return max(a, vector<T, N>(b)); }
+template<typename T, int N> vector<T, N> clamp(const vector<T, N>& x, const vector<T, N>& lo, const vector<T, N>& hi) { return min(max(x, lo), hi); }
+template<typename T, int N> vector<T, N> clamp(const vector<T, N>& x, typename identity<T>::type lo, typename identity<T>::type hi) { return min(max(x, lo), hi); }
+template<typename T, int N> vector<T, N> pow(const vector<T, N>& a, const vector<T, N>& b) { vector<T, N> r; for (int i = 0; i < N; ++i) r.e[i] = std::pow(a.e[i], b.e[i]); return r; }
+template<typename T, int N> vector<T, N> lerp(const vector<T, N>& a, const vector<T, N>& b, const vector<T, N>& t) { return a + (b - a) * t; }
+template<typename T, int N> vector<T, N> lerp(const vector<T, N>& a, const vector<T, N>& b, typename identity<T>::type t) { return a + (b - a) * t; }
+template<typename T, int N> vector<bool, N> isinf(const vector<T, N>& v) { vector<bool, N> r; for (int i = 0; i < N; ++i) r.e[i] = std::isinf(v.e[i]); return r; }
+template<typename T, int N> vector<bool, N> isnan(const vector<T, N>& v) { vector<bool, N> r; for (int i = 0; i < N; ++i) r.e[i] = std::isnan(v.e[i]); return r; }
+template<typename T, int N> bool any(const vector<T, N>& v) { for (int i = 0; i < N; ++i) if (v.e[i]) return true; return false; }
+template<typename T, int N> bool all(const vector<T, N>& v) { for (int i = 0; i < N; ++i) if (!v.e[i]) return false; return true; }
+template<typename T, int N> void sincos(const vector<T, N>& x, vector<T, N>& s, vector<T, N>& c) { for (int i = 0; i < N; ++i) ::sincos(x.e[i], s.e[i], c.e[i]); }
+
+template<typename T, int R, int C>
+vector<T, R> mul(const matrix<T, R, C>& m, const vector<T, C>& v)
+{
+    vector<T, R> r;
+    for (int i = 0; i < R; ++i)
+    {
+        r.e[i] = T(0);
+        for (int j = 0; j < C; ++j)
+            r.e[i] += m.rows[i].e[j] * v.e[j];
+    }
+    return r;
+}
+
+template<typename T, int R, int C>
+vector<T, C> mul(const vector<T, R>& v, const matrix<T, R, C>& m)
+{
+    vector<T, C> r;
+    for (int j = 0; j < C; ++j)
+    {
+        r.e[j] = T(0);
+        for (int i = 0; i < R; ++i)
+            r.e[j] += v.e[i] * m.rows[i].e[j];
+    }
+    return r;
+}
+
+template<typename T, int R, int K, int C>
+matrix<T, R, C> mul(const matrix<T, R, K>& a, const matrix<T, K, C>& b)
+{
+    matrix<T, R, C> r;
+    for (int i = 0; i < R; ++i)
+        for (int j = 0; j < C; ++j)
+        {
+            r.rows[i].e[j] = T(0);
+            for (int k = 0; k < K; ++k)
+                r.rows[i].e[j] += a.rows[i].e[k] * b.rows[k].e[j];
+        }
+    return r;
+}
+
+} // namespace host
+} // namespace rtxdi
+
+// Geometric functions are defined for the concrete float vector types so that swizzles convert implicitly
+
+#define RTXDI_HOST_GEOMETRIC_FUNCS(type, n) \
+    inline float dot(const type& a, const type& b) { float r = 0.f; for (int i = 0; i < n; ++i) r += a.e[i] * b.e[i]; return r; } \
+    inline float length(const type& v) { return std::sqrt(dot(v, v)); } \
+    inline float distance(const type& a, const type& b) { return length(a - b); } \
+    inline type normalize(const type& v) { return v / length(v); }
+
+RTXDI_HOST_GEOMETRIC_FUNCS(float2, 2)
+RTXDI_HOST_GEOMETRIC_FUNCS(float3, 3)
+RTXDI_HOST_GEOMETRIC_FUNCS(float4, 4)
+#undef RTXDI_HOST_GEOMETRIC_FUNCS
+
+inline float3 cross(const float3& a, const float3& b)
+{
+    return float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float3 reflect(const float3& i, const float3& n)
+{
+    return i - 2.f * dot(n, i) * n;
+}
+
+// Wave and thread group intrinsics, emulated for a wave of a single lane
+
+#define groupshared static thread_local
+
+inline void GroupMemoryBarrierWithGroupSync() { }
+inline uint WaveGetLaneCount() { return 1; }
+inline uint WaveGetLaneIndex() { return 0; }
+inline bool WaveIsFirstLane() { return true; }
+inline uint WaveActiveCountBits(bool value) { return value ? 1u : 0u; }
+inline bool WaveActiveAnyTrue(bool value) { return value; }
+inline bool WaveActiveAllTrue(bool value) { return value; }
+template<typename T> T WaveActiveSum(T value) { return value; }
+template<typename T> T WaveActiveMin(T value) { return value; }
+template<typename T> T WaveActiveMax(T value) { return value; }
+template<typename T> T WaveReadLaneFirst(T value) { return value; }
+template<typename T> T QuadReadLaneAt(T value, uint) { return value; }
+
+// Atomics. Host buffers that are written with Interlocked* functions, like RTXDI_COUNTER_BUFFER,
+// are arrays of std::atomic<uint> because passes run on several threads.
+inline void InterlockedAdd(std::atomic<uint>& dest, uint value) { dest.fetch_add(value, std::memory_order_relaxed); }
+inline void InterlockedAdd(std::atomic<uint>& dest, uint value, uint& originalValue) { originalValue = dest.fetch_add(value, std::memory_order_relaxed); }
+inline void InterlockedOr(std::atomic<uint>& dest, uint value, uint& originalValue) { originalValue = dest.fetch_or(value, std::memory_order_relaxed); }
+inline void InterlockedAnd(std::atomic<uint>& dest, uint value, uint& originalValue) { originalValue = dest.fetch_and(value, std::memory_order_relaxed); }
+inline void InterlockedCompareExchange(std::atomic<uint>& dest, uint compareValue, uint value, uint& originalValue)
+{
+    originalValue = compareValue;
+    dest.compare_exchange_strong(originalValue, value, std::memory_order_relaxed);
+}
+
+// Shader language macros from RtxdiTypes.h
+
+#ifndef RTXDI_TEX2D
+#define RTXDI_TEX2D const rtxdi::host::Texture2D&
+#endif
+#ifndef RTXDI_TEX2D_LOAD
+#define RTXDI_TEX2D_LOAD(t,pos,lod) (t).Load(int3(pos,lod))
+#endif
+#define RTXDI_DEFAULT(value) = value
+#define RTXDI_INOUT(type) type&
+#define RTXDI_OUT(type) type&
+#define RTXDI_INTERLOCKED_ADD(dest, value, originalValue) InterlockedAdd(dest, value, originalValue)
+#define RTXDI_UNUSED(x) (void)(x)
+
+#include "RtxdiParameters.h"
+#include "ReSTIRDIParameters.h"
+
+static const uint RTXDI_InvalidLightIndex = RTXDI_INVALID_LIGHT_INDEX;
+
+// The shaders compare the sampling mode enums against plain integers
+inline bool operator==(ReSTIRDI_LocalLightSamplingMode a, uint b) { return uint(a) == b; }
+inline bool operator!=(ReSTIRDI_LocalLightSamplingMode a, uint b) { return uint(a) != b; }
+inline bool operator==(uint a, ReSTIRDI_LocalLightSamplingMode b) { return a == uint(b); }
+inline bool operator!=(uint a, ReSTIRDI_LocalLightSamplingMode b) { return a != uint(b); }
+
+#endif // RTXDI_HOST_TYPES_H
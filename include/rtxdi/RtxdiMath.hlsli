@@ -78,7 +78,7 @@ uint RTXDI_JenkinsHash(uint a)
     return a;
 }
 
-void RTXDI_CartesianToSpherical(float3 cartesian, out float r, out float azimuth, out float elevation)
+void RTXDI_CartesianToSpherical(float3 cartesian, RTXDI_OUT(float) r, RTXDI_OUT(float) azimuth, RTXDI_OUT(float) elevation)
 {
     r = length(cartesian);
     cartesian /= r;
@@ -21,8 +21,31 @@
 #define RTXDI_LIGHT_INDEX_MASK 0x7fffffff
 
 // Reservoirs are stored in a structured buffer in a block-linear layout.
-// This constant defines the size of that block, measured in pixels.
+// This constant defines the default size of that block, measured in pixels.
+// The block size used by a buffer is stored in RTXDI_ReservoirBufferParameters.reservoirAddressing.
 #define RTXDI_RESERVOIR_BLOCK_SIZE 16
+#define RTXDI_RESERVOIR_BLOCK_SIZE_LOG2 4
+
+// Bit fields of RTXDI_ReservoirBufferParameters.reservoirAddressing:
+//   bits 0-7:  log2 of the block size, from 1 (2x2 blocks) up; 0 means RTXDI_RESERVOIR_BLOCK_SIZE
+//   bit 8:     reservoirs are in Z-order rather than row-major order within a block
+//   bits 9-10: log2 of the number of pixels covered by a reservoir along each axis (quarter-resolution GI reservoirs)
+// A zero value is the 16x16 row-major full-resolution layout, so parameters that fill the field with 0,
+// like code written when it was padding, keep the addressing they had.
+#define RTXDI_RESERVOIR_BLOCK_SIZE_LOG2_MASK 0xffu
+#define RTXDI_RESERVOIR_BLOCK_ZORDER_BIT 0x100u
+#define RTXDI_RESERVOIR_DOWNSCALE_LOG2_SHIFT 9
+#define RTXDI_RESERVOIR_DOWNSCALE_LOG2_MASK 0x3u
+
+// Variable-rate sampling: the per-tile rate map selects which pixels of each RTXDI_VARIABLE_RATE_TILE_SIZE^2 tile
+// take new initial samples in a frame, see RTXDI_IsVariableRatePixelActive and rtxdi::BuildVariableRateMap.
+// A rate map entry holds the sampling rate in its low bits and the frame phase that rotates the active pixels above them.
+#define RTXDI_VARIABLE_RATE_TILE_SIZE 8
+#define RTXDI_SAMPLING_RATE_FULL 0      // Every pixel
+#define RTXDI_SAMPLING_RATE_HALF 1      // One pixel of each 2, in a checkerboard
+#define RTXDI_SAMPLING_RATE_QUARTER 2   // One pixel of each 2x2 quad
+#define RTXDI_VARIABLE_RATE_MASK 0x3u
+#define RTXDI_VARIABLE_RATE_PHASE_SHIFT 2
 
 // Bias correction modes for temporal and spatial resampling:
 // Use (1/M) normalization, which is very biased but also very fast.
@@ -40,14 +63,48 @@
 #define ReSTIRDI_LocalLightSamplingMode_POWER_RIS 1
 // Use ReGIR based RIS to select local lights during initial sampling.
 #define ReSTIRDI_LocalLightSamplingMode_REGIR_RIS 2
+// Use power based RIS to select local lights, with the RIS buffer filled from an alias table instead of the PDF mipmap
+#define ReSTIRDI_LocalLightSamplingMode_ALIAS_RIS 3
 
 // This macro enables the functions that deal with the RIS buffer and presampling.
 #ifndef RTXDI_ENABLE_PRESAMPLING
 #define RTXDI_ENABLE_PRESAMPLING 1
 #endif
 
+// Selection of the spatial neighbor offsets, set with RTXDI_NEIGHBOR_SELECTION_MODE:
+// Each pixel starts at a random place in the neighbor offset buffer.
+#define RTXDI_NEIGHBOR_SELECTION_PER_PIXEL 0
+// All lanes of a wave use the start of the first active lane, and the offsets are rotated by a multiple of 90 degrees
+// per pixel of a 2x2 quad, so a wave fetches its neighbors from a few rotated copies of its own footprint.
+#define RTXDI_NEIGHBOR_SELECTION_PER_WAVE 1
+// Same as above, with the start shared by the lanes of a 2x2 quad. The quad lanes must map to 2x2 pixel quads,
+// as in compute shaders with 2D thread groups, which is not the case in ray generation shaders.
+#define RTXDI_NEIGHBOR_SELECTION_PER_QUAD 2
+
+#ifndef RTXDI_NEIGHBOR_SELECTION_MODE
+#define RTXDI_NEIGHBOR_SELECTION_MODE RTXDI_NEIGHBOR_SELECTION_PER_PIXEL
+#endif
+
+// Rotates the shared offsets per 2x2 quad instead of per pixel. The pixels of a quad then fetch a 2x2 quad of
+// neighbors, which touches slightly fewer cache lines in the per-wave mode, but their reuse is correlated.
+// In the per-quad mode, the per-pixel rotation scatters the fetches of a quad about as much as the per-pixel
+// selection does, and the per-quad rotation coalesces them by giving all pixels of a quad the same neighbors.
+#ifndef RTXDI_NEIGHBOR_ROTATION_PER_QUAD
+#define RTXDI_NEIGHBOR_ROTATION_PER_QUAD 0
+#endif
+
 #define RTXDI_INVALID_LIGHT_INDEX (0xffffffffu)
 
+// Instrumentation counters, accumulated by the resampling functions when RTXDI_ENABLE_COUNTERS is defined.
+// The counter buffer is an array of RTXDI_COUNTER_COUNT uints, indexed by these values.
+#define RTXDI_COUNTER_TEMPORAL_SEARCHES 0 // Temporal neighbor searches started
+#define RTXDI_COUNTER_TEMPORAL_SEARCH_FAILURES 1 // Temporal searches that found no matching surface
+#define RTXDI_COUNTER_DISOCCLUSION_BOOSTS 2 // Spatial passes that used numDisocclusionBoostSamples
+#define RTXDI_COUNTER_BOILING_FILTER_REJECTIONS 3 // Reservoirs discarded by the boiling filter
+#define RTXDI_COUNTER_BIAS_CORRECTION_RAYS 4 // Visibility rays traced for bias correction
+#define RTXDI_COUNTER_SPATIAL_SAMPLES 5 // Neighbors considered by spatial resampling
+#define RTXDI_COUNTER_COUNT 6
+
 #ifndef __cplusplus
 static const uint RTXDI_InvalidLightIndex = RTXDI_INVALID_LIGHT_INDEX;
 #endif
@@ -75,8 +132,10 @@ struct RTXDI_RuntimeParameters
 {
     uint32_t neighborOffsetMask; // Spatial
     uint32_t activeCheckerboardField; // 0 - no checkerboard, 1 - odd pixels, 2 - even pixels
-    uint32_t pad1;
-    uint32_t pad2;
+    // Temporal: previous frame render size / current render size, written by ReSTIRDIContext::getRuntimeParams
+    // and ReSTIRGIContext::fillRuntimeParams. 0 is read as 1, an unchanged render size.
+    float prevFrameScaleX;
+    float prevFrameScaleY;
 };
 
 struct RTXDI_LightBufferParameters
@@ -90,8 +149,8 @@ struct RTXDI_ReservoirBufferParameters
 {
     uint32_t reservoirBlockRowPitch;
     uint32_t reservoirArrayPitch;
-    uint32_t pad1;
-    uint32_t pad2;
+    uint32_t reservoirPlanePitch; // Distance between the planes of an array in the SoA layout, equal to reservoirArrayPitch otherwise
+    uint32_t reservoirAddressing; // See RTXDI_RESERVOIR_BLOCK_SIZE_LOG2_MASK and the following bit fields, 0 is the 16x16 row-major layout
 };
 
 struct RTXDI_PackedDIReservoir
@@ -104,4 +163,44 @@ struct RTXDI_PackedDIReservoir
     float weight;
 };
 
+// Define this macro to 1 to store DI reservoirs as RTXDI_CompactDIReservoir instead of RTXDI_PackedDIReservoir.
+// The compact format stores targetPdf and weight in half precision, the sample UV with 12 bits per channel,
+// M up to 255, visibility with 5 bits per channel, spatial distance up to 31 pixels and age up to 31 frames.
+#ifndef RTXDI_COMPACT_DI_RESERVOIR
+#define RTXDI_COMPACT_DI_RESERVOIR 0
+#endif
+
+struct RTXDI_CompactDIReservoir
+{
+    uint32_t lightData;
+    uint32_t targetPdfWeight;
+    uint32_t uvM;
+    uint32_t visibilityDistanceAge;
+};
+
+// Define these macros to 1 to store the reservoirs in a structure-of-arrays layout, where each group of fields
+// lives in its own plane of the buffer, reservoirPlanePitch elements apart. Passes that only need some fields
+// then fetch only the corresponding planes, see RTXDI_LoadDIReservoirFields and RTXDI_LoadGIReservoirFields.
+// DI planes are uint2: sample (lightData, uvData), weights (targetPdf, weight), reuse (mVisibility, distanceAge).
+// GI planes are uint4: sample (position, packed_normal), weights (packed_radiance, weight, packed_miscData_age_M, unused).
+#ifndef RTXDI_SOA_DI_RESERVOIR
+#define RTXDI_SOA_DI_RESERVOIR 0
+#endif
+
+#ifndef RTXDI_SOA_GI_RESERVOIR
+#define RTXDI_SOA_GI_RESERVOIR 0
+#endif
+
+#define RTXDI_DI_RESERVOIR_PLANE_COUNT 3
+#define RTXDI_GI_RESERVOIR_PLANE_COUNT 2
+
+// Entry of the light alias table built by rtxdi::LightAliasTable, see RTXDI_SampleAliasTable
+struct RTXDI_AliasTableEntry
+{
+    float threshold;    // Probability of selecting the light of this entry rather than its alias
+    uint32_t alias;
+    float pdf;          // Selection probability of the light of this entry
+    float aliasPdf;     // Selection probability of the alias
+};
+
 #endif // RTXDI_PARAMETERS_H
@@ -36,6 +36,12 @@
 #define WaveGetLaneCount() gl_SubgroupSize
 #define WaveActiveCountBits(x) subgroupBallotBitCount(uvec4(x,0,0,0))
 #define WaveIsFirstLane subgroupElect
+#define WaveReadLaneFirst subgroupBroadcastFirst
+#define QuadReadLaneAt subgroupQuadBroadcast
+#define InterlockedAdd(dest, value) atomicAdd(dest, value)
+#define InterlockedCompareExchange(dest, compareValue, value, originalValue) originalValue = atomicCompSwap(dest, compareValue, value)
+#define InterlockedOr(dest, value, originalValue) originalValue = atomicOr(dest, value)
+#define InterlockedAnd(dest, value, originalValue) originalValue = atomicAnd(dest, value)
 #define GroupMemoryBarrierWithGroupSync barrier
 #define f32tof16(f) packHalf2x16(vec2(f, 0))
 #define f16tof32(u) unpackHalf2x16(u).x
@@ -43,12 +49,22 @@
 #define RTXDI_TEX2D sampler2D
 #define RTXDI_TEX2D_LOAD(t,pos,lod) texelFetch(t,pos,lod)
 #define RTXDI_DEFAULT(value)
+#define RTXDI_INOUT(type) inout type
+#define RTXDI_OUT(type) out type
+// InterlockedAdd returning the original value, which the GLSL macro for InterlockedAdd can't overload
+#define RTXDI_INTERLOCKED_ADD(dest, value, originalValue) originalValue = atomicAdd(dest, value)
+// Marks a parameter that only some configurations read, for the host build that warns about unused parameters
+#define RTXDI_UNUSED(x)
 
 #else // RTXDI_GLSL
 
 #define RTXDI_TEX2D Texture2D
 #define RTXDI_TEX2D_LOAD(t,pos,lod) t.Load(int3(pos,lod))
 #define RTXDI_DEFAULT(value) = value
+#define RTXDI_INOUT(type) inout type
+#define RTXDI_OUT(type) out type
+#define RTXDI_INTERLOCKED_ADD(dest, value, originalValue) InterlockedAdd(dest, value, originalValue)
+#define RTXDI_UNUSED(x)
 
 #endif // RTXDI_GLSL
 
@@ -12,17 +12,102 @@ namespace rtxdi
 //     B W             W B
 //     W B             B W
 // BLACK and WHITE modes define cells with VALID data
+// VARIABLE_RATE keeps full resolution reservoirs and lets a per-tile rate map select the pixels
+// that take new initial samples, see BuildVariableRateMap.
 enum class CheckerboardMode : uint32_t
 {
     Off = 0,
     Black = 1,
-    White = 2
+    White = 2,
+    VariableRate = 3
 };
 
-RTXDI_ReservoirBufferParameters CalculateReservoirBufferParameters(uint32_t renderWidth, uint32_t renderHeight, CheckerboardMode checkerboardMode);
+// Per-tile sampling rates of CheckerboardMode::VariableRate
+enum class SamplingRate : uint32_t
+{
+    Full = RTXDI_SAMPLING_RATE_FULL,
+    Half = RTXDI_SAMPLING_RATE_HALF,
+    Quarter = RTXDI_SAMPLING_RATE_QUARTER
+};
+
+struct VariableRateMapParameters
+{
+    // Tiles whose largest pixel variance in the previous frame is below these thresholds
+    // take new initial samples at half or quarter rate. Use the same units as the variance image.
+    float halfRateVarianceThreshold = 0.01f;
+    float quarterRateVarianceThreshold = 0.001f;
+};
+
+// Storage formats of the DI reservoir buffer, selected in the shaders with RTXDI_COMPACT_DI_RESERVOIR
+enum class DIReservoirFormat : uint32_t
+{
+    Packed = 0,     // RTXDI_PackedDIReservoir, 24 bytes
+    Compact = 1     // RTXDI_CompactDIReservoir, 16 bytes
+};
+
+// Storage formats of the GI reservoir buffer, selected in the shaders with RTXDI_COMPACT_GI_RESERVOIR
+enum class GIReservoirFormat : uint32_t
+{
+    Packed = 0,     // RTXDI_PackedGIReservoir, 32 bytes
+    Compact = 1     // RTXDI_CompactGIReservoir, 20 bytes
+};
+
+// Layouts of the reservoir buffers, selected in the shaders with RTXDI_SOA_DI_RESERVOIR and RTXDI_SOA_GI_RESERVOIR
+enum class ReservoirLayout : uint32_t
+{
+    ArrayOfStructures = 0,  // One packed record per reservoir
+    StructureOfArrays = 1   // Each field group in its own plane, see RTXDI_DI_RESERVOIR_PLANE_COUNT and RTXDI_GI_RESERVOIR_PLANE_COUNT
+};
+
+// Order of the reservoirs within a block of the reservoir buffer
+enum class ReservoirBlockOrder : uint32_t
+{
+    RowMajor = 0,
+    ZOrder = 1      // Keeps the 2x2, 4x4, 8x8... quads of a block contiguous, see RTXDI_ZCurveToLinearIndex
+};
+
+// planeCount is 1 for the AoS layout, or the number of planes of a reservoir array in the SoA layout.
+// blockSize must be a power of two, 2 or larger. Each reservoir covers (1 << downscaleLog2) pixels along each axis,
+// downscaling can't be combined with checkerboard mode.
+RTXDI_ReservoirBufferParameters CalculateReservoirBufferParameters(uint32_t renderWidth, uint32_t renderHeight, CheckerboardMode checkerboardMode,
+    uint32_t planeCount = 1, uint32_t blockSize = RTXDI_RESERVOIR_BLOCK_SIZE, ReservoirBlockOrder blockOrder = ReservoirBlockOrder::RowMajor,
+    uint32_t downscaleLog2 = 0);
+
+// Block size of a reservoir buffer, in reservoirs along each axis
+uint32_t GetReservoirBlockSize(const RTXDI_ReservoirBufferParameters& params);
+
+uint32_t GetDIReservoirSizeInBytes(DIReservoirFormat format);
+
+// Size of a DI reservoir buffer with reservoirArrayCount arrays laid out with the given parameters
+uint64_t CalculateDIReservoirBufferSizeInBytes(const RTXDI_ReservoirBufferParameters& params, uint32_t reservoirArrayCount, DIReservoirFormat format);
+
+// Size of a buffer of multi-sample DI reservoirs (RTXDI_DIMultiReservoir) with reservoirArrayCount arrays,
+// where each array holds samplesPerReservoir regular reservoir arrays, see RTXDI_GetDIMultiReservoirArrayIndex
+uint64_t CalculateDIMultiReservoirBufferSizeInBytes(const RTXDI_ReservoirBufferParameters& params, uint32_t reservoirArrayCount,
+    uint32_t samplesPerReservoir, DIReservoirFormat format);
+
+uint32_t GetGIReservoirSizeInBytes(GIReservoirFormat format);
+
+// Size of a GI reservoir buffer with reservoirArrayCount arrays laid out with the given parameters
+uint64_t CalculateGIReservoirBufferSizeInBytes(const RTXDI_ReservoirBufferParameters& params, uint32_t reservoirArrayCount,
+    GIReservoirFormat format = GIReservoirFormat::Packed);
+
+// Reservoir buffers of the Black and White checkerboard modes only store the active half of the pixels
+bool IsHalfWidthCheckerboard(CheckerboardMode checkerboardMode);
+
+// Size of the rate map in tiles of RTXDI_VARIABLE_RATE_TILE_SIZE pixels
+void GetVariableRateMapSize(uint32_t renderWidth, uint32_t renderHeight, uint32_t& outWidthInTiles, uint32_t& outHeightInTiles);
+
+// Builds the rate map of CheckerboardMode::VariableRate, one uint32_t per tile in row-major order, from a row-major
+// image of per-pixel variance of the previous frame, such as the relative luminance variance estimated by the denoiser.
+// Pixels whose variance is unknown, e.g. disoccluded ones, should be set to infinity or NaN so their tile samples at full rate.
+// The entries include the phase of frameIndex, so the map must be rebuilt or re-phased every frame.
+void BuildVariableRateMap(const float* pixelVariance, uint32_t renderWidth, uint32_t renderHeight, uint32_t frameIndex,
+    const VariableRateMapParameters& params, uint32_t* outRateMap);
 
 void ComputePdfTextureSize(uint32_t maxItems, uint32_t& outWidth, uint32_t& outHeight, uint32_t& outMipLevels);
 
+// Writes neighborOffsetCount RG8_SNORM offsets of the R2 distribution, see GenerateNeighborOffsets for other distributions
 void FillNeighborOffsetBuffer(uint8_t* buffer, uint32_t neighborOffsetCount);
 
 // 32 bit Jenkins hash
@@ -12,11 +12,11 @@
 #define RTXDI_UNIFORM_SAMPLING
 
 void RTXDI_RandomlySelectLightUniformly(
-    inout RAB_RandomSamplerState rng,
+    RTXDI_INOUT(RAB_RandomSamplerState) rng,
     RTXDI_LightBufferRegion region,
-    out RAB_LightInfo lightInfo,
-    out uint lightIndex,
-    out float invSourcePdf)
+    RTXDI_OUT(RAB_LightInfo) lightInfo,
+    RTXDI_OUT(uint) lightIndex,
+    RTXDI_OUT(float) invSourcePdf)
 {
     float rnd = RAB_GetNextRandom(rng);
     invSourcePdf = float(region.numLights);
@@ -10,7 +10,10 @@
 
 #include "rtxdi/ImportanceSamplingContext.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 
 #include "rtxdi/RISBufferSegmentAllocator.h"
 #include "rtxdi/ReSTIRDI.h"
@@ -34,6 +37,33 @@ void debugCheckParameters(const rtxdi::RISBufferSegmentParameters& localLightRIS
     assert(IsNonzeroPowerOf2(environmentLightRISBufferParams.tileCount));
 }
 
+using rtxdi::ImportanceSamplingContext_ConstantBufferSection;
+
+struct ConstantBufferSectionRange
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+// Indexed by ImportanceSamplingContext_ConstantBufferSection
+const ConstantBufferSectionRange c_constantBufferSections[] = {
+    { offsetof(RTXDI_ImportanceSamplingParameters, lightBufferParams), sizeof(RTXDI_LightBufferParameters) },
+    { offsetof(RTXDI_ImportanceSamplingParameters, runtimeParams), sizeof(RTXDI_RuntimeParameters) },
+    { offsetof(RTXDI_ImportanceSamplingParameters, localLightsRISBufferSegmentParams), sizeof(RTXDI_RISBufferSegmentParameters) * 2 },
+    { offsetof(RTXDI_ImportanceSamplingParameters, restirDI), sizeof(ReSTIRDI_Parameters) },
+    { offsetof(RTXDI_ImportanceSamplingParameters, restirGI), sizeof(ReSTIRGI_Parameters) },
+    { offsetof(RTXDI_ImportanceSamplingParameters, regir), sizeof(ReGIR_Parameters) },
+};
+
+static_assert(sizeof(c_constantBufferSections) / sizeof(c_constantBufferSections[0]) == size_t(ImportanceSamplingContext_ConstantBufferSection::Count),
+    "Section table doesn't match ImportanceSamplingContext_ConstantBufferSection");
+static_assert(offsetof(RTXDI_ImportanceSamplingParameters, environmentLightRISBufferSegmentParams) ==
+    offsetof(RTXDI_ImportanceSamplingParameters, localLightsRISBufferSegmentParams) + sizeof(RTXDI_RISBufferSegmentParameters),
+    "RIS buffer segment parameters must be adjacent");
+static_assert(sizeof(RTXDI_LightBufferParameters) % 16 == 0 && sizeof(ReSTIRDI_Parameters) % 16 == 0 &&
+    sizeof(ReSTIRGI_Parameters) % 16 == 0 && sizeof(ReGIR_Parameters) % 16 == 0,
+    "Constant buffer sections must be multiples of 16 bytes");
+
 }
 
 namespace rtxdi
@@ -42,6 +72,7 @@ namespace rtxdi
 ImportanceSamplingContext::ImportanceSamplingContext(const ImportanceSamplingContext_StaticParameters& isParams)
 {
     debugCheckParameters(isParams.localLightRISBufferParams, isParams.environmentLightRISBufferParams);
+    assert(isParams.viewCount > 0);
 
     m_risBufferSegmentAllocator = std::make_unique<rtxdi::RISBufferSegmentAllocator>();
     m_localLightRISBufferSegmentParams.bufferOffset = m_risBufferSegmentAllocator->allocateSegment(isParams.localLightRISBufferParams.tileCount * isParams.localLightRISBufferParams.tileSize);
@@ -51,20 +82,46 @@ ImportanceSamplingContext::ImportanceSamplingContext(const ImportanceSamplingCon
     m_environmentLightRISBufferSegmentParams.tileCount = isParams.environmentLightRISBufferParams.tileCount;
     m_environmentLightRISBufferSegmentParams.tileSize = isParams.environmentLightRISBufferParams.tileSize;
     
-    ReSTIRDIStaticParameters restirDIStaticParams;
-    restirDIStaticParams.CheckerboardSamplingMode = isParams.CheckerboardSamplingMode;
-    restirDIStaticParams.NeighborOffsetCount = isParams.NeighborOffsetCount;
-    restirDIStaticParams.RenderWidth = isParams.renderWidth;
-    restirDIStaticParams.RenderHeight = isParams.renderHeight;
-    m_restirDIContext = std::make_unique<rtxdi::ReSTIRDIContext>(restirDIStaticParams);
-
     m_regirContext = std::make_unique<rtxdi::ReGIRContext>(isParams.regirStaticParams, *m_risBufferSegmentAllocator);
 
-    ReSTIRGIStaticParameters restirGIStaticParams;
-    restirGIStaticParams.CheckerboardSamplingMode = isParams.CheckerboardSamplingMode;
-    restirGIStaticParams.RenderWidth = isParams.renderWidth;
-    restirGIStaticParams.RenderHeight = isParams.renderHeight;
-    m_restirGIContext = std::make_unique<rtxdi::ReSTIRGIContext>(restirGIStaticParams);
+    for (uint32_t viewIndex = 0; viewIndex < isParams.viewCount; ++viewIndex)
+    {
+        ReSTIRDIStaticParameters restirDIStaticParams;
+        restirDIStaticParams.CheckerboardSamplingMode = isParams.CheckerboardSamplingMode;
+        restirDIStaticParams.NeighborOffsetCount = isParams.NeighborOffsetCount;
+        restirDIStaticParams.RenderWidth = isParams.renderWidth;
+        restirDIStaticParams.RenderHeight = isParams.renderHeight;
+        restirDIStaticParams.MaxRenderWidth = isParams.maxRenderWidth;
+        restirDIStaticParams.MaxRenderHeight = isParams.maxRenderHeight;
+        restirDIStaticParams.ReservoirArrayOffset = viewIndex * c_NumReSTIRDIReservoirBuffers;
+        restirDIStaticParams.ReservoirBufferLayout = isParams.DIReservoirLayout;
+        restirDIStaticParams.ReservoirBlockSize = isParams.reservoirBlockSize;
+        restirDIStaticParams.ReservoirBlockAddressing = isParams.reservoirBlockOrder;
+        m_restirDIContexts.push_back(std::make_unique<rtxdi::ReSTIRDIContext>(restirDIStaticParams));
+
+        ReSTIRGIStaticParameters restirGIStaticParams;
+        restirGIStaticParams.CheckerboardSamplingMode = isParams.CheckerboardSamplingMode;
+        restirGIStaticParams.RenderWidth = isParams.renderWidth;
+        restirGIStaticParams.RenderHeight = isParams.renderHeight;
+        restirGIStaticParams.MaxRenderWidth = isParams.maxRenderWidth;
+        restirGIStaticParams.MaxRenderHeight = isParams.maxRenderHeight;
+        restirGIStaticParams.ReservoirArrayOffset = viewIndex * c_NumReSTIRGIReservoirBuffers;
+        restirGIStaticParams.ReservoirBufferLayout = isParams.GIReservoirLayout;
+        restirGIStaticParams.ReservoirBlockSize = isParams.reservoirBlockSize;
+        restirGIStaticParams.ReservoirBlockAddressing = isParams.reservoirBlockOrder;
+        restirGIStaticParams.ReservoirResolution = isParams.GIReservoirResolution;
+        m_restirGIContexts.push_back(std::make_unique<rtxdi::ReSTIRGIContext>(restirGIStaticParams));
+    }
+
+    m_lightBufferParams = {};
+
+    m_constantBufferPackStates.resize(isParams.viewCount);
+    for (ConstantBufferPackState& packState : m_constantBufferPackStates)
+    {
+        memset(&packState.packedConstants, 0, sizeof(packState.packedConstants));
+        std::fill(std::begin(packState.generations), std::end(packState.generations), 0);
+        packState.valid = false;
+    }
 }
 
 ImportanceSamplingContext::~ImportanceSamplingContext()
@@ -72,14 +129,14 @@ ImportanceSamplingContext::~ImportanceSamplingContext()
 
 }
 
-ReSTIRDIContext& ImportanceSamplingContext::getReSTIRDIContext()
+ReSTIRDIContext& ImportanceSamplingContext::getReSTIRDIContext(uint32_t viewIndex)
 {
-    return *m_restirDIContext;
+    return *m_restirDIContexts[viewIndex];
 }
 
-const ReSTIRDIContext& ImportanceSamplingContext::getReSTIRDIContext() const
+const ReSTIRDIContext& ImportanceSamplingContext::getReSTIRDIContext(uint32_t viewIndex) const
 {
-    return *m_restirDIContext;
+    return *m_restirDIContexts[viewIndex];
 }
 
 ReGIRContext& ImportanceSamplingContext::getReGIRContext()
@@ -92,14 +149,29 @@ const ReGIRContext& ImportanceSamplingContext::getReGIRContext() const
     return *m_regirContext;
 }
 
-ReSTIRGIContext& ImportanceSamplingContext::getReSTIRGIContext()
+ReSTIRGIContext& ImportanceSamplingContext::getReSTIRGIContext(uint32_t viewIndex)
+{
+    return *m_restirGIContexts[viewIndex];
+}
+
+const ReSTIRGIContext& ImportanceSamplingContext::getReSTIRGIContext(uint32_t viewIndex) const
+{
+    return *m_restirGIContexts[viewIndex];
+}
+
+uint32_t ImportanceSamplingContext::getViewCount() const
+{
+    return uint32_t(m_restirDIContexts.size());
+}
+
+uint32_t ImportanceSamplingContext::getReSTIRDIReservoirArrayCount() const
 {
-    return *m_restirGIContext;
+    return getViewCount() * c_NumReSTIRDIReservoirBuffers;
 }
 
-const ReSTIRGIContext& ImportanceSamplingContext::getReSTIRGIContext() const
+uint32_t ImportanceSamplingContext::getReSTIRGIReservoirArrayCount() const
 {
-    return *m_restirGIContext;
+    return getViewCount() * c_NumReSTIRGIReservoirBuffers;
 }
 
 const RISBufferSegmentAllocator& ImportanceSamplingContext::getRISBufferSegmentAllocator() const
@@ -124,19 +196,32 @@ const RTXDI_RISBufferSegmentParameters& ImportanceSamplingContext::getEnvironmen
 
 uint32_t ImportanceSamplingContext::getNeighborOffsetCount() const
 {
-    return m_restirDIContext->getStaticParameters().NeighborOffsetCount;
+    return m_restirDIContexts[0]->getStaticParameters().NeighborOffsetCount;
 }
 
+// The shared presampling passes are needed if any view uses them
 bool ImportanceSamplingContext::isLocalLightPowerRISEnabled() const
 {
-    bool enabled = false;
-    ReSTIRDI_InitialSamplingParameters iss = m_restirDIContext->getInitialSamplingParameters();
-    if (iss.localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode::Power_RIS)
-        return true;
-    if (iss.localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode::ReGIR_RIS)
+    for (const auto& restirDIContext : m_restirDIContexts)
     {
-        if( (m_regirContext->getReGIRDynamicParameters().presamplingMode == LocalLightReGIRPresamplingMode::Power_RIS) ||
-            (m_regirContext->getReGIRDynamicParameters().fallbackSamplingMode == LocalLightReGIRFallbackSamplingMode::Power_RIS))
+        ReSTIRDI_InitialSamplingParameters iss = restirDIContext->getInitialSamplingParameters();
+        if (iss.localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode::Power_RIS)
+            return true;
+        if (iss.localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode::ReGIR_RIS)
+        {
+            if( (m_regirContext->getReGIRDynamicParameters().presamplingMode == LocalLightReGIRPresamplingMode::Power_RIS) ||
+                (m_regirContext->getReGIRDynamicParameters().fallbackSamplingMode == LocalLightReGIRFallbackSamplingMode::Power_RIS))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool ImportanceSamplingContext::isLocalLightAliasRISEnabled() const
+{
+    for (const auto& restirDIContext : m_restirDIContexts)
+    {
+        if (restirDIContext->getInitialSamplingParameters().localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode::Alias_RIS)
             return true;
     }
     return false;
@@ -144,7 +229,12 @@ bool ImportanceSamplingContext::isLocalLightPowerRISEnabled() const
 
 bool ImportanceSamplingContext::isReGIREnabled() const
 {
-    return (m_restirDIContext->getInitialSamplingParameters().localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode::ReGIR_RIS);
+    for (const auto& restirDIContext : m_restirDIContexts)
+    {
+        if (restirDIContext->getInitialSamplingParameters().localLightSamplingMode == ReSTIRDI_LocalLightSamplingMode::ReGIR_RIS)
+            return true;
+    }
+    return false;
 }
 
 void ImportanceSamplingContext::setLightBufferParams(const RTXDI_LightBufferParameters& lightBufferParams)
@@ -152,4 +242,156 @@ void ImportanceSamplingContext::setLightBufferParams(const RTXDI_LightBufferPara
     m_lightBufferParams = lightBufferParams;
 }
 
-}
\ No newline at end of file
+bool ImportanceSamplingContext::setLocalLightRISBufferParams(const RISBufferSegmentParameters& localLightRISBufferParams)
+{
+    const uint32_t previousSize = m_risBufferSegmentAllocator->getTotalSizeInElements();
+    reallocateRISBufferSegment(m_localLightRISBufferSegmentParams, localLightRISBufferParams);
+    return m_risBufferSegmentAllocator->getTotalSizeInElements() <= previousSize;
+}
+
+bool ImportanceSamplingContext::setEnvironmentLightRISBufferParams(const RISBufferSegmentParameters& environmentLightRISBufferParams)
+{
+    const uint32_t previousSize = m_risBufferSegmentAllocator->getTotalSizeInElements();
+    reallocateRISBufferSegment(m_environmentLightRISBufferSegmentParams, environmentLightRISBufferParams);
+    return m_risBufferSegmentAllocator->getTotalSizeInElements() <= previousSize;
+}
+
+bool ImportanceSamplingContext::setReGIRStaticParameters(const ReGIRStaticParameters& regirStaticParams)
+{
+    const uint32_t previousSize = m_risBufferSegmentAllocator->getTotalSizeInElements();
+    m_regirContext->setStaticParameters(regirStaticParams, *m_risBufferSegmentAllocator);
+    return m_risBufferSegmentAllocator->getTotalSizeInElements() <= previousSize;
+}
+
+void ImportanceSamplingContext::compactRISBuffer(std::vector<RISBufferSegmentMove>& moves)
+{
+    // Only the moves of this call apply to the current offsets
+    const size_t firstMove = moves.size();
+    m_risBufferSegmentAllocator->compact(moves);
+    const std::vector<RISBufferSegmentMove> newMoves(moves.begin() + firstMove, moves.end());
+
+    m_localLightRISBufferSegmentParams.bufferOffset = GetMovedRISBufferSegmentOffset(newMoves, m_localLightRISBufferSegmentParams.bufferOffset);
+    m_environmentLightRISBufferSegmentParams.bufferOffset = GetMovedRISBufferSegmentOffset(newMoves, m_environmentLightRISBufferSegmentParams.bufferOffset);
+    m_regirContext->applyRISBufferSegmentMoves(newMoves);
+}
+
+void ImportanceSamplingContext::reallocateRISBufferSegment(RTXDI_RISBufferSegmentParameters& segmentParams, const RISBufferSegmentParameters& params)
+{
+    debugCheckParameters(params, params);
+
+    m_risBufferSegmentAllocator->releaseSegment(segmentParams.bufferOffset);
+    segmentParams.bufferOffset = m_risBufferSegmentAllocator->allocateSegment(params.tileCount * params.tileSize);
+    segmentParams.tileCount = params.tileCount;
+    segmentParams.tileSize = params.tileSize;
+}
+
+bool ImportanceSamplingContext::resize(uint32_t renderWidth, uint32_t renderHeight)
+{
+    bool fitsBuffers = true;
+    for (const auto& restirDIContext : m_restirDIContexts)
+        fitsBuffers = restirDIContext->resize(renderWidth, renderHeight) && fitsBuffers;
+    for (const auto& restirGIContext : m_restirGIContexts)
+        fitsBuffers = restirGIContext->resize(renderWidth, renderHeight) && fitsBuffers;
+    return fitsBuffers;
+}
+
+uint32_t ImportanceSamplingContext::packConstantBuffer(void* destination, bool writeAllSections, uint32_t viewIndex)
+{
+    assert((reinterpret_cast<uintptr_t>(destination) & 15) == 0);
+    assert(viewIndex < getViewCount());
+
+    ConstantBufferPackState& packState = m_constantBufferPackStates[viewIndex];
+
+    RTXDI_ImportanceSamplingParameters params;
+    memset(&params, 0, sizeof(params));
+
+    uint32_t writtenSections = 0;
+    for (uint32_t sectionIndex = 0; sectionIndex < uint32_t(ImportanceSamplingContext_ConstantBufferSection::Count); ++sectionIndex)
+    {
+        const auto section = ImportanceSamplingContext_ConstantBufferSection(sectionIndex);
+        const ConstantBufferSectionRange& range = c_constantBufferSections[sectionIndex];
+
+        fillConstantBufferSection(section, viewIndex, params);
+
+        const uint8_t* newData = reinterpret_cast<const uint8_t*>(&params) + range.offset;
+        uint8_t* packedData = reinterpret_cast<uint8_t*>(&packState.packedConstants) + range.offset;
+
+        const bool changed = !packState.valid || memcmp(newData, packedData, range.size) != 0;
+        if (changed)
+        {
+            memcpy(packedData, newData, range.size);
+            ++packState.generations[sectionIndex];
+        }
+
+        if (changed || writeAllSections)
+        {
+            memcpy(static_cast<uint8_t*>(destination) + range.offset, newData, range.size);
+            writtenSections |= 1u << sectionIndex;
+        }
+    }
+
+    packState.valid = true;
+    return writtenSections;
+}
+
+uint64_t ImportanceSamplingContext::getConstantBufferSectionGeneration(ImportanceSamplingContext_ConstantBufferSection section, uint32_t viewIndex) const
+{
+    return m_constantBufferPackStates[viewIndex].generations[uint32_t(section)];
+}
+
+uint32_t ImportanceSamplingContext::getConstantBufferSize()
+{
+    return uint32_t(sizeof(RTXDI_ImportanceSamplingParameters));
+}
+
+uint32_t ImportanceSamplingContext::getConstantBufferSectionOffset(ImportanceSamplingContext_ConstantBufferSection section)
+{
+    return c_constantBufferSections[uint32_t(section)].offset;
+}
+
+uint32_t ImportanceSamplingContext::getConstantBufferSectionSize(ImportanceSamplingContext_ConstantBufferSection section)
+{
+    return c_constantBufferSections[uint32_t(section)].size;
+}
+
+void ImportanceSamplingContext::fillConstantBufferSection(ImportanceSamplingContext_ConstantBufferSection section, uint32_t viewIndex, RTXDI_ImportanceSamplingParameters& params) const
+{
+    const ReSTIRDIContext& restirDIContext = *m_restirDIContexts[viewIndex];
+    const ReSTIRGIContext& restirGIContext = *m_restirGIContexts[viewIndex];
+
+    switch (section)
+    {
+    case ImportanceSamplingContext_ConstantBufferSection::LightBuffer:
+        params.lightBufferParams = m_lightBufferParams;
+        break;
+    case ImportanceSamplingContext_ConstantBufferSection::RuntimeParams:
+        params.runtimeParams = restirDIContext.getRuntimeParams();
+        break;
+    case ImportanceSamplingContext_ConstantBufferSection::RISBufferSegments:
+        params.localLightsRISBufferSegmentParams = m_localLightRISBufferSegmentParams;
+        params.environmentLightRISBufferSegmentParams = m_environmentLightRISBufferSegmentParams;
+        break;
+    case ImportanceSamplingContext_ConstantBufferSection::ReSTIRDI:
+        params.restirDI.reservoirBufferParams = restirDIContext.getReservoirBufferParameters();
+        params.restirDI.bufferIndices = restirDIContext.getBufferIndices();
+        params.restirDI.initialSamplingParams = restirDIContext.getInitialSamplingParameters();
+        params.restirDI.temporalResamplingParams = restirDIContext.getTemporalResamplingParameters();
+        params.restirDI.spatialResamplingParams = restirDIContext.getSpatialResamplingParameters();
+        params.restirDI.shadingParams = restirDIContext.getShadingParameters();
+        break;
+    case ImportanceSamplingContext_ConstantBufferSection::ReSTIRGI:
+        params.restirGI.reservoirBufferParams = restirGIContext.getReservoirBufferParameters();
+        params.restirGI.bufferIndices = restirGIContext.getBufferIndices();
+        params.restirGI.temporalResamplingParams = restirGIContext.getTemporalResamplingParameters();
+        params.restirGI.spatialResamplingParams = restirGIContext.getSpatialResamplingParameters();
+        params.restirGI.finalShadingParams = restirGIContext.getFinalShadingParameters();
+        break;
+    case ImportanceSamplingContext_ConstantBufferSection::ReGIR:
+        m_regirContext->fillReGIRParameters(params.regir);
+        break;
+    default:
+        break;
+    }
+}
+
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include <rtxdi/LightAliasTable.h>
+
+#include <algorithm>
+
+namespace rtxdi
+{
+
+LightAliasTable::LightAliasTable() :
+    m_totalPower(0.0)
+{
+}
+
+void LightAliasTable::build(const float* lightPower, uint32_t lightCount)
+{
+    m_entries.resize(lightCount);
+    m_scaledProbabilities.resize(lightCount);
+    m_small.clear();
+    m_large.clear();
+
+    m_totalPower = 0.0;
+    for (uint32_t i = 0; i < lightCount; ++i)
+    {
+        const float power = lightPower[i];
+        m_totalPower += (power > 0.f) ? double(power) : 0.0;
+    }
+
+    if (m_totalPower <= 0.0)
+    {
+        // Nothing to sample: every entry selects itself with zero probability, which produces empty RIS samples
+        for (uint32_t i = 0; i < lightCount; ++i)
+            m_entries[i] = { 1.f, i, 0.f, 0.f };
+        return;
+    }
+
+    // Vose's method: scale probabilities so that the average is 1,
+    // then pair each under-full entry with an over-full one that donates its remainder
+    for (uint32_t i = 0; i < lightCount; ++i)
+    {
+        const float power = lightPower[i];
+        const double p = (power > 0.f) ? double(power) / m_totalPower : 0.0;
+        m_entries[i].pdf = float(p);
+        m_scaledProbabilities[i] = p * lightCount;
+
+        if (m_scaledProbabilities[i] < 1.0)
+            m_small.push_back(i);
+        else
+            m_large.push_back(i);
+    }
+
+    while (!m_small.empty() && !m_large.empty())
+    {
+        const uint32_t small = m_small.back();
+        m_small.pop_back();
+        const uint32_t large = m_large.back();
+
+        m_entries[small].threshold = float(m_scaledProbabilities[small]);
+        m_entries[small].alias = large;
+
+        m_scaledProbabilities[large] -= 1.0 - m_scaledProbabilities[small];
+        if (m_scaledProbabilities[large] < 1.0)
+        {
+            m_large.pop_back();
+            m_small.push_back(large);
+        }
+    }
+
+    // Leftovers are 1 up to rounding errors
+    for (uint32_t i : m_large)
+    {
+        m_entries[i].threshold = 1.f;
+        m_entries[i].alias = i;
+    }
+    for (uint32_t i : m_small)
+    {
+        m_entries[i].threshold = 1.f;
+        m_entries[i].alias = i;
+    }
+
+    for (RTXDI_AliasTableEntry& entry : m_entries)
+        entry.aliasPdf = m_entries[entry.alias].pdf;
+}
+
+uint32_t LightAliasTable::sample(float random0, float random1, float& pdf) const
+{
+    const uint32_t size = getSize();
+    if (size == 0)
+    {
+        pdf = 0.f;
+        return RTXDI_INVALID_LIGHT_INDEX;
+    }
+
+    const uint32_t entryIndex = std::min(uint32_t(random0 * float(size)), size - 1);
+    const RTXDI_AliasTableEntry& entry = m_entries[entryIndex];
+
+    if (random1 < entry.threshold)
+    {
+        pdf = entry.pdf;
+        return entryIndex;
+    }
+
+    pdf = entry.aliasPdf;
+    return entry.alias;
+}
+
+const RTXDI_AliasTableEntry* LightAliasTable::getEntries() const
+{
+    return m_entries.data();
+}
+
+uint32_t LightAliasTable::getSize() const
+{
+    return uint32_t(m_entries.size());
+}
+
+double LightAliasTable::getTotalPower() const
+{
+    return m_totalPower;
+}
+
+}
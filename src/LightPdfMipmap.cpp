@@ -0,0 +1,256 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include <rtxdi/LightPdfMipmap.h>
+#include <rtxdi/RtxdiUtils.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RTXDI_PDF_MIPMAP_SSE 1
+#include <emmintrin.h>
+#else
+#define RTXDI_PDF_MIPMAP_SSE 0
+#endif
+
+namespace rtxdi
+{
+
+namespace
+{
+
+// Same as RTXDI_IntegerCompact in RtxdiMath.hlsli
+uint32_t IntegerCompact(uint32_t x)
+{
+    x = (x & 0x11111111) | ((x & 0x44444444) >> 1);
+    x = (x & 0x03030303) | ((x & 0x30303030) >> 2);
+    x = (x & 0x000F000F) | ((x & 0x0F000F00) >> 4);
+    x = (x & 0x000000FF) | ((x & 0x00FF0000) >> 8);
+    return x;
+}
+
+// Mip 0 texel of a light, inverse of RTXDI_ZCurveToLinearIndex
+void LightIndexToTexel(uint32_t lightIndex, uint32_t& x, uint32_t& y)
+{
+    x = IntegerCompact(lightIndex);
+    y = IntegerCompact(lightIndex >> 1);
+}
+
+float SanitizePower(float power)
+{
+    // Negative and NaN weights would break the sums in the coarser mips
+    return (power > 0.f) ? power : 0.f;
+}
+
+// Sums 2x2 texel quads of two source rows into one destination row.
+// srcRow1 is null when the source mip is a single row, which happens for non-square textures.
+void ReduceRow(const float* srcRow0, const float* srcRow1, float* dstRow, uint32_t dstWidth, uint32_t srcWidth)
+{
+    uint32_t x = 0;
+
+    if (srcWidth == 1)
+    {
+        dstRow[0] = srcRow0[0] + (srcRow1 ? srcRow1[0] : 0.f);
+        return;
+    }
+
+#if RTXDI_PDF_MIPMAP_SSE
+    // 8 source texels per row -> 4 destination texels
+    for (; x + 4 <= dstWidth; x += 4)
+    {
+        __m128 a = _mm_loadu_ps(srcRow0 + x * 2);
+        __m128 b = _mm_loadu_ps(srcRow0 + x * 2 + 4);
+        if (srcRow1)
+        {
+            a = _mm_add_ps(a, _mm_loadu_ps(srcRow1 + x * 2));
+            b = _mm_add_ps(b, _mm_loadu_ps(srcRow1 + x * 2 + 4));
+        }
+        const __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(dstRow + x, _mm_add_ps(even, odd));
+    }
+#endif
+
+    for (; x < dstWidth; ++x)
+    {
+        float sum = srcRow0[x * 2] + srcRow0[x * 2 + 1];
+        if (srcRow1)
+            sum += srcRow1[x * 2] + srcRow1[x * 2 + 1];
+        dstRow[x] = sum;
+    }
+}
+
+}
+
+LightPdfMipmap::LightPdfMipmap(uint32_t maxLights) :
+    m_maxLights(maxLights)
+{
+    ComputePdfTextureSize(maxLights, m_width, m_height, m_mipLevels);
+
+    size_t totalTexels = 0;
+    for (uint32_t mip = 0; mip < m_mipLevels; ++mip)
+        totalTexels += size_t(getMipWidth(mip)) * getMipHeight(mip);
+
+    m_data.resize(totalTexels, 0.f);
+    m_mipPointers.resize(m_mipLevels);
+
+    size_t offset = 0;
+    for (uint32_t mip = 0; mip < m_mipLevels; ++mip)
+    {
+        m_mipPointers[mip] = m_data.data() + offset;
+        offset += size_t(getMipWidth(mip)) * getMipHeight(mip);
+    }
+}
+
+void LightPdfMipmap::build(const float* lightPower, uint32_t lightCount)
+{
+    assert(lightCount <= m_maxLights);
+    lightCount = std::min(lightCount, m_maxLights);
+
+    float* mip0 = m_mipPointers[0];
+    std::memset(mip0, 0, sizeof(float) * m_width * m_height);
+
+    for (uint32_t lightIndex = 0; lightIndex < lightCount; ++lightIndex)
+    {
+        uint32_t x, y;
+        LightIndexToTexel(lightIndex, x, y);
+        mip0[y * m_width + x] = SanitizePower(lightPower[lightIndex]);
+    }
+
+    for (uint32_t mip = 1; mip < m_mipLevels; ++mip)
+        reduceMip(mip);
+}
+
+void LightPdfMipmap::update(const uint32_t* lightIndices, const float* lightPower, uint32_t count)
+{
+    if (count == 0)
+        return;
+
+    // Dirty texels of the current mip level, as row-major indices
+    m_dirtyTexels.clear();
+    m_dirtyTexels.reserve(count);
+
+    float* mip0 = m_mipPointers[0];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        assert(lightIndices[i] < m_maxLights);
+        if (lightIndices[i] >= m_maxLights)
+            continue;
+
+        uint32_t x, y;
+        LightIndexToTexel(lightIndices[i], x, y);
+        mip0[y * m_width + x] = SanitizePower(lightPower[i]);
+        m_dirtyTexels.push_back(y * m_width + x);
+    }
+
+    for (uint32_t mip = 1; mip < m_mipLevels && !m_dirtyTexels.empty(); ++mip)
+    {
+        const uint32_t srcWidth = getMipWidth(mip - 1);
+        const uint32_t dstWidth = getMipWidth(mip);
+        const uint32_t dstHeight = getMipHeight(mip);
+
+        // Once the dirty set covers a large part of the level, a full reduction is cheaper than sorting
+        if (m_dirtyTexels.size() * 4 >= size_t(dstWidth) * dstHeight)
+        {
+            for (; mip < m_mipLevels; ++mip)
+                reduceMip(mip);
+            break;
+        }
+
+        for (uint32_t& texel : m_dirtyTexels)
+        {
+            const uint32_t x = (texel % srcWidth) >> 1;
+            const uint32_t y = (texel / srcWidth) >> 1;
+            texel = y * dstWidth + x;
+        }
+
+        std::sort(m_dirtyTexels.begin(), m_dirtyTexels.end());
+        m_dirtyTexels.erase(std::unique(m_dirtyTexels.begin(), m_dirtyTexels.end()), m_dirtyTexels.end());
+
+        for (uint32_t texel : m_dirtyTexels)
+            reduceTexel(mip, texel % dstWidth, texel / dstWidth);
+    }
+}
+
+void LightPdfMipmap::reduceMip(uint32_t mipLevel)
+{
+    const float* src = m_mipPointers[mipLevel - 1];
+    float* dst = m_mipPointers[mipLevel];
+    const uint32_t srcWidth = getMipWidth(mipLevel - 1);
+    const uint32_t srcHeight = getMipHeight(mipLevel - 1);
+    const uint32_t dstWidth = getMipWidth(mipLevel);
+    const uint32_t dstHeight = getMipHeight(mipLevel);
+
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        const float* srcRow0 = src + size_t(y * 2) * srcWidth;
+        const float* srcRow1 = (y * 2 + 1 < srcHeight) ? srcRow0 + srcWidth : nullptr;
+        ReduceRow(srcRow0, srcRow1, dst + size_t(y) * dstWidth, dstWidth, srcWidth);
+    }
+}
+
+void LightPdfMipmap::reduceTexel(uint32_t mipLevel, uint32_t x, uint32_t y)
+{
+    const float* src = m_mipPointers[mipLevel - 1];
+    const uint32_t srcWidth = getMipWidth(mipLevel - 1);
+    const uint32_t srcHeight = getMipHeight(mipLevel - 1);
+
+    float sum = 0.f;
+    for (uint32_t sy = y * 2; sy < std::min(y * 2 + 2, srcHeight); ++sy)
+        for (uint32_t sx = x * 2; sx < std::min(x * 2 + 2, srcWidth); ++sx)
+            sum += src[size_t(sy) * srcWidth + sx];
+
+    m_mipPointers[mipLevel][size_t(y) * getMipWidth(mipLevel) + x] = sum;
+}
+
+uint32_t LightPdfMipmap::getMaxLights() const
+{
+    return m_maxLights;
+}
+
+uint32_t LightPdfMipmap::getWidth() const
+{
+    return m_width;
+}
+
+uint32_t LightPdfMipmap::getHeight() const
+{
+    return m_height;
+}
+
+uint32_t LightPdfMipmap::getMipLevels() const
+{
+    return m_mipLevels;
+}
+
+uint32_t LightPdfMipmap::getMipWidth(uint32_t mipLevel) const
+{
+    return std::max(m_width >> mipLevel, 1u);
+}
+
+uint32_t LightPdfMipmap::getMipHeight(uint32_t mipLevel) const
+{
+    return std::max(m_height >> mipLevel, 1u);
+}
+
+const float* LightPdfMipmap::getMipData(uint32_t mipLevel) const
+{
+    assert(mipLevel < m_mipLevels);
+    return m_mipPointers[mipLevel];
+}
+
+const float* const* LightPdfMipmap::getMipDataPointers() const
+{
+    return m_mipPointers.data();
+}
+
+}
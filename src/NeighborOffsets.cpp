@@ -0,0 +1,304 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include <rtxdi/NeighborOffsets.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+
+const float c_pi = 3.14159265358979f;
+const float c_goldenRatioFraction = 0.61803398875f;
+
+// Number of candidates tried for each point of a best-candidate set
+const uint32_t c_bestCandidateTries = 16;
+
+struct Offset
+{
+    float x;
+    float y;
+};
+
+bool isPowerOfTwo(uint32_t x)
+{
+    return x > 0 && (x & (x - 1)) == 0;
+}
+
+// PCG random number generator, much cheaper than std::mt19937 for the millions of candidates of large buffers
+class Random
+{
+public:
+    explicit Random(uint32_t seed) : m_state(seed * 747796405u + 2891336453u) { }
+
+    float nextFloat()
+    {
+        m_state = m_state * 747796405u + 2891336453u;
+        uint32_t word = ((m_state >> ((m_state >> 28u) + 4u)) ^ m_state) * 277803737u;
+        word = (word >> 22u) ^ word;
+        return float(word >> 8) * (1.f / 16777216.f);
+    }
+
+private:
+    uint32_t m_state;
+};
+
+// Rejection sampling, cheaper than the polar mapping since it needs 1.27 tries on average and no trigonometry
+Offset randomPointInDisc(Random& rng)
+{
+    while (true)
+    {
+        const Offset p = { rng.nextFloat() * 2.f - 1.f, rng.nextFloat() * 2.f - 1.f };
+        if (p.x * p.x + p.y * p.y <= 1.f)
+            return p;
+    }
+}
+
+Offset rotate(Offset p, float angle)
+{
+    const float c = cosf(angle);
+    const float s = sinf(angle);
+    return { p.x * c - p.y * s, p.x * s + p.y * c };
+}
+
+uint32_t reverseBits(uint32_t value, uint32_t bitCount)
+{
+    uint32_t result = 0;
+    for (uint32_t bit = 0; bit < bitCount; ++bit)
+        result |= ((value >> bit) & 1) << (bitCount - 1 - bit);
+    return result;
+}
+
+// The R2 sequence with rejection of the points outside the disc, as historically written by FillNeighborOffsetBuffer
+void generateR2(Offset* offsets, uint32_t count)
+{
+    const float phi2 = 1.0f / 1.3247179572447f;
+    float u = 0.5f;
+    float v = 0.5f;
+    uint32_t num = 0;
+    while (num < count)
+    {
+        u += phi2;
+        v += phi2 * phi2;
+        if (u >= 1.0f) u -= 1.0f;
+        if (v >= 1.0f) v -= 1.0f;
+
+        float rSq = (u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f);
+        if (rSq > 0.25f)
+            continue;
+
+        offsets[num++] = { (u - 0.5f) * 2.f, (v - 0.5f) * 2.f };
+    }
+}
+
+// Mitchell's best-candidate sampling: each new point is the candidate farthest from the previous windowSize - 1 points,
+// so every run of consecutive points up to windowSize long is spread like a Poisson disc set.
+void generateBestCandidates(Offset* offsets, uint32_t count, uint32_t windowSize, Random& rng)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t first = (i >= windowSize) ? i - windowSize + 1 : 0;
+
+        Offset best = randomPointInDisc(rng);
+        float bestDistanceSq = -1.f;
+
+        for (uint32_t candidateIndex = 0; i > 0 && candidateIndex < c_bestCandidateTries; ++candidateIndex)
+        {
+            const Offset candidate = (candidateIndex == 0) ? best : randomPointInDisc(rng);
+
+            float distanceSq = std::numeric_limits<float>::max();
+            for (uint32_t j = first; j < i; ++j)
+            {
+                const float dx = candidate.x - offsets[j].x;
+                const float dy = candidate.y - offsets[j].y;
+                distanceSq = std::min(distanceSq, dx * dx + dy * dy);
+
+                // This candidate can't beat the best one anymore
+                if (distanceSq <= bestDistanceSq)
+                    break;
+            }
+
+            if (distanceSq > bestDistanceSq)
+            {
+                best = candidate;
+                bestDistanceSq = distanceSq;
+            }
+        }
+
+        offsets[i] = best;
+    }
+}
+
+void generateStratifiedRings(Offset* offsets, uint32_t count, uint32_t setSize, Random& rng)
+{
+    uint32_t setSizeLog2 = 0;
+    while ((1u << setSizeLog2) < setSize)
+        ++setSizeLog2;
+
+    for (uint32_t setStart = 0; setStart < count; setStart += setSize)
+    {
+        const float setRotation = rng.nextFloat();
+        for (uint32_t i = 0; i < setSize; ++i)
+        {
+            // Ring j covers the radii of an equal area slice of the disc
+            const uint32_t ring = reverseBits(i, setSizeLog2);
+            const float r = sqrtf((float(ring) + rng.nextFloat()) / float(setSize));
+            const float angle = 2.f * c_pi * (float(ring) * c_goldenRatioFraction + setRotation);
+            offsets[setStart + i] = { r * cosf(angle), r * sinf(angle) };
+        }
+    }
+}
+
+// Maps the unit disc onto the annulus between the radii, preserving the area density
+Offset mapToAnnulus(Offset p, float innerRadius, float outerRadius)
+{
+    const float rSq = p.x * p.x + p.y * p.y;
+    if (rSq <= 0.f)
+        return { innerRadius, 0.f };
+
+    const float r = sqrtf(rSq);
+    const float mappedRadius = sqrtf(innerRadius * innerRadius + rSq * (outerRadius * outerRadius - innerRadius * innerRadius));
+    return { p.x * mappedRadius / r, p.y * mappedRadius / r };
+}
+
+template<typename T>
+void quantize(const std::vector<Offset>& offsets, float scale, void* buffer)
+{
+    T* output = static_cast<T*>(buffer);
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        output[i * 2 + 0] = T(offsets[i].x * scale);
+        output[i * 2 + 1] = T(offsets[i].y * scale);
+    }
+}
+
+}
+
+namespace rtxdi
+{
+
+bool NeighborOffsetParameters::operator==(const NeighborOffsetParameters& other) const
+{
+    return count == other.count
+        && distribution == other.distribution
+        && format == other.format
+        && innerRadius == other.innerRadius
+        && outerRadius == other.outerRadius
+        && setSize == other.setSize
+        && seed == other.seed;
+}
+
+uint32_t GetNeighborOffsetSizeInBytes(NeighborOffsetFormat format)
+{
+    switch (format)
+    {
+    case NeighborOffsetFormat::RG16_SNORM:
+        return 4;
+    case NeighborOffsetFormat::RG32_FLOAT:
+        return 8;
+    default:
+        return 2;
+    }
+}
+
+uint64_t GetNeighborOffsetBufferSizeInBytes(const NeighborOffsetParameters& params)
+{
+    return uint64_t(params.count) * GetNeighborOffsetSizeInBytes(params.format);
+}
+
+void GenerateNeighborOffsets(const NeighborOffsetParameters& params, void* buffer)
+{
+    assert(isPowerOfTwo(params.count));
+    assert(isPowerOfTwo(params.setSize) && params.setSize <= params.count);
+    assert(params.innerRadius >= 0.f && params.innerRadius <= params.outerRadius && params.outerRadius <= 1.f);
+
+    std::vector<Offset> offsets(params.count);
+    Random rng(params.seed);
+
+    switch (params.distribution)
+    {
+    case NeighborOffsetDistribution::PoissonDisc:
+        generateBestCandidates(offsets.data(), params.count, params.setSize, rng);
+        break;
+
+    case NeighborOffsetDistribution::BlueNoiseRotated:
+        generateBestCandidates(offsets.data(), params.setSize, params.setSize, rng);
+        for (uint32_t setStart = params.setSize; setStart < params.count; setStart += params.setSize)
+        {
+            // Golden ratio steps keep the angles of any run of consecutive sets far apart
+            const float angle = 2.f * c_pi * float(setStart / params.setSize) * c_goldenRatioFraction;
+            for (uint32_t i = 0; i < params.setSize; ++i)
+                offsets[setStart + i] = rotate(offsets[i], angle);
+        }
+        break;
+
+    case NeighborOffsetDistribution::StratifiedRings:
+        generateStratifiedRings(offsets.data(), params.count, params.setSize, rng);
+        break;
+
+    default:
+        generateR2(offsets.data(), params.count);
+        break;
+    }
+
+    if (params.innerRadius != 0.f || params.outerRadius != 1.f)
+    {
+        for (Offset& offset : offsets)
+            offset = mapToAnnulus(offset, params.innerRadius, params.outerRadius);
+    }
+
+    switch (params.format)
+    {
+    case NeighborOffsetFormat::RG16_SNORM:
+        quantize<int16_t>(offsets, 32767.f, buffer);
+        break;
+    case NeighborOffsetFormat::RG32_FLOAT:
+        memcpy(buffer, offsets.data(), offsets.size() * sizeof(Offset));
+        break;
+    default:
+        // Keeps the historical scale of FillNeighborOffsetBuffer, slightly inside the unit disc
+        quantize<int8_t>(offsets, 125.f, buffer);
+        break;
+    }
+}
+
+std::shared_ptr<const std::vector<uint8_t>> NeighborOffsetCache::get(const NeighborOffsetParameters& params)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.params == params)
+            return entry.contents;
+    }
+
+    auto contents = std::make_shared<std::vector<uint8_t>>(size_t(GetNeighborOffsetBufferSizeInBytes(params)));
+    GenerateNeighborOffsets(params, contents->data());
+    m_entries.push_back({ params, contents });
+    return contents;
+}
+
+void NeighborOffsetCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+uint32_t NeighborOffsetCache::getEntryCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return uint32_t(m_entries.size());
+}
+
+}
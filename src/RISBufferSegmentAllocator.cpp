@@ -10,20 +10,136 @@
 
 #include "rtxdi/RISBufferSegmentAllocator.h"
 
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+
+bool IsNonzeroPowerOf2(uint32_t i)
+{
+    return ((i & (i - 1)) == 0) && (i > 0);
+}
+
+uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
 namespace rtxdi
 {
 
-RISBufferSegmentAllocator::RISBufferSegmentAllocator() :
-    m_totalSizeInElements(0)
+uint32_t GetMovedRISBufferSegmentOffset(const std::vector<RISBufferSegmentMove>& moves, uint32_t offset)
 {
+    // compact() reports the moves in ascending source offset order
+    auto it = std::lower_bound(moves.begin(), moves.end(), offset,
+        [](const RISBufferSegmentMove& move, uint32_t value) { return move.srcOffset < value; });
+    return (it != moves.end() && it->srcOffset == offset) ? it->dstOffset : offset;
+}
 
+RISBufferSegmentAllocator::RISBufferSegmentAllocator(uint32_t defaultAlignmentInElements) :
+    m_defaultAlignmentInElements(defaultAlignmentInElements),
+    m_totalSizeInElements(0),
+    m_highWaterMarkInElements(0)
+{
+    assert(IsNonzeroPowerOf2(defaultAlignmentInElements));
 }
 
 uint32_t RISBufferSegmentAllocator::allocateSegment(uint32_t sizeInElements)
 {
-    uint32_t prevSize = m_totalSizeInElements;
-    m_totalSizeInElements += sizeInElements;
-    return prevSize;
+    return allocateSegment(sizeInElements, m_defaultAlignmentInElements);
+}
+
+uint32_t RISBufferSegmentAllocator::allocateSegment(uint32_t sizeInElements, uint32_t alignmentInElements)
+{
+    assert(IsNonzeroPowerOf2(alignmentInElements));
+
+    if (sizeInElements == 0)
+        return AlignUp(m_totalSizeInElements, alignmentInElements);
+
+    uint32_t offset = 0;
+    bool placed = false;
+
+    // First fit in the free ranges
+    for (size_t rangeIndex = 0; rangeIndex < m_freeRanges.size(); ++rangeIndex)
+    {
+        const FreeRange range = m_freeRanges[rangeIndex];
+        const uint32_t alignedOffset = AlignUp(range.offset, alignmentInElements);
+        const uint32_t padding = alignedOffset - range.offset;
+        if (padding + sizeInElements > range.sizeInElements)
+            continue;
+
+        offset = alignedOffset;
+        placed = true;
+
+        const uint32_t tailOffset = alignedOffset + sizeInElements;
+        const uint32_t tailSize = range.offset + range.sizeInElements - tailOffset;
+        m_freeRanges.erase(m_freeRanges.begin() + rangeIndex);
+        if (tailSize > 0)
+            m_freeRanges.insert(m_freeRanges.begin() + rangeIndex, FreeRange{ tailOffset, tailSize });
+        if (padding > 0)
+            m_freeRanges.insert(m_freeRanges.begin() + rangeIndex, FreeRange{ range.offset, padding });
+        break;
+    }
+
+    if (!placed)
+    {
+        offset = AlignUp(m_totalSizeInElements, alignmentInElements);
+        if (offset > m_totalSizeInElements)
+            addFreeRange(m_totalSizeInElements, offset - m_totalSizeInElements);
+        m_totalSizeInElements = offset + sizeInElements;
+        m_highWaterMarkInElements = std::max(m_highWaterMarkInElements, m_totalSizeInElements);
+    }
+
+    const Segment segment{ offset, sizeInElements, alignmentInElements };
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), offset,
+        [](uint32_t value, const Segment& s) { return value < s.offset; });
+    m_segments.insert(it, segment);
+
+    return offset;
+}
+
+void RISBufferSegmentAllocator::releaseSegment(uint32_t offset)
+{
+    auto it = std::lower_bound(m_segments.begin(), m_segments.end(), offset,
+        [](const Segment& s, uint32_t value) { return s.offset < value; });
+    assert(it != m_segments.end() && it->offset == offset);
+    if (it == m_segments.end() || it->offset != offset)
+        return;
+
+    const uint32_t sizeInElements = it->sizeInElements;
+    m_segments.erase(it);
+
+    addFreeRange(offset, sizeInElements);
+    trimEnd();
+}
+
+void RISBufferSegmentAllocator::compact(std::vector<RISBufferSegmentMove>& moves)
+{
+    uint32_t end = 0;
+    for (Segment& segment : m_segments)
+    {
+        const uint32_t newOffset = AlignUp(end, segment.alignmentInElements);
+        if (newOffset != segment.offset)
+            moves.push_back(RISBufferSegmentMove{ segment.offset, newOffset, segment.sizeInElements });
+
+        segment.offset = newOffset;
+        end = newOffset + segment.sizeInElements;
+    }
+
+    // Rebuild the alignment padding between the compacted segments
+    m_freeRanges.clear();
+    uint32_t prevEnd = 0;
+    for (const Segment& segment : m_segments)
+    {
+        if (segment.offset > prevEnd)
+            m_freeRanges.push_back(FreeRange{ prevEnd, segment.offset - prevEnd });
+        prevEnd = segment.offset + segment.sizeInElements;
+    }
+
+    m_totalSizeInElements = end;
 }
 
 uint32_t RISBufferSegmentAllocator::getTotalSizeInElements() const
@@ -31,4 +147,63 @@ uint32_t RISBufferSegmentAllocator::getTotalSizeInElements() const
     return m_totalSizeInElements;
 }
 
-}
\ No newline at end of file
+uint32_t RISBufferSegmentAllocator::getHighWaterMarkInElements() const
+{
+    return m_highWaterMarkInElements;
+}
+
+RISBufferSegmentAllocatorStatistics RISBufferSegmentAllocator::getStatistics() const
+{
+    RISBufferSegmentAllocatorStatistics stats;
+    stats.segmentCount = uint32_t(m_segments.size());
+    stats.freeRangeCount = uint32_t(m_freeRanges.size());
+    for (const Segment& segment : m_segments)
+        stats.allocatedElements += segment.sizeInElements;
+    for (const FreeRange& range : m_freeRanges)
+        stats.freeElements += range.sizeInElements;
+    stats.totalSizeInElements = m_totalSizeInElements;
+    stats.highWaterMarkInElements = m_highWaterMarkInElements;
+    return stats;
+}
+
+void RISBufferSegmentAllocator::addFreeRange(uint32_t offset, uint32_t sizeInElements)
+{
+    auto it = std::upper_bound(m_freeRanges.begin(), m_freeRanges.end(), offset,
+        [](uint32_t value, const FreeRange& r) { return value < r.offset; });
+    it = m_freeRanges.insert(it, FreeRange{ offset, sizeInElements });
+
+    // Coalesce with the next range
+    auto next = it + 1;
+    if (next != m_freeRanges.end() && it->offset + it->sizeInElements == next->offset)
+    {
+        it->sizeInElements += next->sizeInElements;
+        m_freeRanges.erase(next);
+    }
+
+    // Coalesce with the previous range
+    if (it != m_freeRanges.begin())
+    {
+        auto prev = it - 1;
+        if (prev->offset + prev->sizeInElements == it->offset)
+        {
+            prev->sizeInElements += it->sizeInElements;
+            m_freeRanges.erase(it);
+        }
+    }
+}
+
+void RISBufferSegmentAllocator::trimEnd()
+{
+    // A free range that reaches the end of the buffer is returned to the unallocated tail
+    if (!m_freeRanges.empty())
+    {
+        const FreeRange& last = m_freeRanges.back();
+        if (last.offset + last.sizeInElements == m_totalSizeInElements)
+        {
+            m_totalSizeInElements = last.offset;
+            m_freeRanges.pop_back();
+        }
+    }
+}
+
+}
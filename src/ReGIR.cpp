@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <numeric>
 
 #include "rtxdi/RtxdiParameters.h"
@@ -21,6 +22,56 @@
 namespace
 {
     constexpr float c_pi = 3.1415926535f;
+
+    // Same as RTXDI_JenkinsHash in RtxdiMath.hlsli
+    uint32_t JenkinsHash(uint32_t a)
+    {
+        a = (a + 0x7ed55d16) + (a << 12);
+        a = (a ^ 0xc761c23c) ^ (a >> 19);
+        a = (a + 0x165667b1) + (a << 5);
+        a = (a + 0xd3a2646c) ^ (a << 9);
+        a = (a + 0xfd7046c5) + (a << 3);
+        a = (a ^ 0xb55a4f09) ^ (a >> 16);
+        return a;
+    }
+
+    // Same as RTXDI_ReGIR_GetHashedCellKey in ReGIRSampling.hlsli
+    bool GetHashedCellKey(const ReGIR_Parameters& params, const rtxdi::float3& worldPos, uint32_t& key)
+    {
+        const float center[3] = { params.commonParams.centerX, params.commonParams.centerY, params.commonParams.centerZ };
+        const float position[3] = { worldPos.x, worldPos.y, worldPos.z };
+
+        float distanceSquared = 0.f;
+        for (int axis = 0; axis < 3; axis++)
+            distanceSquared += (position[axis] - center[axis]) * (position[axis] - center[axis]);
+        const float distanceToCenter = sqrtf(distanceSquared) / (params.hashedParams.levelDistance * params.commonParams.cellSize);
+
+        uint32_t level = 0;
+        if (distanceToCenter > 1.f)
+            level = std::min(uint32_t(floorf(log2f(distanceToCenter))) + 1, uint32_t(RTXDI_REGIR_HASHED_MAX_LEVELS - 1));
+
+        const float cellSize = params.commonParams.cellSize * float(1u << level);
+        const int maxOffsets[3] = { 511, 255, 511 };
+        int cell[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            cell[axis] = int(floorf(position[axis] / cellSize));
+            const int offset = cell[axis] - int(floorf(center[axis] / cellSize));
+            if (std::abs(offset) > maxOffsets[axis])
+                return false;
+        }
+
+        key = ((level + 1) << 29) | ((uint32_t(cell[1]) & 0x1ff) << 20) | ((uint32_t(cell[2]) & 0x3ff) << 10) | (uint32_t(cell[0]) & 0x3ff);
+        return true;
+    }
+
+    uint32_t NextPowerOfTwo(uint32_t x)
+    {
+        uint32_t result = 1;
+        while (result < x)
+            result <<= 1;
+        return result;
+    }
 }
 
 namespace rtxdi
@@ -31,9 +82,39 @@ namespace rtxdi
         m_regirStaticParameters(params)
     {
         ComputeGridLightSlotCount();
+        ComputeHashedLightSlotCount();
+        ComputeClipmapLightSlotCount();
+        InitializeOnion(params);
+        ComputeOnionJitterCurve();
+        ComputeOnionGPUParameters();
+        AllocateRISBufferSegment(risBufferSegmentAllocator);
+    }
+
+    void ReGIRContext::setStaticParameters(const ReGIRStaticParameters& params, RISBufferSegmentAllocator& risBufferSegmentAllocator)
+    {
+        ReleaseRISBufferSegment(risBufferSegmentAllocator);
+
+        m_regirStaticParameters = params;
+        m_regirOnionCalculatedParameters = ReGIROnionCalculatedParameters();
+        ComputeGridLightSlotCount();
+        ComputeHashedLightSlotCount();
+        ComputeClipmapLightSlotCount();
         InitializeOnion(params);
         ComputeOnionJitterCurve();
+        ComputeOnionGPUParameters();
         AllocateRISBufferSegment(risBufferSegmentAllocator);
+
+        // The slots of the new segment hold no lights, or lights of another owner
+        m_fullRebuildRequested = true;
+    }
+
+    void ReGIRContext::applyRISBufferSegmentMoves(const std::vector<RISBufferSegmentMove>& moves)
+    {
+        if (getReGIRLightSlotCount() == 0)
+            return;
+
+        m_regirCellOffset = GetMovedRISBufferSegmentOffset(moves, m_regirCellOffset);
+        ComputeClipmapLevelOffsets();
     }
 
     void ReGIRContext::ComputeGridLightSlotCount()
@@ -44,6 +125,31 @@ namespace rtxdi
             * m_regirStaticParameters.LightsPerCell;
     }
 
+    void ReGIRContext::ComputeHashedLightSlotCount()
+    {
+        const ReGIRHashedStaticParameters& hashedParameters = m_regirStaticParameters.hashedParameters;
+        assert(hashedParameters.HashTableCapacity > 0 && hashedParameters.HashTableCapacity <= 0x80000000u);
+        assert(hashedParameters.MaxProbes > 0);
+
+        m_regirHashedCalculatedParameters.hashTableCapacity = NextPowerOfTwo(std::max(hashedParameters.HashTableCapacity, 1u));
+        m_regirHashedCalculatedParameters.lightSlotCount = m_regirHashedCalculatedParameters.hashTableCapacity
+            * m_regirStaticParameters.LightsPerCell;
+    }
+
+    void ReGIRContext::ComputeClipmapLightSlotCount()
+    {
+        const ReGIRClipmapStaticParameters& clipmapParameters = m_regirStaticParameters.clipmapParameters;
+        assert(clipmapParameters.LevelCount >= 1 && clipmapParameters.LevelCount <= RTXDI_REGIR_CLIPMAP_MAX_LEVELS);
+
+        m_regirClipmapCalculatedParameters.levelCount = std::min(std::max(clipmapParameters.LevelCount, 1u), uint32_t(RTXDI_REGIR_CLIPMAP_MAX_LEVELS));
+        m_regirClipmapCalculatedParameters.cellsPerLevel = clipmapParameters.GridSize.x
+            * clipmapParameters.GridSize.y
+            * clipmapParameters.GridSize.z;
+        m_regirClipmapCalculatedParameters.lightSlotCount = m_regirClipmapCalculatedParameters.cellsPerLevel
+            * m_regirClipmapCalculatedParameters.levelCount
+            * m_regirStaticParameters.LightsPerCell;
+    }
+
     void ReGIRContext::AllocateRISBufferSegment(RISBufferSegmentAllocator& risBufferSegmentAllocator)
     {
         switch (m_regirStaticParameters.Mode)
@@ -57,6 +163,38 @@ namespace rtxdi
             break;
         case ReGIRMode::Onion:
             m_regirCellOffset = risBufferSegmentAllocator.allocateSegment(m_regirOnionCalculatedParameters.lightSlotCount);
+            break;
+        case ReGIRMode::Hashed:
+            m_regirCellOffset = risBufferSegmentAllocator.allocateSegment(m_regirHashedCalculatedParameters.lightSlotCount);
+            break;
+        case ReGIRMode::Clipmap:
+            // One segment for all levels, so that the cell indices of the levels are consecutive like in the other modes
+            m_regirCellOffset = risBufferSegmentAllocator.allocateSegment(m_regirClipmapCalculatedParameters.lightSlotCount);
+            break;
+        }
+
+        ComputeClipmapLevelOffsets();
+    }
+
+    void ReGIRContext::ReleaseRISBufferSegment(RISBufferSegmentAllocator& risBufferSegmentAllocator)
+    {
+        // Zero-size segments are not tracked by the allocator
+        if (getReGIRLightSlotCount() > 0)
+            risBufferSegmentAllocator.releaseSegment(m_regirCellOffset);
+        m_regirCellOffset = 0;
+    }
+
+    void ReGIRContext::ComputeClipmapLevelOffsets()
+    {
+        std::vector<uint32_t>& levelOffsets = m_regirClipmapCalculatedParameters.levelRISBufferOffsets;
+        levelOffsets.clear();
+        if (m_regirStaticParameters.Mode != ReGIRMode::Clipmap)
+            return;
+
+        for (uint32_t level = 0; level < m_regirClipmapCalculatedParameters.levelCount; level++)
+        {
+            levelOffsets.push_back(m_regirCellOffset
+                + level * m_regirClipmapCalculatedParameters.cellsPerLevel * m_regirStaticParameters.LightsPerCell);
         }
     }
 
@@ -120,6 +258,8 @@ namespace rtxdi
 
         m_regirOnionCalculatedParameters.regirOnionCells = totalCells;
         m_regirOnionCalculatedParameters.lightSlotCount = m_regirOnionCalculatedParameters.regirOnionCells * m_regirStaticParameters.LightsPerCell;
+
+        ComputeOnionCellTable();
     }
 
     static float3 SphericalToCartesian(const float radius, const float azimuth, const float elevation)
@@ -137,6 +277,62 @@ namespace rtxdi
         return sqrtf(d.x * d.x + d.y * d.y + d.z * d.z);
     }
 
+    // Walks the cells in index order with the same math as the analytic RTXDI_ReGIR_CellIndexToWorldPos
+    void ReGIRContext::ComputeOnionCellTable()
+    {
+        auto& cellTable = m_regirOnionCalculatedParameters.regirOnionCellTable;
+        cellTable.clear();
+        cellTable.reserve(m_regirOnionCalculatedParameters.regirOnionCells);
+
+        const auto& layers = m_regirOnionCalculatedParameters.regirOnionLayers;
+        const auto& rings = m_regirOnionCalculatedParameters.regirOnionRings;
+
+        cellTable.push_back({ float3{ 0.f, 0.f, 0.f }, layers.empty() ? 0.f : layers[0].innerRadius });
+
+        for (const auto& layerGroup : layers)
+        {
+            for (int layerIndex = 0; layerIndex < layerGroup.layerCount; layerIndex++)
+            {
+                const float layerInnerRadius = layerGroup.innerRadius * powf(layerGroup.layerScale, float(layerIndex));
+                const float layerOuterRadius = layerInnerRadius * layerGroup.layerScale;
+                const float r = (layerInnerRadius + layerOuterRadius) * 0.5f;
+
+                for (int ringIndex = 0; ringIndex < layerGroup.ringCount; ringIndex++)
+                {
+                    const auto& ring = rings[layerGroup.ringOffset + ringIndex];
+
+                    // Rings above the equator have a mirror ring below it, which follows in the cell order
+                    for (int hemisphere = 0; hemisphere < (ringIndex > 0 ? 2 : 1); hemisphere++)
+                    {
+                        for (int cellIndex = 0; cellIndex < ring.cellCount; cellIndex++)
+                        {
+                            float elevation = float(ringIndex) * layerGroup.equatorialCellAngle;
+                            if (hemisphere != 0)
+                                elevation = -elevation;
+
+                            float azimuth = (float(cellIndex) + 0.5f) * ring.cellAngle;
+                            if ((layerIndex & 1) != 0)
+                                azimuth += ring.cellAngle * 0.5f;
+                            azimuth -= c_pi;
+
+                            const float3 cellCenter = SphericalToCartesian(r, azimuth, elevation);
+
+                            const float cornerAzimuth = azimuth + ring.cellAngle * 0.5f;
+                            const float cornerElevation = (elevation == 0.f)
+                                ? layerGroup.equatorialCellAngle * 0.5f
+                                : (fabsf(elevation) - layerGroup.equatorialCellAngle * 0.5f) * (elevation > 0.f ? 1.f : -1.f);
+                            const float3 cellCorner = SphericalToCartesian(layerOuterRadius, cornerAzimuth, cornerElevation);
+
+                            cellTable.push_back({ cellCenter, Distance(cellCorner, cellCenter) });
+                        }
+                    }
+                }
+            }
+        }
+
+        assert(cellTable.size() == m_regirOnionCalculatedParameters.regirOnionCells);
+    }
+
     void ReGIRContext::ComputeOnionJitterCurve()
     {
         std::vector<float> cubicRootFactors;
@@ -208,17 +404,52 @@ namespace rtxdi
         float sumOfLinearFactors = std::accumulate(linearFactors.begin(), linearFactors.end(), 0.f);
         m_regirOnionCalculatedParameters.regirOnionLinearFactor = sumOfLinearFactors / std::max(float(linearFactors.size()), 1.f);
     }
-  
+
+    void ReGIRContext::ComputeOnionGPUParameters()
+    {
+        m_regirOnionParameters = {};
+
+        const auto& layers = m_regirOnionCalculatedParameters.regirOnionLayers;
+        const auto& rings = m_regirOnionCalculatedParameters.regirOnionRings;
+        assert(layers.size() <= RTXDI_ONION_MAX_LAYER_GROUPS);
+        assert(rings.size() <= RTXDI_ONION_MAX_RINGS);
+
+        const size_t numLayerGroups = std::min(layers.size(), size_t(RTXDI_ONION_MAX_LAYER_GROUPS));
+        const size_t numRings = std::min(rings.size(), size_t(RTXDI_ONION_MAX_RINGS));
+        std::copy(layers.begin(), layers.begin() + numLayerGroups, m_regirOnionParameters.layers);
+        std::copy(rings.begin(), rings.begin() + numRings, m_regirOnionParameters.rings);
+
+        m_regirOnionParameters.numLayerGroups = uint32_t(numLayerGroups);
+        m_regirOnionParameters.cubicRootFactor = m_regirOnionCalculatedParameters.regirOnionCubicRootFactor;
+        m_regirOnionParameters.linearFactor = m_regirOnionCalculatedParameters.regirOnionLinearFactor;
+        m_regirOnionParameters.numCells = m_regirOnionCalculatedParameters.regirOnionCells;
+    }
+
     ReGIRGridCalculatedParameters rtxdi::ReGIRContext::getReGIRGridCalculatedParameters() const
     {
         return m_regirGridCalculatedParameters;
     }
 
-    ReGIROnionCalculatedParameters rtxdi::ReGIRContext::getReGIROnionCalculatedParameters() const
+    const ReGIROnionCalculatedParameters& rtxdi::ReGIRContext::getReGIROnionCalculatedParameters() const
     {
         return m_regirOnionCalculatedParameters;
     }
 
+    ReGIRHashedCalculatedParameters ReGIRContext::getReGIRHashedCalculatedParameters() const
+    {
+        return m_regirHashedCalculatedParameters;
+    }
+
+    const ReGIRClipmapCalculatedParameters& ReGIRContext::getReGIRClipmapCalculatedParameters() const
+    {
+        return m_regirClipmapCalculatedParameters;
+    }
+
+    const ReGIR_OnionParameters& ReGIRContext::getReGIROnionParameters() const
+    {
+        return m_regirOnionParameters;
+    }
+
     uint32_t rtxdi::ReGIRContext::getReGIRCellOffset() const
     {
         return m_regirCellOffset;
@@ -234,6 +465,12 @@ namespace rtxdi
         case ReGIRMode::Onion:
             return m_regirOnionCalculatedParameters.lightSlotCount;
             break;
+        case ReGIRMode::Hashed:
+            return m_regirHashedCalculatedParameters.lightSlotCount;
+            break;
+        case ReGIRMode::Clipmap:
+            return m_regirClipmapCalculatedParameters.lightSlotCount;
+            break;
         default:
         case ReGIRMode::Disabled:
             return 0;
@@ -241,6 +478,42 @@ namespace rtxdi
         }
     }
 
+    uint32_t ReGIRContext::getReGIRCellCount() const
+    {
+        return getReGIRLightSlotCount() / std::max(m_regirStaticParameters.LightsPerCell, 1u);
+    }
+
+    ReGIRActiveCellBufferParameters ReGIRContext::getReGIRActiveCellBufferParameters() const
+    {
+        const uint32_t cellCount = getReGIRCellCount();
+
+        ReGIRActiveCellBufferParameters params;
+        params.occupancyOffset = RTXDI_REGIR_ACTIVE_CELL_OCCUPANCY_OFFSET;
+        params.occupancyElementCount = (cellCount + 31) / 32;
+        params.activeCellListOffset = params.occupancyOffset + params.occupancyElementCount;
+        params.maxActiveCells = std::min(cellCount, uint32_t(RTXDI_REGIR_MAX_ACTIVE_CELLS));
+        params.elementCount = params.activeCellListOffset + params.maxActiveCells;
+        return params;
+    }
+
+    ReGIRBuildIndirectArguments ReGIRContext::getReGIRBuildInitialIndirectArguments(uint32_t threadGroupSize) const
+    {
+        assert(threadGroupSize > 0);
+
+        ReGIRBuildIndirectArguments args;
+        args.threadGroupCountX = (m_regirStaticParameters.LightsPerCell + threadGroupSize - 1) / threadGroupSize;
+        args.threadGroupCountY = 0;
+        args.threadGroupCountZ = 1;
+        return args;
+    }
+
+    ReGIRBuildIndirectArguments ReGIRContext::getReGIRBuildMaxIndirectArguments(uint32_t threadGroupSize) const
+    {
+        ReGIRBuildIndirectArguments args = getReGIRBuildInitialIndirectArguments(threadGroupSize);
+        args.threadGroupCountY = getReGIRActiveCellBufferParameters().maxActiveCells;
+        return args;
+    }
+
     ReGIRDynamicParameters ReGIRContext::getReGIRDynamicParameters() const
     {
         return m_regirDynamicParameters;
@@ -253,13 +526,210 @@ namespace rtxdi
 
     void ReGIRContext::setDynamicParameters(const ReGIRDynamicParameters& regirDynamicParameters)
     {
+        // The lights kept in the slots were selected with the previous build parameters
+        const ReGIRDynamicParameters& previous = m_regirDynamicParameters;
+        if (regirDynamicParameters.regirCellSize != previous.regirCellSize ||
+            regirDynamicParameters.presamplingMode != previous.presamplingMode ||
+            regirDynamicParameters.regirSamplingJitter != previous.regirSamplingJitter ||
+            regirDynamicParameters.regirNumBuildSamples != previous.regirNumBuildSamples ||
+            regirDynamicParameters.regirHashedLevelDistance != previous.regirHashedLevelDistance)
+        {
+            m_fullRebuildRequested = true;
+        }
+
         m_regirDynamicParameters = regirDynamicParameters;
     }
 
+    uint32_t ReGIRContext::GetRebuildPeriod() const
+    {
+        // Hashed cells are allocated again every frame, so slots don't keep the same cell
+        if (m_regirStaticParameters.Mode == ReGIRMode::Hashed)
+            return 1;
+
+        // The slots of a cell are only written in the frames where the cell is active
+        if (m_regirStaticParameters.BuildActiveCellsOnly)
+            return 1;
+
+        const float fraction = std::min(std::max(m_regirDynamicParameters.regirRebuildFraction, 0.f), 1.f);
+        if (fraction <= 0.f)
+            return std::max(getReGIRLightSlotCount(), 1u);
+
+        return std::max(uint32_t(roundf(1.f / fraction)), 1u);
+    }
+
+    void ReGIRContext::setFrameIndex(uint32_t frameIndex)
+    {
+        m_frameIndex = frameIndex;
+        m_rebuildPeriod = GetRebuildPeriod();
+
+        const float3& center = m_regirDynamicParameters.center;
+        const float centerMotion = Distance(center, m_fullRebuildCenter);
+        const bool centerMoved = centerMotion > m_regirDynamicParameters.regirFullRebuildCenterMotion * m_regirDynamicParameters.regirCellSize;
+
+        m_fullRebuild = m_rebuildPeriod == 1 || m_fullRebuildRequested || centerMoved;
+        if (m_fullRebuild)
+        {
+            m_fullRebuildRequested = false;
+            m_fullRebuildCenter = center;
+        }
+    }
+
+    void ReGIRContext::requestFullRebuild()
+    {
+        m_fullRebuildRequested = true;
+    }
+
+    bool ReGIRContext::isFullRebuild() const
+    {
+        return m_fullRebuild;
+    }
+
+    uint32_t ReGIRContext::getReGIRBuildThreadCount() const
+    {
+        const uint32_t period = m_fullRebuild ? 1 : m_rebuildPeriod;
+        return (getReGIRLightSlotCount() + period - 1) / period;
+    }
+
+    void ReGIRContext::fillReGIRParameters(ReGIR_Parameters& params) const
+    {
+        params.commonParams.localLightSamplingFallbackMode = uint32_t(m_regirDynamicParameters.fallbackSamplingMode);
+        params.commonParams.centerX = m_regirDynamicParameters.center.x;
+        params.commonParams.centerY = m_regirDynamicParameters.center.y;
+        params.commonParams.centerZ = m_regirDynamicParameters.center.z;
+        params.commonParams.risBufferOffset = m_regirCellOffset;
+        params.commonParams.lightsPerCell = m_regirStaticParameters.LightsPerCell;
+        params.commonParams.cellSize = m_regirDynamicParameters.regirCellSize;
+        // The shaders jitter by [-0.5, 0.5] * samplingJitter cells
+        params.commonParams.samplingJitter = std::max(0.f, m_regirDynamicParameters.regirSamplingJitter * 2.f);
+        params.commonParams.localLightPresamplingMode = uint32_t(m_regirDynamicParameters.presamplingMode);
+        params.commonParams.numRegirBuildSamples = m_regirDynamicParameters.regirNumBuildSamples;
+        const ReGIRActiveCellBufferParameters activeCellBufferParameters = getReGIRActiveCellBufferParameters();
+        params.commonParams.activeCellListOffset = activeCellBufferParameters.activeCellListOffset;
+        params.commonParams.maxActiveCells = activeCellBufferParameters.maxActiveCells;
+
+        params.gridParams.cellsX = m_regirStaticParameters.gridParameters.GridSize.x;
+        params.gridParams.cellsY = m_regirStaticParameters.gridParameters.GridSize.y;
+        params.gridParams.cellsZ = m_regirStaticParameters.gridParameters.GridSize.z;
+        params.gridParams.pad1 = 0;
+
+        params.clipmapParams.cellsX = m_regirStaticParameters.clipmapParameters.GridSize.x;
+        params.clipmapParams.cellsY = m_regirStaticParameters.clipmapParameters.GridSize.y;
+        params.clipmapParams.cellsZ = m_regirStaticParameters.clipmapParameters.GridSize.z;
+        params.clipmapParams.numLevels = m_regirClipmapCalculatedParameters.levelCount;
+
+        params.hashedParams.capacity = m_regirHashedCalculatedParameters.hashTableCapacity;
+        params.hashedParams.maxProbes = m_regirStaticParameters.hashedParameters.MaxProbes;
+        // Farther levels have at most levelDistance cells to the center, which must fit the 9-bit Y range of the keys
+        params.hashedParams.levelDistance = std::min(std::max(m_regirDynamicParameters.regirHashedLevelDistance, 1.f), 255.f);
+        params.hashedParams.pad1 = 0;
+
+        const uint32_t rebuildPeriod = m_fullRebuild ? 1 : m_rebuildPeriod;
+        params.temporalParams.rebuildPeriod = rebuildPeriod;
+        params.temporalParams.rebuildPhase = m_frameIndex % rebuildPeriod;
+        params.temporalParams.lightSlotCount = getReGIRLightSlotCount();
+        params.temporalParams.mergeHistory = m_fullRebuild ? 0 : 1;
+
+        params.onionParams = m_regirOnionParameters;
+    }
+
     bool ReGIRContext::isLocalLightPowerRISEnable() const
     {
         return (m_regirDynamicParameters.presamplingMode == LocalLightReGIRPresamplingMode::Power_RIS) ||
                (m_regirDynamicParameters.fallbackSamplingMode == LocalLightReGIRFallbackSamplingMode::Power_RIS);
     }
 
+    uint32_t CalculateReGIRHashTableCapacity(uint32_t expectedCellCount, float maxLoadFactor)
+    {
+        assert(maxLoadFactor > 0.f && maxLoadFactor <= 1.f);
+        const float capacity = ceilf(float(expectedCellCount) / maxLoadFactor);
+        return NextPowerOfTwo(uint32_t(std::min(std::max(capacity, 1.f), float(0x80000000u))));
+    }
+
+    ReGIRHashTable::ReGIRHashTable(uint32_t capacity, uint32_t maxProbes) :
+        m_maxProbes(maxProbes),
+        m_keys(NextPowerOfTwo(std::max(capacity, 1u)), 0)
+    {
+    }
+
+    void ReGIRHashTable::clear()
+    {
+        std::fill(m_keys.begin(), m_keys.end(), 0);
+        m_statistics = Statistics();
+    }
+
+    int ReGIRHashTable::insert(const ReGIR_Parameters& params, const float3& worldPos)
+    {
+        m_statistics.insertions++;
+
+        uint32_t key;
+        if (!GetHashedCellKey(params, worldPos, key))
+        {
+            m_statistics.failedInsertions++;
+            return -1;
+        }
+
+        const uint32_t mask = uint32_t(m_keys.size()) - 1;
+        for (uint32_t probe = 0; probe < m_maxProbes; probe++)
+        {
+            const uint32_t entryIndex = (JenkinsHash(key) + probe) & mask;
+            uint32_t& storedKey = m_keys[entryIndex];
+
+            if (storedKey == 0 || storedKey == key)
+            {
+                if (storedKey == 0)
+                    m_statistics.allocatedCells++;
+                storedKey = key;
+                m_statistics.extraProbes += probe;
+                m_statistics.longestProbeSequence = std::max(m_statistics.longestProbeSequence, probe + 1);
+                return int(entryIndex);
+            }
+        }
+
+        m_statistics.failedInsertions++;
+        m_statistics.extraProbes += m_maxProbes - 1;
+        m_statistics.longestProbeSequence = std::max(m_statistics.longestProbeSequence, m_maxProbes);
+        return -1;
+    }
+
+    int ReGIRHashTable::lookup(const ReGIR_Parameters& params, const float3& worldPos) const
+    {
+        uint32_t key;
+        if (!GetHashedCellKey(params, worldPos, key))
+            return -1;
+
+        const uint32_t mask = uint32_t(m_keys.size()) - 1;
+        for (uint32_t probe = 0; probe < m_maxProbes; probe++)
+        {
+            const uint32_t entryIndex = (JenkinsHash(key) + probe) & mask;
+
+            if (m_keys[entryIndex] == key)
+                return int(entryIndex);
+
+            if (m_keys[entryIndex] == 0)
+                return -1;
+        }
+
+        return -1;
+    }
+
+    uint32_t ReGIRHashTable::getCapacity() const
+    {
+        return uint32_t(m_keys.size());
+    }
+
+    float ReGIRHashTable::getLoadFactor() const
+    {
+        return float(m_statistics.allocatedCells) / float(m_keys.size());
+    }
+
+    const std::vector<uint32_t>& ReGIRHashTable::getKeys() const
+    {
+        return m_keys;
+    }
+
+    const ReGIRHashTable::Statistics& ReGIRHashTable::getStatistics() const
+    {
+        return m_statistics;
+    }
+
 }
@@ -9,6 +9,7 @@
  **************************************************************************/
 
 #include <rtxdi/ReSTIRDI.h>
+#include <algorithm>
 #include <cassert>
 #include <vector>
 #include <memory>
@@ -34,13 +35,31 @@ void debugCheckParameters(const ReSTIRDIStaticParameters& params)
 {
     assert(params.RenderWidth > 0);
     assert(params.RenderHeight > 0);
+    assert(params.MaxRenderWidth == 0 || params.MaxRenderWidth >= params.RenderWidth);
+    assert(params.MaxRenderHeight == 0 || params.MaxRenderHeight >= params.RenderHeight);
+}
+
+ReSTIRDIStaticParameters resolveMaxRenderSize(const ReSTIRDIStaticParameters& params)
+{
+    ReSTIRDIStaticParameters resolved = params;
+    resolved.MaxRenderWidth = std::max(params.MaxRenderWidth, params.RenderWidth);
+    resolved.MaxRenderHeight = std::max(params.MaxRenderHeight, params.RenderHeight);
+    return resolved;
+}
+
+uint32_t getDIReservoirPlaneCount(const ReSTIRDIStaticParameters& params)
+{
+    return (params.ReservoirBufferLayout == ReservoirLayout::StructureOfArrays) ? RTXDI_DI_RESERVOIR_PLANE_COUNT : 1;
 }
 
 ReSTIRDIContext::ReSTIRDIContext(const ReSTIRDIStaticParameters& params) :
-    m_staticParams(params),
+    m_staticParams(resolveMaxRenderSize(params)),
+    m_prevFrameRenderWidth(params.RenderWidth),
+    m_prevFrameRenderHeight(params.RenderHeight),
     m_frameIndex(0),
     m_resamplingMode(ReSTIRDI_ResamplingMode::TemporalAndSpatial),
-    m_reservoirBufferParams(CalculateReservoirBufferParameters(params.RenderWidth, params.RenderHeight, params.CheckerboardSamplingMode)),
+    m_reservoirBufferParams(CalculateReservoirBufferParameters(m_staticParams.MaxRenderWidth, m_staticParams.MaxRenderHeight, params.CheckerboardSamplingMode,
+        getDIReservoirPlaneCount(params), params.ReservoirBlockSize, params.ReservoirBlockAddressing)),
     m_bufferIndices(getDefaultReSTIRDIBufferIndices()),
     m_initialSamplingParams(getDefaultReSTIRDIInitialSamplingParams()),
     m_temporalResamplingParams(getDefaultReSTIRDITemporalResamplingParams()),
@@ -50,6 +69,7 @@ ReSTIRDIContext::ReSTIRDIContext(const ReSTIRDIStaticParameters& params) :
     debugCheckParameters(params);
     updateCheckerboardField();
     m_runtimeParams.neighborOffsetMask = m_staticParams.NeighborOffsetCount - 1;
+    updatePrevFrameScale();
     updateBufferIndices();
 }
 
@@ -70,7 +90,14 @@ RTXDI_ReservoirBufferParameters ReSTIRDIContext::getReservoirBufferParameters()
 
 ReSTIRDI_BufferIndices ReSTIRDIContext::getBufferIndices() const
 {
-    return m_bufferIndices;
+    ReSTIRDI_BufferIndices bufferIndices = m_bufferIndices;
+    bufferIndices.initialSamplingOutputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.temporalResamplingInputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.temporalResamplingOutputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.spatialResamplingInputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.spatialResamplingOutputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.shadingInputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    return bufferIndices;
 }
 
 ReSTIRDI_InitialSamplingParameters ReSTIRDIContext::getInitialSamplingParameters() const
@@ -85,7 +112,10 @@ ReSTIRDI_TemporalResamplingParameters ReSTIRDIContext::getTemporalResamplingPara
 
 ReSTIRDI_SpatialResamplingParameters ReSTIRDIContext::getSpatialResamplingParameters() const
 {
-    return m_spatialResamplingParams;
+    ReSTIRDI_SpatialResamplingParameters srp = m_spatialResamplingParams;
+    if (srp.enableAdaptiveSampleCount && m_adaptiveSpatialBudget > 0.f)
+        srp.numSpatialSamples = std::max(uint32_t(m_adaptiveSpatialBudget + 0.5f), srp.minSpatialSamples);
+    return srp;
 }
 
 ReSTIRDI_ShadingParameters ReSTIRDIContext::getShadingParameters() const
@@ -103,8 +133,11 @@ void ReSTIRDIContext::setFrameIndex(uint32_t frameIndex)
     m_frameIndex = frameIndex;
     m_temporalResamplingParams.uniformRandomNumber = JenkinsHash(m_frameIndex);
     m_LastFrameOutputReservoir = m_CurrentFrameOutputReservoir;
+    m_prevFrameRenderWidth = m_staticParams.RenderWidth;
+    m_prevFrameRenderHeight = m_staticParams.RenderHeight;
     updateBufferIndices();
     updateCheckerboardField();
+    updatePrevFrameScale();
 }
 
 uint32_t ReSTIRDIContext::getFrameIndex() const
@@ -141,6 +174,71 @@ void ReSTIRDIContext::setShadingParameters(const ReSTIRDI_ShadingParameters& sha
     m_shadingParams = shadingParams;
 }
 
+const ReSTIRDIAdaptiveSpatialSamplingParameters& ReSTIRDIContext::getAdaptiveSpatialSamplingParameters() const
+{
+    return m_adaptiveSpatialSamplingParams;
+}
+
+void ReSTIRDIContext::setAdaptiveSpatialSamplingParameters(const ReSTIRDIAdaptiveSpatialSamplingParameters& adaptiveParams)
+{
+    assert(adaptiveParams.minBudget > 0 && adaptiveParams.minBudget <= adaptiveParams.maxBudget);
+    assert(adaptiveParams.targetSamplesPerPixel > 0.f);
+    m_adaptiveSpatialSamplingParams = adaptiveParams;
+}
+
+void ReSTIRDIContext::updateAdaptiveSpatialSampling(uint64_t spatialSamplesTaken)
+{
+    if (!m_spatialResamplingParams.enableAdaptiveSampleCount)
+    {
+        m_adaptiveSpatialBudget = 0.f;
+        return;
+    }
+
+    const ReSTIRDIAdaptiveSpatialSamplingParameters& ap = m_adaptiveSpatialSamplingParams;
+    const float minBudget = float(ap.minBudget);
+    const float maxBudget = float(ap.maxBudget);
+
+    if (m_adaptiveSpatialBudget <= 0.f)
+        m_adaptiveSpatialBudget = std::min(std::max(float(m_spatialResamplingParams.numSpatialSamples), minBudget), maxBudget);
+
+    // The spatial pass runs once per reservoir, i.e. for half of the pixels in the checkerboard modes
+    const uint64_t reservoirCount = IsHalfWidthCheckerboard(m_staticParams.CheckerboardSamplingMode)
+        ? uint64_t((m_staticParams.RenderWidth + 1) / 2) * m_staticParams.RenderHeight
+        : uint64_t(m_staticParams.RenderWidth) * m_staticParams.RenderHeight;
+    if (spatialSamplesTaken == 0 || reservoirCount == 0)
+        return;
+
+    // The average count grows with the budget, but less than proportionally since converged pixels stay at the minimum.
+    // A multiplicative step with a damping exponent converges without knowing that relation.
+    const float samplesPerPixel = float(double(spatialSamplesTaken) / double(reservoirCount));
+    if (std::abs(samplesPerPixel - ap.targetSamplesPerPixel) <= ap.tolerance * ap.targetSamplesPerPixel)
+        return;
+
+    const float correction = powf(ap.targetSamplesPerPixel / samplesPerPixel, ap.responsiveness);
+    m_adaptiveSpatialBudget = std::min(std::max(m_adaptiveSpatialBudget * std::min(std::max(correction, 0.5f), 2.f), minBudget), maxBudget);
+}
+
+bool ReSTIRDIContext::resize(uint32_t renderWidth, uint32_t renderHeight)
+{
+    assert(renderWidth > 0);
+    assert(renderHeight > 0);
+
+    m_staticParams.RenderWidth = renderWidth;
+    m_staticParams.RenderHeight = renderHeight;
+
+    const bool fitsBuffers = renderWidth <= m_staticParams.MaxRenderWidth && renderHeight <= m_staticParams.MaxRenderHeight;
+    if (!fitsBuffers)
+    {
+        m_staticParams.MaxRenderWidth = std::max(m_staticParams.MaxRenderWidth, renderWidth);
+        m_staticParams.MaxRenderHeight = std::max(m_staticParams.MaxRenderHeight, renderHeight);
+        m_reservoirBufferParams = CalculateReservoirBufferParameters(m_staticParams.MaxRenderWidth, m_staticParams.MaxRenderHeight, m_staticParams.CheckerboardSamplingMode,
+            getDIReservoirPlaneCount(m_staticParams), m_staticParams.ReservoirBlockSize, m_staticParams.ReservoirBlockAddressing);
+    }
+
+    updatePrevFrameScale();
+    return fitsBuffers;
+}
+
 void ReSTIRDIContext::updateBufferIndices()
 {
     const bool useTemporalResampling =
@@ -191,4 +289,10 @@ void ReSTIRDIContext::updateCheckerboardField()
     }
 }
 
-}
\ No newline at end of file
+void ReSTIRDIContext::updatePrevFrameScale()
+{
+    m_runtimeParams.prevFrameScaleX = float(m_prevFrameRenderWidth) / float(m_staticParams.RenderWidth);
+    m_runtimeParams.prevFrameScaleY = float(m_prevFrameRenderHeight) / float(m_staticParams.RenderHeight);
+}
+
+}
@@ -0,0 +1,255 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include <rtxdi/ReSTIRDIHostExecutor.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace rtxdi
+{
+
+ReSTIRDIHostExecutor::ReSTIRDIHostExecutor(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+
+    // Worker 0 is the thread that calls executePass
+    for (uint32_t i = 1; i < threadCount; ++i)
+        m_threads.emplace_back(&ReSTIRDIHostExecutor::workerLoop, this, i);
+}
+
+ReSTIRDIHostExecutor::~ReSTIRDIHostExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+uint32_t ReSTIRDIHostExecutor::getThreadCount() const
+{
+    return uint32_t(m_queues.size());
+}
+
+const ReSTIRDIHostPassTimings& ReSTIRDIHostExecutor::getLastFrameTimings() const
+{
+    return m_lastFrameTimings;
+}
+
+ReSTIRDIHostFrameParameters ReSTIRDIHostExecutor::getFrameParameters(const ReSTIRDIContext& context)
+{
+    ReSTIRDIHostFrameParameters params = {};
+    params.restirDI.reservoirBufferParams = context.getReservoirBufferParameters();
+    params.restirDI.bufferIndices = context.getBufferIndices();
+    params.restirDI.initialSamplingParams = context.getInitialSamplingParameters();
+    params.restirDI.temporalResamplingParams = context.getTemporalResamplingParameters();
+    params.restirDI.spatialResamplingParams = context.getSpatialResamplingParameters();
+    params.restirDI.shadingParams = context.getShadingParameters();
+    params.runtimeParams = context.getRuntimeParams();
+    params.frameIndex = context.getFrameIndex();
+    return params;
+}
+
+void ReSTIRDIHostExecutor::executeFrame(const ReSTIRDIContext& context, const ReSTIRDIHostPasses& passes)
+{
+    const ReSTIRDIHostFrameParameters params = getFrameParameters(context);
+    const ReSTIRDIStaticParameters& staticParams = context.getStaticParameters();
+
+    const uint32_t reservoirWidth = IsHalfWidthCheckerboard(staticParams.CheckerboardSamplingMode)
+        ? (staticParams.RenderWidth + 1) / 2
+        : staticParams.RenderWidth;
+    const uint32_t reservoirHeight = staticParams.RenderHeight;
+    const uint32_t tileSize = GetReservoirBlockSize(context.getReservoirBufferParameters());
+
+    m_lastFrameTimings = ReSTIRDIHostPassTimings();
+
+    auto runPass = [&](const ReSTIRDIHostPassFunction& pass, double& timing)
+    {
+        if (!pass)
+            return;
+
+        const auto start = std::chrono::steady_clock::now();
+        executePass(reservoirWidth, reservoirHeight, pass, params, tileSize);
+        timing = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    runPass(passes.initialSampling, m_lastFrameTimings.initialSampling);
+
+    switch (context.getResamplingMode())
+    {
+    case ReSTIRDI_ResamplingMode::Temporal:
+        runPass(passes.temporalResampling, m_lastFrameTimings.temporalResampling);
+        break;
+    case ReSTIRDI_ResamplingMode::Spatial:
+        runPass(passes.spatialResampling, m_lastFrameTimings.spatialResampling);
+        break;
+    case ReSTIRDI_ResamplingMode::TemporalAndSpatial:
+        runPass(passes.temporalResampling, m_lastFrameTimings.temporalResampling);
+        runPass(passes.spatialResampling, m_lastFrameTimings.spatialResampling);
+        break;
+    case ReSTIRDI_ResamplingMode::FusedSpatiotemporal:
+        runPass(passes.fusedSpatiotemporalResampling, m_lastFrameTimings.fusedSpatiotemporalResampling);
+        break;
+    default:
+        break;
+    }
+
+    runPass(passes.shading, m_lastFrameTimings.shading);
+}
+
+void ReSTIRDIHostExecutor::executePass(uint32_t reservoirWidth, uint32_t reservoirHeight, const ReSTIRDIHostPassFunction& pass, const ReSTIRDIHostFrameParameters& params,
+    uint32_t tileSize)
+{
+    assert(pass);
+    assert(tileSize > 0);
+
+    const uint32_t tilesX = (reservoirWidth + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (reservoirHeight + tileSize - 1) / tileSize;
+    const uint32_t tileCount = tilesX * tilesY;
+    if (tileCount == 0)
+        return;
+
+    // Give each worker an equal contiguous range of tiles, neighboring tiles share cache lines of the G-buffer
+    const uint32_t workerCount = uint32_t(m_queues.size());
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        std::lock_guard<std::mutex> lock(m_queues[i]->mutex);
+        m_queues[i]->begin = uint32_t(uint64_t(tileCount) * i / workerCount);
+        m_queues[i]->end = uint32_t(uint64_t(tileCount) * (i + 1) / workerCount);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pass = &pass;
+        m_params = &params;
+        m_reservoirWidth = reservoirWidth;
+        m_reservoirHeight = reservoirHeight;
+        m_tilesX = tilesX;
+        m_tileSize = tileSize;
+        m_activeWorkers = uint32_t(m_threads.size());
+        ++m_passGeneration;
+    }
+    m_workAvailable.notify_all();
+
+    processTiles(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_workDone.wait(lock, [this]() { return m_activeWorkers == 0; });
+    m_pass = nullptr;
+    m_params = nullptr;
+}
+
+void ReSTIRDIHostExecutor::workerLoop(uint32_t workerIndex)
+{
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workAvailable.wait(lock, [&]() { return m_shutdown || m_passGeneration != generation; });
+            if (m_shutdown)
+                return;
+            generation = m_passGeneration;
+        }
+
+        processTiles(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeWorkers;
+            if (m_activeWorkers == 0)
+                m_workDone.notify_one();
+        }
+    }
+}
+
+void ReSTIRDIHostExecutor::processTiles(uint32_t workerIndex)
+{
+    uint32_t tileIndex;
+    while (true)
+    {
+        if (popTile(workerIndex, tileIndex))
+            processTile(tileIndex);
+        else if (!stealTiles(workerIndex))
+            break;
+    }
+}
+
+bool ReSTIRDIHostExecutor::popTile(uint32_t workerIndex, uint32_t& tileIndex)
+{
+    WorkerQueue& queue = *m_queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.begin >= queue.end)
+        return false;
+
+    tileIndex = queue.begin++;
+    return true;
+}
+
+bool ReSTIRDIHostExecutor::stealTiles(uint32_t workerIndex)
+{
+    const uint32_t workerCount = uint32_t(m_queues.size());
+
+    for (uint32_t i = 1; i < workerCount; ++i)
+    {
+        WorkerQueue& victim = *m_queues[(workerIndex + i) % workerCount];
+        uint32_t stolenBegin, stolenEnd;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.begin >= victim.end)
+                continue;
+
+            // Take the back half of the victim's range, the victim keeps working from the front
+            const uint32_t count = (victim.end - victim.begin + 1) / 2;
+            stolenEnd = victim.end;
+            stolenBegin = victim.end - count;
+            victim.end = stolenBegin;
+        }
+
+        WorkerQueue& queue = *m_queues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.begin = stolenBegin;
+        queue.end = stolenEnd;
+        return true;
+    }
+
+    return false;
+}
+
+void ReSTIRDIHostExecutor::processTile(uint32_t tileIndex)
+{
+    const uint32_t tileX = tileIndex % m_tilesX;
+    const uint32_t tileY = tileIndex / m_tilesX;
+    const uint32_t beginX = tileX * m_tileSize;
+    const uint32_t beginY = tileY * m_tileSize;
+    const uint32_t endX = std::min(beginX + m_tileSize, m_reservoirWidth);
+    const uint32_t endY = std::min(beginY + m_tileSize, m_reservoirHeight);
+
+    // The whole tile is one block of the reservoir buffer, see RTXDI_ReservoirPositionToPointer
+    for (uint32_t y = beginY; y < endY; ++y)
+    {
+        for (uint32_t x = beginX; x < endX; ++x)
+        {
+            (*m_pass)(x, y, *m_params);
+        }
+    }
+}
+
+}
@@ -10,13 +10,46 @@
 
 #include "rtxdi/ReSTIRGI.h"
 
+#include <algorithm>
+#include <cassert>
+
 namespace rtxdi
 {
 
+namespace
+{
+
+uint32_t getGIReservoirPlaneCount(const ReSTIRGIStaticParameters& params)
+{
+    return (params.ReservoirBufferLayout == ReservoirLayout::StructureOfArrays) ? RTXDI_GI_RESERVOIR_PLANE_COUNT : 1;
+}
+
+// Fills in the maximum render size, and turns off checkerboard sampling for quarter-resolution reservoirs
+ReSTIRGIStaticParameters resolveStaticParams(const ReSTIRGIStaticParameters& params)
+{
+    ReSTIRGIStaticParameters resolved = params;
+    resolved.MaxRenderWidth = std::max(params.MaxRenderWidth, params.RenderWidth);
+    resolved.MaxRenderHeight = std::max(params.MaxRenderHeight, params.RenderHeight);
+    if (params.ReservoirResolution != ReSTIRGI_ReservoirResolution::Full)
+        resolved.CheckerboardSamplingMode = CheckerboardMode::Off;
+    return resolved;
+}
+
+RTXDI_ReservoirBufferParameters calculateGIReservoirBufferParameters(const ReSTIRGIStaticParameters& params)
+{
+    return CalculateReservoirBufferParameters(params.MaxRenderWidth, params.MaxRenderHeight, params.CheckerboardSamplingMode,
+        getGIReservoirPlaneCount(params), params.ReservoirBlockSize, params.ReservoirBlockAddressing,
+        GetReservoirDownscaleLog2(params.ReservoirResolution));
+}
+
+}
+
 ReSTIRGIContext::ReSTIRGIContext(const ReSTIRGIStaticParameters& staticParams) :
+    m_staticParams(resolveStaticParams(staticParams)),
+    m_prevFrameRenderWidth(staticParams.RenderWidth),
+    m_prevFrameRenderHeight(staticParams.RenderHeight),
     m_frameIndex(0),
-    m_reservoirBufferParams(CalculateReservoirBufferParameters(staticParams.RenderWidth, staticParams.RenderHeight, staticParams.CheckerboardSamplingMode)),
-    m_staticParams(staticParams),
+    m_reservoirBufferParams(calculateGIReservoirBufferParameters(m_staticParams)),
     m_resamplingMode(rtxdi::ReSTIRGI_ResamplingMode::None),
     m_bufferIndices(getDefaultReSTIRGIBufferIndices()),
     m_temporalResamplingParams(getDefaultReSTIRGITemporalResamplingParams()),
@@ -47,7 +80,14 @@ ReSTIRGI_ResamplingMode ReSTIRGIContext::getResamplingMode() const
 
 ReSTIRGI_BufferIndices ReSTIRGIContext::getBufferIndices() const
 {
-    return m_bufferIndices;
+    ReSTIRGI_BufferIndices bufferIndices = m_bufferIndices;
+    bufferIndices.secondarySurfaceReSTIRDIOutputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.temporalResamplingInputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.temporalResamplingOutputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.spatialResamplingInputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.spatialResamplingOutputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    bufferIndices.finalShadingInputBufferIndex += m_staticParams.ReservoirArrayOffset;
+    return bufferIndices;
 }
 
 ReSTIRGI_TemporalResamplingParameters ReSTIRGIContext::getTemporalResamplingParameters() const
@@ -65,10 +105,18 @@ ReSTIRGI_FinalShadingParameters ReSTIRGIContext::getFinalShadingParameters() con
     return m_finalShadingParams;
 }
 
+void ReSTIRGIContext::fillRuntimeParams(RTXDI_RuntimeParameters& runtimeParams) const
+{
+    runtimeParams.prevFrameScaleX = float(m_prevFrameRenderWidth) / float(m_staticParams.RenderWidth);
+    runtimeParams.prevFrameScaleY = float(m_prevFrameRenderHeight) / float(m_staticParams.RenderHeight);
+}
+
 void ReSTIRGIContext::setFrameIndex(uint32_t frameIndex)
 {
     m_frameIndex = frameIndex;
     m_temporalResamplingParams.uniformRandomNumber = JenkinsHash(m_frameIndex);
+    m_prevFrameRenderWidth = m_staticParams.RenderWidth;
+    m_prevFrameRenderHeight = m_staticParams.RenderHeight;
     updateBufferIndices();
 }
 
@@ -94,6 +142,25 @@ void ReSTIRGIContext::setFinalShadingParameters(const ReSTIRGI_FinalShadingParam
     m_finalShadingParams = finalShadingParams;
 }
 
+bool ReSTIRGIContext::resize(uint32_t renderWidth, uint32_t renderHeight)
+{
+    assert(renderWidth > 0);
+    assert(renderHeight > 0);
+
+    m_staticParams.RenderWidth = renderWidth;
+    m_staticParams.RenderHeight = renderHeight;
+
+    const bool fitsBuffers = renderWidth <= m_staticParams.MaxRenderWidth && renderHeight <= m_staticParams.MaxRenderHeight;
+    if (!fitsBuffers)
+    {
+        m_staticParams.MaxRenderWidth = std::max(m_staticParams.MaxRenderWidth, renderWidth);
+        m_staticParams.MaxRenderHeight = std::max(m_staticParams.MaxRenderHeight, renderHeight);
+        m_reservoirBufferParams = calculateGIReservoirBufferParameters(m_staticParams);
+    }
+
+    return fitsBuffers;
+}
+
 void ReSTIRGIContext::updateBufferIndices()
 {
     switch (m_resamplingMode)
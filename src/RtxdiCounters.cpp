@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "rtxdi/RtxdiCounters.h"
+
+namespace
+{
+
+template<typename T>
+rtxdi::ReSTIRCounters DecodeCounters(const T* counterBuffer, uint32_t(*load)(const T&))
+{
+    rtxdi::ReSTIRCounters counters;
+    counters.temporalSearches = load(counterBuffer[RTXDI_COUNTER_TEMPORAL_SEARCHES]);
+    counters.temporalSearchFailures = load(counterBuffer[RTXDI_COUNTER_TEMPORAL_SEARCH_FAILURES]);
+    counters.disocclusionBoosts = load(counterBuffer[RTXDI_COUNTER_DISOCCLUSION_BOOSTS]);
+    counters.boilingFilterRejections = load(counterBuffer[RTXDI_COUNTER_BOILING_FILTER_REJECTIONS]);
+    counters.biasCorrectionRays = load(counterBuffer[RTXDI_COUNTER_BIAS_CORRECTION_RAYS]);
+    counters.spatialSamples = load(counterBuffer[RTXDI_COUNTER_SPATIAL_SAMPLES]);
+    return counters;
+}
+
+uint32_t LoadValue(const uint32_t& value)
+{
+    return value;
+}
+
+uint32_t LoadAtomic(const std::atomic<uint32_t>& value)
+{
+    return value.load(std::memory_order_relaxed);
+}
+
+}
+
+namespace rtxdi
+{
+
+float ReSTIRCounters::getTemporalSearchFailureRate() const
+{
+    return (temporalSearches > 0) ? float(double(temporalSearchFailures) / double(temporalSearches)) : 0.f;
+}
+
+ReSTIRCounters& ReSTIRCounters::operator+=(const ReSTIRCounters& other)
+{
+    temporalSearches += other.temporalSearches;
+    temporalSearchFailures += other.temporalSearchFailures;
+    disocclusionBoosts += other.disocclusionBoosts;
+    boilingFilterRejections += other.boilingFilterRejections;
+    biasCorrectionRays += other.biasCorrectionRays;
+    spatialSamples += other.spatialSamples;
+    return *this;
+}
+
+ReSTIRCounters DecodeReSTIRCounters(const uint32_t* counterBuffer)
+{
+    return DecodeCounters(counterBuffer, LoadValue);
+}
+
+ReSTIRCounters DecodeReSTIRCounters(const std::atomic<uint32_t>* counterBuffer)
+{
+    return DecodeCounters(counterBuffer, LoadAtomic);
+}
+
+void ReSTIRCounterAggregator::addFrame(const ReSTIRCounters& frameCounters)
+{
+    m_lastFrame = frameCounters;
+    m_total += frameCounters;
+    ++m_frameCount;
+}
+
+void ReSTIRCounterAggregator::reset()
+{
+    m_lastFrame = ReSTIRCounters();
+    m_total = ReSTIRCounters();
+    m_frameCount = 0;
+}
+
+const ReSTIRCounters& ReSTIRCounterAggregator::getLastFrame() const
+{
+    return m_lastFrame;
+}
+
+const ReSTIRCounters& ReSTIRCounterAggregator::getTotal() const
+{
+    return m_total;
+}
+
+uint32_t ReSTIRCounterAggregator::getFrameCount() const
+{
+    return m_frameCount;
+}
+
+}
@@ -10,25 +10,86 @@
 
 #include <rtxdi/RtxdiUtils.h>
 
+#include <rtxdi/NeighborOffsets.h>
+#include <rtxdi/ReSTIRGIParameters.h>
+
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 
 namespace rtxdi
 {
 
-RTXDI_ReservoirBufferParameters CalculateReservoirBufferParameters(uint32_t renderWidth, uint32_t renderHeight, CheckerboardMode checkerboardMode)
+static_assert((1u << RTXDI_RESERVOIR_BLOCK_SIZE_LOG2) == RTXDI_RESERVOIR_BLOCK_SIZE, "RTXDI_RESERVOIR_BLOCK_SIZE_LOG2 doesn't match RTXDI_RESERVOIR_BLOCK_SIZE");
+
+RTXDI_ReservoirBufferParameters CalculateReservoirBufferParameters(uint32_t renderWidth, uint32_t renderHeight, CheckerboardMode checkerboardMode,
+    uint32_t planeCount, uint32_t blockSize, ReservoirBlockOrder blockOrder, uint32_t downscaleLog2)
 {
-    renderWidth = (checkerboardMode == CheckerboardMode::Off)
-        ? renderWidth
-        : (renderWidth + 1) / 2;
-    uint32_t renderWidthBlocks = (renderWidth + RTXDI_RESERVOIR_BLOCK_SIZE - 1) / RTXDI_RESERVOIR_BLOCK_SIZE;
-    uint32_t renderHeightBlocks = (renderHeight + RTXDI_RESERVOIR_BLOCK_SIZE - 1) / RTXDI_RESERVOIR_BLOCK_SIZE;
+    assert(planeCount > 0);
+    // Block size 1 would encode as 0, which means the default block size
+    assert(blockSize >= 2 && (blockSize & (blockSize - 1)) == 0);
+    assert(downscaleLog2 <= RTXDI_RESERVOIR_DOWNSCALE_LOG2_MASK);
+    assert(downscaleLog2 == 0 || !IsHalfWidthCheckerboard(checkerboardMode));
+
+    uint32_t blockSizeLog2 = 0;
+    while ((1u << blockSizeLog2) < blockSize)
+        ++blockSizeLog2;
+
+    renderWidth = IsHalfWidthCheckerboard(checkerboardMode)
+        ? (renderWidth + 1) / 2
+        : renderWidth;
+    renderWidth = (renderWidth + (1u << downscaleLog2) - 1) >> downscaleLog2;
+    renderHeight = (renderHeight + (1u << downscaleLog2) - 1) >> downscaleLog2;
+    uint32_t renderWidthBlocks = (renderWidth + blockSize - 1) / blockSize;
+    uint32_t renderHeightBlocks = (renderHeight + blockSize - 1) / blockSize;
     RTXDI_ReservoirBufferParameters params;
-    params.reservoirBlockRowPitch = renderWidthBlocks * (RTXDI_RESERVOIR_BLOCK_SIZE * RTXDI_RESERVOIR_BLOCK_SIZE);
-    params.reservoirArrayPitch = params.reservoirBlockRowPitch * renderHeightBlocks;
+    params.reservoirBlockRowPitch = renderWidthBlocks * (blockSize * blockSize);
+    params.reservoirPlanePitch = params.reservoirBlockRowPitch * renderHeightBlocks;
+    params.reservoirArrayPitch = params.reservoirPlanePitch * planeCount;
+    params.reservoirAddressing = blockSizeLog2
+        | ((blockOrder == ReservoirBlockOrder::ZOrder) ? RTXDI_RESERVOIR_BLOCK_ZORDER_BIT : 0)
+        | (downscaleLog2 << RTXDI_RESERVOIR_DOWNSCALE_LOG2_SHIFT);
     return params;
 }
 
+uint32_t GetReservoirBlockSize(const RTXDI_ReservoirBufferParameters& params)
+{
+    const uint32_t blockSizeLog2 = params.reservoirAddressing & RTXDI_RESERVOIR_BLOCK_SIZE_LOG2_MASK;
+    return 1u << ((blockSizeLog2 != 0) ? blockSizeLog2 : RTXDI_RESERVOIR_BLOCK_SIZE_LOG2);
+}
+
+uint32_t GetDIReservoirSizeInBytes(DIReservoirFormat format)
+{
+    return (format == DIReservoirFormat::Compact)
+        ? uint32_t(sizeof(RTXDI_CompactDIReservoir))
+        : uint32_t(sizeof(RTXDI_PackedDIReservoir));
+}
+
+uint64_t CalculateDIReservoirBufferSizeInBytes(const RTXDI_ReservoirBufferParameters& params, uint32_t reservoirArrayCount, DIReservoirFormat format)
+{
+    // The planes of the SoA layout split the same record, so the size only depends on the number of reservoirs
+    return uint64_t(params.reservoirPlanePitch) * reservoirArrayCount * GetDIReservoirSizeInBytes(format);
+}
+
+uint64_t CalculateDIMultiReservoirBufferSizeInBytes(const RTXDI_ReservoirBufferParameters& params, uint32_t reservoirArrayCount,
+    uint32_t samplesPerReservoir, DIReservoirFormat format)
+{
+    assert(samplesPerReservoir >= 2 && samplesPerReservoir <= 4);
+    return CalculateDIReservoirBufferSizeInBytes(params, reservoirArrayCount * samplesPerReservoir, format);
+}
+
+uint32_t GetGIReservoirSizeInBytes(GIReservoirFormat format)
+{
+    return (format == GIReservoirFormat::Compact)
+        ? uint32_t(sizeof(RTXDI_CompactGIReservoir))
+        : uint32_t(sizeof(RTXDI_PackedGIReservoir));
+}
+
+uint64_t CalculateGIReservoirBufferSizeInBytes(const RTXDI_ReservoirBufferParameters& params, uint32_t reservoirArrayCount, GIReservoirFormat format)
+{
+    return uint64_t(params.reservoirPlanePitch) * reservoirArrayCount * GetGIReservoirSizeInBytes(format);
+}
+
 void ComputePdfTextureSize(uint32_t maxItems, uint32_t& outWidth, uint32_t& outHeight, uint32_t& outMipLevels)
 {
     // Compute the size of a power-of-2 rectangle that fits all items, 1 item per pixel
@@ -43,29 +104,66 @@ void ComputePdfTextureSize(uint32_t maxItems, uint32_t& outWidth, uint32_t& outH
     outMipLevels = uint32_t(textureMips);
 }
 
+bool IsHalfWidthCheckerboard(CheckerboardMode checkerboardMode)
+{
+    return checkerboardMode == CheckerboardMode::Black || checkerboardMode == CheckerboardMode::White;
+}
+
+void GetVariableRateMapSize(uint32_t renderWidth, uint32_t renderHeight, uint32_t& outWidthInTiles, uint32_t& outHeightInTiles)
+{
+    outWidthInTiles = (renderWidth + RTXDI_VARIABLE_RATE_TILE_SIZE - 1) / RTXDI_VARIABLE_RATE_TILE_SIZE;
+    outHeightInTiles = (renderHeight + RTXDI_VARIABLE_RATE_TILE_SIZE - 1) / RTXDI_VARIABLE_RATE_TILE_SIZE;
+}
+
+void BuildVariableRateMap(const float* pixelVariance, uint32_t renderWidth, uint32_t renderHeight, uint32_t frameIndex,
+    const VariableRateMapParameters& params, uint32_t* outRateMap)
+{
+    assert(params.quarterRateVarianceThreshold <= params.halfRateVarianceThreshold);
+
+    uint32_t widthInTiles, heightInTiles;
+    GetVariableRateMapSize(renderWidth, renderHeight, widthInTiles, heightInTiles);
+
+    const uint32_t phase = (frameIndex & 3) << RTXDI_VARIABLE_RATE_PHASE_SHIFT;
+
+    for (uint32_t tileY = 0; tileY < heightInTiles; ++tileY)
+    {
+        for (uint32_t tileX = 0; tileX < widthInTiles; ++tileX)
+        {
+            const uint32_t x0 = tileX * RTXDI_VARIABLE_RATE_TILE_SIZE;
+            const uint32_t y0 = tileY * RTXDI_VARIABLE_RATE_TILE_SIZE;
+            const uint32_t x1 = std::min(x0 + RTXDI_VARIABLE_RATE_TILE_SIZE, renderWidth);
+            const uint32_t y1 = std::min(y0 + RTXDI_VARIABLE_RATE_TILE_SIZE, renderHeight);
+
+            // The rate is set by the noisiest pixel, and NaN or unknown variance keeps the tile at full rate
+            uint32_t rate = RTXDI_SAMPLING_RATE_QUARTER;
+            for (uint32_t y = y0; y < y1 && rate != RTXDI_SAMPLING_RATE_FULL; ++y)
+            {
+                for (uint32_t x = x0; x < x1; ++x)
+                {
+                    const float variance = pixelVariance[size_t(y) * renderWidth + x];
+                    if (!(variance < params.halfRateVarianceThreshold))
+                    {
+                        rate = RTXDI_SAMPLING_RATE_FULL;
+                        break;
+                    }
+                    if (!(variance < params.quarterRateVarianceThreshold))
+                        rate = RTXDI_SAMPLING_RATE_HALF;
+                }
+            }
+
+            outRateMap[tileY * widthInTiles + tileX] = rate | phase;
+        }
+    }
+}
+
 void FillNeighborOffsetBuffer(uint8_t* buffer, uint32_t neighborOffsetCount)
 {
     // Create a sequence of low-discrepancy samples within a unit radius around the origin
     // for "randomly" sampling neighbors during spatial resampling
-
-    int R = 250;
-    const float phi2 = 1.0f / 1.3247179572447f;
-    uint32_t num = 0;
-    float u = 0.5f;
-    float v = 0.5f;
-    while (num < neighborOffsetCount * 2) {
-        u += phi2;
-        v += phi2 * phi2;
-        if (u >= 1.0f) u -= 1.0f;
-        if (v >= 1.0f) v -= 1.0f;
-
-        float rSq = (u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f);
-        if (rSq > 0.25f)
-            continue;
-
-        buffer[num++] = int8_t((u - 0.5f) * R);
-        buffer[num++] = int8_t((v - 0.5f) * R);
-    }
+    NeighborOffsetParameters params;
+    params.count = neighborOffsetCount;
+    params.setSize = std::min(params.setSize, neighborOffsetCount);
+    GenerateNeighborOffsets(params, buffer);
 }
 
 uint32_t JenkinsHash(uint32_t a)
@@ -0,0 +1,240 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Throughput of the two local light presampling passes, RTXDI_PresampleLocalLights over the PDF mipmap of
+// rtxdi::LightPdfMipmap and RTXDI_PresampleLocalLightsAliasTable over the table of rtxdi::LightAliasTable,
+// at 1k, 64k and 1M lights with log-uniform power and some unlit lights. Both passes fill the same RIS tiles.
+// Before timing, the program checks that the alias table reproduces the power distribution:
+//   - the selection probabilities implied by the thresholds and aliases match the normalized power,
+//   - LightAliasTable::sample draws lights with these frequencies and reports their pdf,
+//   - the inverse pdfs written to the RIS buffer by both passes match the normalized power.
+// It exits nonzero if a check fails.
+
+#define RTXDI_LIGHT_ALIAS_TABLE g_lightAliasTable
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+#include <rtxdi/PresamplingFunctions.hlsli>
+
+#include <rtxdi/LightAliasTable.h>
+#include <rtxdi/LightPdfMipmap.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    const uint c_tileCount = 128;
+    const uint c_tileSize = 1024;
+    const uint c_timedPasses = 4;
+    const uint c_referenceSamples = 10000000;
+
+    // The thresholds are stored as floats, so the implied distribution is exact up to float rounding
+    const double c_maxTableTotalVariation = 1e-5;
+    const double c_maxPdfRelativeError = 1e-3;
+    // Chi-square of the sampled frequencies, in standard deviations above its expectation
+    const double c_maxChiSquareSigma = 5.0;
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    std::vector<float> CreateLightPower(uint lightCount, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> logPower(std::log(1e-3f), std::log(1e3f));
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        std::vector<float> power(lightCount);
+        for (float& p : power)
+            p = u(rng) < 0.1f ? 0.f : std::exp(logPower(rng));
+        return power;
+    }
+
+    // Selection probabilities implied by the table: entry i selects light i with probability threshold / N,
+    // and its alias with probability (1 - threshold) / N
+    void CheckTableDistribution(const rtxdi::LightAliasTable& table, const std::vector<float>& power)
+    {
+        const uint lightCount = table.getSize();
+        const RTXDI_AliasTableEntry* entries = table.getEntries();
+
+        std::vector<double> probability(lightCount, 0.0);
+        for (uint i = 0; i < lightCount; i++)
+        {
+            probability[i] += double(entries[i].threshold) / lightCount;
+            probability[entries[i].alias] += (1.0 - double(entries[i].threshold)) / lightCount;
+        }
+
+        double totalVariation = 0.0;
+        double maxPdfError = 0.0;
+        bool unlitSelected = false;
+        for (uint i = 0; i < lightCount; i++)
+        {
+            const double expected = double(power[i]) / table.getTotalPower();
+            totalVariation += 0.5 * std::abs(probability[i] - expected);
+            if (expected > 0.0)
+                maxPdfError = std::max(maxPdfError, std::abs(double(entries[i].pdf) - expected) / expected);
+            else
+                unlitSelected = unlitSelected || probability[i] > 0.0;
+        }
+
+        printf("  table: total variation from the power distribution %.2e, pdf rel. error %.2e\n", totalVariation, maxPdfError);
+        Check(totalVariation <= c_maxTableTotalVariation, "alias table reproduces the power distribution");
+        Check(maxPdfError <= c_maxPdfRelativeError, "alias table pdfs match the normalized power");
+        Check(!unlitSelected, "unlit lights are never selected");
+    }
+
+    void CheckSampledDistribution(const rtxdi::LightAliasTable& table, const std::vector<float>& power, std::mt19937& rng)
+    {
+        const uint lightCount = table.getSize();
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        std::vector<uint> counts(lightCount, 0);
+        bool pdfMismatch = false;
+        for (uint s = 0; s < c_referenceSamples; s++)
+        {
+            float pdf;
+            const uint lightIndex = table.sample(u(rng), u(rng), pdf);
+            counts[lightIndex]++;
+            pdfMismatch = pdfMismatch || pdf != table.getEntries()[lightIndex].pdf;
+        }
+
+        double chiSquare = 0.0;
+        uint degreesOfFreedom = 0;
+        bool unlitSelected = false;
+        for (uint i = 0; i < lightCount; i++)
+        {
+            const double expected = double(power[i]) / table.getTotalPower() * c_referenceSamples;
+            if (expected > 0.0)
+            {
+                chiSquare += (counts[i] - expected) * (counts[i] - expected) / expected;
+                degreesOfFreedom++;
+            }
+            else
+            {
+                unlitSelected = unlitSelected || counts[i] > 0;
+            }
+        }
+        degreesOfFreedom--;
+
+        const double sigma = (chiSquare - degreesOfFreedom) / std::sqrt(2.0 * degreesOfFreedom);
+        printf("  LightAliasTable::sample: chi-square %.0f for %u degrees of freedom (%+.1f sigma)\n", chiSquare, degreesOfFreedom, sigma);
+        Check(sigma <= c_maxChiSquareSigma, "LightAliasTable::sample follows the power distribution");
+        Check(!pdfMismatch, "LightAliasTable::sample reports the pdf of the selected light");
+        Check(!unlitSelected, "LightAliasTable::sample never selects unlit lights");
+    }
+
+    // Every RIS sample must carry the inverse of the normalized power of its light
+    double MaxRISPdfError(const std::vector<float>& power, double totalPower)
+    {
+        double maxError = 0.0;
+        for (const uint2& sample : g_risBuffer)
+        {
+            const uint lightIndex = sample.x & ~RTXDI_LIGHT_COMPACT_BIT;
+            const float invSourcePdf = asfloat(sample.y);
+            if (lightIndex >= power.size() || invSourcePdf <= 0.f)
+                return INFINITY;
+
+            const double expected = double(power[lightIndex]) / totalPower;
+            maxError = std::max(maxError, std::abs(1.0 / invSourcePdf - expected) / expected);
+        }
+        return maxError;
+    }
+
+    template<typename Pass>
+    double SamplesPerSecond(Pass pass)
+    {
+        RAB_RandomSamplerState rng = RTXDI_HostInitRandomSampler(1);
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint p = 0; p < c_timedPasses; p++)
+        {
+            for (uint tileIndex = 0; tileIndex < c_tileCount; tileIndex++)
+            {
+                for (uint sampleInTile = 0; sampleInTile < c_tileSize; sampleInTile++)
+                    pass(rng, tileIndex, sampleInTile);
+            }
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        return double(c_timedPasses) * c_tileCount * c_tileSize / std::chrono::duration<double>(end - start).count();
+    }
+
+    void Run(uint lightCount, std::mt19937& rng)
+    {
+        printf("%u lights:\n", lightCount);
+
+        const std::vector<float> power = CreateLightPower(lightCount, rng);
+        g_lights.assign(lightCount, RAB_LightInfo{ float3(0.f), float3(1.f) });
+
+        rtxdi::LightAliasTable aliasTable;
+        aliasTable.build(power.data(), lightCount);
+        g_lightAliasTable.assign(aliasTable.getEntries(), aliasTable.getEntries() + lightCount);
+
+        rtxdi::LightPdfMipmap pdfMipmap(lightCount);
+        pdfMipmap.build(power.data(), lightCount);
+        rtxdi::host::Texture2D pdfTexture;
+        pdfTexture.mipLevels = pdfMipmap.getMipDataPointers();
+        pdfTexture.width = pdfMipmap.getWidth();
+        pdfTexture.height = pdfMipmap.getHeight();
+        pdfTexture.mipCount = pdfMipmap.getMipLevels();
+        const uint2 pdfTextureSize = uint2(pdfTexture.width, pdfTexture.height);
+
+        CheckTableDistribution(aliasTable, power);
+        if (lightCount <= 1024)
+            CheckSampledDistribution(aliasTable, power, rng);
+
+        RTXDI_LightBufferRegion localLightBufferRegion = {};
+        localLightBufferRegion.firstLightIndex = 0;
+        localLightBufferRegion.numLights = lightCount;
+
+        RTXDI_RISBufferSegmentParameters risBufferSegmentParams = {};
+        risBufferSegmentParams.bufferOffset = 0;
+        risBufferSegmentParams.tileSize = c_tileSize;
+        risBufferSegmentParams.tileCount = c_tileCount;
+        g_risBuffer.assign(c_tileCount * c_tileSize, uint2(0u));
+
+        const double mipmapRate = SamplesPerSecond([&](RAB_RandomSamplerState& sampleRng, uint tileIndex, uint sampleInTile) {
+            RTXDI_PresampleLocalLights(sampleRng, pdfTexture, pdfTextureSize, tileIndex, sampleInTile, localLightBufferRegion, risBufferSegmentParams);
+        });
+        const double mipmapPdfError = MaxRISPdfError(power, aliasTable.getTotalPower());
+
+        const double aliasTableRate = SamplesPerSecond([&](RAB_RandomSamplerState& sampleRng, uint tileIndex, uint sampleInTile) {
+            RTXDI_PresampleLocalLightsAliasTable(sampleRng, tileIndex, sampleInTile, localLightBufferRegion, risBufferSegmentParams);
+        });
+        const double aliasTablePdfError = MaxRISPdfError(power, aliasTable.getTotalPower());
+
+        printf("  RIS pdf rel. error: PDF mipmap %.2e, alias table %.2e\n", mipmapPdfError, aliasTablePdfError);
+        printf("  PDF mipmap  %7.2f M samples/s\n", mipmapRate * 1e-6);
+        printf("  alias table %7.2f M samples/s (%.1fx)\n", aliasTableRate * 1e-6, aliasTableRate / mipmapRate);
+
+        Check(mipmapPdfError <= c_maxPdfRelativeError, "PDF mipmap presampling writes the normalized power as pdf");
+        Check(aliasTablePdfError <= c_maxPdfRelativeError, "alias table presampling writes the normalized power as pdf");
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(3);
+    for (uint lightCount : { 1u << 10, 1u << 16, 1u << 20 })
+        Run(lightCount, rng);
+
+    if (g_failures == 0)
+        printf("Alias table benchmark checks passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Round-trip error of the compact DI reservoir format (RTXDI_COMPACT_DI_RESERVOIR) against the full format.
+// Random reservoirs are stored and loaded through the reservoir buffer in the compact format, and compared
+// with the same reservoirs packed and unpacked as RTXDI_PackedDIReservoir.
+
+#define RTXDI_COMPACT_DI_RESERVOIR 1
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+#include <rtxdi/DIReservoir.hlsli>
+
+#include <rtxdi/RtxdiUtils.h>
+
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    const int c_reservoirCount = 100000;
+    const int c_viewSize = 64;
+
+    // Half precision keeps 11 significant bits, rounded to nearest
+    const float c_maxHalfRelativeError = 1.f / 2048.f;
+    // The 12-bit UV channels are expanded back to 16 bits by replicating their high bits
+    const float c_maxUVError = 16.f / 65535.f;
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    uint VisibilityChannel(uint packedVisibility, uint channel)
+    {
+        return (packedVisibility >> (channel * RTXDI_PackedDIReservoir_VisibilityChannelShift)) & RTXDI_PackedDIReservoir_VisibilityChannelMax;
+    }
+
+    float RelativeError(float value, float reference)
+    {
+        return reference != 0.f ? std::abs(value - reference) / reference : std::abs(value);
+    }
+
+    struct Errors
+    {
+        float targetPdf = 0.f;
+        float weight = 0.f;
+        float uv = 0.f;
+        uint visibility = 0;
+        int mismatches = 0;
+    };
+
+    RTXDI_DIReservoir RandomReservoir(std::mt19937& rng)
+    {
+        // Log-uniform weights over the normal range of half floats
+        std::uniform_real_distribution<float> logValue(std::log(1e-4f), std::log(6e4f));
+        std::uniform_int_distribution<uint> bits;
+
+        RTXDI_DIReservoir reservoir = RTXDI_EmptyDIReservoir();
+        reservoir.lightData = (bits(rng) & RTXDI_DIReservoir_LightIndexMask) | RTXDI_DIReservoir_LightValidBit;
+        reservoir.uvData = bits(rng);
+        reservoir.targetPdf = std::exp(logValue(rng));
+        reservoir.weightSum = std::exp(logValue(rng));
+        reservoir.M = float(bits(rng) % (RTXDI_CompactDIReservoir_MaxM + 1));
+        reservoir.packedVisibility = bits(rng) & RTXDI_PackedDIReservoir_VisibilityMask;
+        reservoir.spatialDistance = int2(
+            int(bits(rng) % (2 * RTXDI_CompactDIReservoir_MaxDistance + 1)) - RTXDI_CompactDIReservoir_MaxDistance,
+            int(bits(rng) % (2 * RTXDI_CompactDIReservoir_MaxDistance + 1)) - RTXDI_CompactDIReservoir_MaxDistance);
+        reservoir.age = bits(rng) % (RTXDI_CompactDIReservoir_MaxAge + 1);
+        return reservoir;
+    }
+
+    void CompareWithFullFormat(const RTXDI_DIReservoir& compact, const RTXDI_DIReservoir& full, Errors& errors)
+    {
+        errors.targetPdf = std::max(errors.targetPdf, RelativeError(compact.targetPdf, full.targetPdf));
+        errors.weight = std::max(errors.weight, RelativeError(compact.weightSum, full.weightSum));
+
+        const float2 compactUV = RTXDI_GetDIReservoirSampleUV(compact);
+        const float2 fullUV = RTXDI_GetDIReservoirSampleUV(full);
+        errors.uv = std::max(errors.uv, std::max(std::abs(compactUV.x - fullUV.x), std::abs(compactUV.y - fullUV.y)));
+
+        for (uint channel = 0; channel < 3; channel++)
+        {
+            const int difference = int(VisibilityChannel(compact.packedVisibility, channel)) - int(VisibilityChannel(full.packedVisibility, channel));
+            errors.visibility = std::max(errors.visibility, uint(std::abs(difference)));
+        }
+
+        if (compact.lightData != full.lightData ||
+            compact.M != full.M ||
+            compact.spatialDistance.x != full.spatialDistance.x ||
+            compact.spatialDistance.y != full.spatialDistance.y ||
+            compact.age != full.age)
+        {
+            errors.mismatches++;
+        }
+    }
+
+    void TestRoundTrip()
+    {
+        const RTXDI_ReservoirBufferParameters reservoirParams = rtxdi::CalculateReservoirBufferParameters(
+            c_viewSize, c_viewSize, rtxdi::CheckerboardMode::Off);
+        g_lightReservoirs.resize(reservoirParams.reservoirArrayPitch);
+
+        std::mt19937 rng(1);
+        Errors errors;
+        for (int i = 0; i < c_reservoirCount; i++)
+        {
+            const RTXDI_DIReservoir reservoir = RandomReservoir(rng);
+            const uint2 position = uint2(uint(i) % c_viewSize, (uint(i) / c_viewSize) % c_viewSize);
+
+            RTXDI_StoreDIReservoir(reservoir, reservoirParams, position, 0);
+            const RTXDI_DIReservoir compact = RTXDI_LoadDIReservoir(reservoirParams, position, 0);
+            const RTXDI_DIReservoir full = RTXDI_UnpackDIReservoir(RTXDI_PackDIReservoir(reservoir));
+
+            CompareWithFullFormat(compact, full, errors);
+        }
+
+        printf("Round trip of %d reservoirs: targetPdf rel. error %.2e, weight rel. error %.2e, UV error %.2e, "
+            "visibility error %u/63, integer field mismatches %d\n",
+            c_reservoirCount, errors.targetPdf, errors.weight, errors.uv, errors.visibility, errors.mismatches);
+
+        Check(errors.targetPdf <= c_maxHalfRelativeError, "targetPdf within half precision");
+        Check(errors.weight <= c_maxHalfRelativeError, "weight within half precision");
+        Check(errors.uv <= c_maxUVError, "UV within 12 bits");
+        Check(errors.visibility <= 1, "visibility within 5 bits");
+        Check(errors.mismatches == 0, "light index, M, spatial distance and age are exact in range");
+    }
+
+    void TestClamping()
+    {
+        RTXDI_DIReservoir reservoir = RTXDI_EmptyDIReservoir();
+        reservoir.lightData = 17 | RTXDI_DIReservoir_LightValidBit;
+        reservoir.targetPdf = 1e6f;
+        reservoir.weightSum = 1e9f;
+        reservoir.M = 1000.f;
+        reservoir.spatialDistance = int2(100, -100);
+        reservoir.age = 100;
+
+        const RTXDI_DIReservoir compact = RTXDI_UnpackCompactDIReservoir(RTXDI_PackCompactDIReservoir(reservoir));
+        Check(compact.targetPdf == RTXDI_CompactDIReservoir_MaxHalf, "targetPdf clamps to the largest half");
+        Check(compact.weightSum == RTXDI_CompactDIReservoir_MaxHalf, "weight clamps to the largest half");
+        Check(compact.M == float(RTXDI_CompactDIReservoir_MaxM), "M clamps to RTXDI_CompactDIReservoir_MaxM");
+        Check(compact.spatialDistance.x == RTXDI_CompactDIReservoir_MaxDistance &&
+            compact.spatialDistance.y == -RTXDI_CompactDIReservoir_MaxDistance, "spatial distance clamps to the channel range");
+        Check(compact.age == RTXDI_CompactDIReservoir_MaxAge, "age clamps to RTXDI_CompactDIReservoir_MaxAge");
+        Check(RTXDI_GetDIReservoirLightIndex(compact) == 17 && RTXDI_IsValidDIReservoir(compact), "light index survives clamping");
+
+        const RTXDI_DIReservoir empty = RTXDI_UnpackCompactDIReservoir(RTXDI_PackCompactDIReservoir(RTXDI_EmptyDIReservoir()));
+        Check(!RTXDI_IsValidDIReservoir(empty) && empty.M == 0.f && empty.weightSum == 0.f, "empty reservoir stays empty");
+    }
+
+    void TestSizes()
+    {
+        Check(sizeof(RTXDI_CompactDIReservoir) == 16, "RTXDI_CompactDIReservoir is 16 bytes");
+        Check(rtxdi::GetDIReservoirSizeInBytes(rtxdi::DIReservoirFormat::Compact) == 16, "host reports 16 bytes for the compact format");
+        Check(rtxdi::GetDIReservoirSizeInBytes(rtxdi::DIReservoirFormat::Packed) == 24, "host reports 24 bytes for the full format");
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestClamping();
+    TestSizes();
+
+    if (g_failures == 0)
+        printf("Compact DI reservoir test passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}
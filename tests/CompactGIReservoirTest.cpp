@@ -0,0 +1,141 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Accuracy of the compact GI reservoir format (RTXDI_COMPACT_GI_RESERVOIR), which stores the sample position
+// relative to the receiving surface. Random samples at distances from 0.1 to 1000 are stored and loaded through
+// the reservoir buffer, and the Jacobian of RTXDI_CalculateJacobian for reuse at a nearby receiver is compared
+// between the decoded and the original sample.
+
+#define RTXDI_COMPACT_GI_RESERVOIR 1
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+#include <rtxdi/GIResamplingFunctions.hlsli>
+
+#include <rtxdi/RtxdiUtils.h>
+
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    const int c_samplesPerScale = 200000;
+    const int c_viewSize = 64;
+
+    // Relative to the sample distance
+    const float c_maxPositionError = 1e-3f;
+    const float c_maxNormalError = 1e-4f;
+    const float c_maxJacobianRelativeError = 1e-3f;
+    const float c_maxMeanJacobianRelativeError = 1e-4f;
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    float3 RandomDirection(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        float3 v;
+        do
+        {
+            v = float3(u(rng), u(rng), u(rng));
+        } while (dot(v, v) > 1.f || dot(v, v) < 1e-3f);
+        return normalize(v);
+    }
+
+    void TestScale(float scale, const RTXDI_ReservoirBufferParameters& reservoirParams, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        float maxPositionError = 0.f;
+        float maxNormalError = 0.f;
+        double sumJacobianError = 0.0;
+        float maxJacobianError = 0.f;
+        int jacobianCount = 0;
+        int fieldMismatches = 0;
+
+        for (int i = 0; i < c_samplesPerScale; i++)
+        {
+            const float3 receiver = float3(u(rng) - 0.5f, u(rng) - 0.5f, u(rng) - 0.5f) * 200.f;
+            const float3 direction = RandomDirection(rng);
+            const float distance = scale * (0.5f + u(rng));
+
+            // Sample surfaces facing the receiver, away from grazing angles where the Jacobian is ill-conditioned
+            RTXDI_GIReservoir reservoir = RTXDI_EmptyGIReservoir();
+            reservoir.position = receiver + direction * distance;
+            reservoir.normal = normalize(-direction + RandomDirection(rng) * 0.7f);
+            if (dot(reservoir.normal, -direction) < 0.2f)
+                continue;
+            reservoir.radiance = float3(u(rng), u(rng), u(rng));
+            reservoir.weightSum = u(rng) * 10.f;
+            reservoir.M = 1 + (i % 30);
+            reservoir.age = i % 20;
+
+            const uint2 position = uint2(uint(i) % c_viewSize, (uint(i) / c_viewSize) % c_viewSize);
+            RTXDI_StoreGIReservoirAtSurface(reservoir, receiver, reservoirParams, position, 0);
+            const RTXDI_GIReservoir decoded = RTXDI_LoadGIReservoirAtSurface(reservoirParams, position, 0, receiver);
+
+            maxPositionError = std::max(maxPositionError, length(decoded.position - reservoir.position) / distance);
+            maxNormalError = std::max(maxNormalError, length(decoded.normal - reservoir.normal));
+            if (decoded.M != reservoir.M || decoded.age != reservoir.age || decoded.weightSum != reservoir.weightSum)
+                fieldMismatches++;
+
+            // Reuse of the sample at a neighbor receiver within a tenth of the sample distance
+            const float3 neighborReceiver = receiver + RandomDirection(rng) * (distance * 0.1f);
+            const float reference = RTXDI_CalculateJacobian(neighborReceiver, receiver, reservoir);
+            if (reference <= 0.f)
+                continue;
+
+            const float jacobianError = std::abs(RTXDI_CalculateJacobian(neighborReceiver, receiver, decoded) - reference) / reference;
+            sumJacobianError += jacobianError;
+            maxJacobianError = std::max(maxJacobianError, jacobianError);
+            jacobianCount++;
+        }
+
+        const float meanJacobianError = jacobianCount > 0 ? float(sumJacobianError / jacobianCount) : 0.f;
+        printf("Distance ~%g: position error %.2e of distance, normal error %.2e, Jacobian rel. error mean %.2e max %.2e (%d samples), field mismatches %d\n",
+            scale, maxPositionError, maxNormalError, meanJacobianError, maxJacobianError, jacobianCount, fieldMismatches);
+
+        Check(jacobianCount > c_samplesPerScale / 2, "most samples have a valid Jacobian");
+        Check(maxPositionError <= c_maxPositionError, "position error within bounds");
+        Check(maxNormalError <= c_maxNormalError, "normal error within bounds");
+        Check(maxJacobianError <= c_maxJacobianRelativeError, "max Jacobian error within bounds");
+        Check(meanJacobianError <= c_maxMeanJacobianRelativeError, "mean Jacobian error within bounds");
+        Check(fieldMismatches == 0, "weight, M and age are exact");
+    }
+}
+
+int main()
+{
+    const RTXDI_ReservoirBufferParameters reservoirParams = rtxdi::CalculateReservoirBufferParameters(
+        c_viewSize, c_viewSize, rtxdi::CheckerboardMode::Off);
+    g_giReservoirs.resize(reservoirParams.reservoirArrayPitch);
+
+    std::mt19937 rng(7);
+    for (float scale : { 0.1f, 1.f, 10.f, 100.f, 1000.f })
+        TestScale(scale, reservoirParams, rng);
+
+    Check(sizeof(RTXDI_CompactGIReservoir) == 20, "RTXDI_CompactGIReservoir is 20 bytes");
+    Check(rtxdi::GetGIReservoirSizeInBytes(rtxdi::GIReservoirFormat::Compact) == 20, "host reports 20 bytes for the compact format");
+
+    if (g_failures == 0)
+        printf("Compact GI reservoir test passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Compiles every resampling header as C++ against the stub bridge. tests/CMakeLists.txt builds this file once
+// per shader configuration (ReGIR modes, reservoir formats and layouts, optional resources), so that changes
+// to the headers or to RtxdiHostTypes.h that break the host build fail here.
+// The program also runs a small spatial resampling pass through the bridge as a smoke test.
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+#include <rtxdi/PresamplingFunctions.hlsli>
+#include <rtxdi/InitialSamplingFunctions.hlsli>
+#include <rtxdi/DIResamplingFunctions.hlsli>
+#include <rtxdi/DIMultiReservoir.hlsli>
+#include <rtxdi/GIResamplingFunctions.hlsli>
+
+#include <rtxdi/RtxdiUtils.h>
+
+#include <cstdio>
+
+namespace
+{
+    const int c_viewSize = 32;
+    const uint c_lightCount = 16;
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    void CreateScene()
+    {
+        g_viewSize = int2(c_viewSize, c_viewSize);
+        g_surfaces.resize(c_viewSize * c_viewSize);
+        for (int y = 0; y < c_viewSize; y++)
+        {
+            for (int x = 0; x < c_viewSize; x++)
+            {
+                RAB_Surface& surface = g_surfaces[y * c_viewSize + x];
+                surface.worldPos = float3(float(x), 0.f, float(y)) * 0.1f;
+                surface.normal = float3(0.f, 1.f, 0.f);
+                surface.linearDepth = 1.f;
+                surface.valid = true;
+            }
+        }
+
+        g_lights.resize(c_lightCount);
+        for (uint i = 0; i < c_lightCount; i++)
+        {
+            g_lights[i].position = float3(float(i % 4), 1.f, float(i / 4));
+            g_lights[i].radiance = float3(1.f + float(i));
+        }
+
+        std::vector<uint8_t> neighborOffsets(8192 * 2);
+        rtxdi::FillNeighborOffsetBuffer(neighborOffsets.data(), 8192);
+        RTXDI_HostLoadNeighborOffsets(neighborOffsets.data(), 8192);
+
+        g_counters = std::vector<std::atomic<uint>>(RTXDI_COUNTER_COUNT);
+    }
+}
+
+int main()
+{
+    CreateScene();
+
+#if RTXDI_SOA_DI_RESERVOIR
+    const uint diPlaneCount = RTXDI_DI_RESERVOIR_PLANE_COUNT;
+#else
+    const uint diPlaneCount = 1;
+#endif
+    const RTXDI_ReservoirBufferParameters reservoirParams = rtxdi::CalculateReservoirBufferParameters(
+        c_viewSize, c_viewSize, rtxdi::CheckerboardMode::Off, diPlaneCount);
+    g_lightReservoirs.resize(size_t(reservoirParams.reservoirArrayPitch) * 2);
+
+    // Initial samples: one light per pixel, streamed like RTXDI_SampleLocalLights does
+    for (int y = 0; y < c_viewSize; y++)
+    {
+        for (int x = 0; x < c_viewSize; x++)
+        {
+            const uint2 pixelPosition = uint2(x, y);
+            RAB_RandomSamplerState rng = RTXDI_HostInitRandomSampler(uint(y * c_viewSize + x));
+            const RAB_Surface surface = RAB_GetGBufferSurface(int2(pixelPosition), false);
+
+            const uint lightIndex = min(uint(RAB_GetNextRandom(rng) * c_lightCount), c_lightCount - 1);
+            const RAB_LightSample lightSample = RAB_SamplePolymorphicLight(RAB_LoadLightInfo(lightIndex, false), surface, float2(0.f));
+
+            RTXDI_DIReservoir reservoir = RTXDI_EmptyDIReservoir();
+            RTXDI_StreamSample(reservoir, lightIndex, float2(0.f), RAB_GetNextRandom(rng),
+                RAB_GetLightSampleTargetPdfForSurface(lightSample, surface), float(c_lightCount));
+            RTXDI_FinalizeResampling(reservoir, 1.0, reservoir.M);
+            reservoir.M = 1;
+            RTXDI_StoreDIReservoir(reservoir, reservoirParams, pixelPosition, 0);
+        }
+    }
+
+    // Parameters with a zero addressing field, as filled by code predating it, address the default layout
+    RTXDI_ReservoirBufferParameters legacyReservoirParams = reservoirParams;
+    legacyReservoirParams.reservoirAddressing = 0;
+    bool legacyAddressingMatches = rtxdi::GetReservoirBlockSize(legacyReservoirParams) == RTXDI_RESERVOIR_BLOCK_SIZE;
+    for (uint i = 0; i < uint(c_viewSize * c_viewSize); i++)
+    {
+        const uint2 reservoirPosition = uint2(i % c_viewSize, i / c_viewSize);
+        legacyAddressingMatches = legacyAddressingMatches &&
+            RTXDI_ReservoirPositionToPointer(legacyReservoirParams, reservoirPosition, 1) == RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPosition, 1);
+    }
+    Check(legacyAddressingMatches, "zero reservoir addressing decodes to the default 16x16 row-major layout");
+
+    const uint2 centerPixel = uint2(c_viewSize / 2, c_viewSize / 2);
+    const RTXDI_DIReservoir centerSample = RTXDI_LoadDIReservoir(reservoirParams, centerPixel, 0);
+    Check(RTXDI_IsValidDIReservoir(centerSample), "stored DI reservoir loads back as valid");
+
+    RTXDI_RuntimeParameters runtimeParams = {};
+    runtimeParams.neighborOffsetMask = uint(g_neighborOffsets.size()) - 1;
+    runtimeParams.prevFrameScaleX = 1.f;
+    runtimeParams.prevFrameScaleY = 1.f;
+
+    RTXDI_DISpatialResamplingParameters sparams = {};
+    sparams.sourceBufferIndex = 0;
+    sparams.numSamples = 8;
+    sparams.numDisocclusionBoostSamples = 8;
+    sparams.targetHistoryLength = 20;
+    sparams.biasCorrectionMode = RTXDI_BIAS_CORRECTION_BASIC;
+    sparams.samplingRadius = 8.f;
+    sparams.depthThreshold = 0.1f;
+    sparams.normalThreshold = 0.5f;
+
+    RAB_RandomSamplerState rng = RTXDI_HostInitRandomSampler(12345);
+    RAB_LightSample selectedLightSample = RAB_EmptyLightSample();
+    const RTXDI_DIReservoir spatialResult = RTXDI_DISpatialResampling(centerPixel, RAB_GetGBufferSurface(int2(centerPixel), false),
+        centerSample, rng, runtimeParams, reservoirParams, sparams, selectedLightSample);
+
+    Check(RTXDI_IsValidDIReservoir(spatialResult), "spatial resampling returns a valid reservoir");
+    Check(RTXDI_GetDIReservoirLightIndex(spatialResult) < c_lightCount, "spatial resampling selects an existing light");
+    Check(spatialResult.M > centerSample.M, "spatial resampling reuses neighbors");
+    Check(spatialResult.weightSum > 0.f && isfinite(spatialResult.weightSum), "spatial resampling weight is positive and finite");
+
+    if (g_failures == 0)
+        printf("Host compile check passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Variance of the multi-sample DI reservoirs (DIMultiReservoir.hlsli) against the single-sample reservoirs,
+// over the frames of temporal reuse at one pixel. tests/CMakeLists.txt builds this file once per
+// RTXDI_DI_MULTI_RESERVOIR_SAMPLES value.
+// The pixel sees 32 lights, 4 of them bright, and every other light is occluded. The target PDF is the
+// unshadowed contribution, so the selection can't tell the occluded lights apart, which is where several
+// samples per reservoir help. Each frame streams 4 uniform candidates and combines them with the previous
+// frame's reservoir, whose history is capped at 20 frames, with 1/M normalization.
+// Reported: mean and relative variance of the shaded estimate over independent trials, per frame.
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+#include <rtxdi/DIMultiReservoir.hlsli>
+
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    const uint c_lightCount = 32;
+    const uint c_candidates = 4;
+    const uint c_frames = 32;
+    const uint c_trials = 20000;
+    const float c_maxHistoryLength = 20.f;
+
+    float g_contribution[c_lightCount];
+    float g_visibility[c_lightCount];
+
+    struct Statistics
+    {
+        double sum[c_frames] = {};
+        double sumSquares[c_frames] = {};
+
+        void add(uint frame, double estimate)
+        {
+            sum[frame] += estimate;
+            sumSquares[frame] += estimate * estimate;
+        }
+
+        void print(const char* name) const
+        {
+            printf("  %-10s", name);
+            for (uint frame : { 0, 1, 3, 7, 15, 31 })
+            {
+                const double mean = sum[frame] / c_trials;
+                const double variance = sumSquares[frame] / c_trials - mean * mean;
+                printf("  %6.3f %5.2f", mean, variance / (mean * mean));
+            }
+            printf("\n");
+        }
+    };
+
+    float TargetPdf(const RTXDI_DIReservoir& reservoir)
+    {
+        return RTXDI_IsValidDIReservoir(reservoir) ? g_contribution[RTXDI_GetDIReservoirLightIndex(reservoir)] : 0.f;
+    }
+
+    float Shade(const RTXDI_DIReservoir& reservoir)
+    {
+        return TargetPdf(reservoir) * g_visibility[RTXDI_GetDIReservoirLightIndex(reservoir)];
+    }
+
+    void ClampHistory(RTXDI_DIReservoir& reservoir)
+    {
+        reservoir.M = std::min(reservoir.M, c_maxHistoryLength);
+    }
+
+    void RunSingleSample(std::mt19937& rng, Statistics& statistics)
+    {
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+        for (uint trial = 0; trial < c_trials; trial++)
+        {
+            RTXDI_DIReservoir previous = RTXDI_EmptyDIReservoir();
+            for (uint frame = 0; frame < c_frames; frame++)
+            {
+                RTXDI_DIReservoir initial = RTXDI_EmptyDIReservoir();
+                for (uint c = 0; c < c_candidates; c++)
+                {
+                    const uint lightIndex = std::min(uint(u(rng) * c_lightCount), c_lightCount - 1);
+                    RTXDI_StreamSample(initial, lightIndex, float2(0.f), u(rng), g_contribution[lightIndex], float(c_lightCount));
+                }
+                RTXDI_FinalizeResampling(initial, 1.f, initial.M);
+                initial.M = 1;
+
+                RTXDI_DIReservoir state = RTXDI_EmptyDIReservoir();
+                RTXDI_CombineDIReservoirs(state, initial, u(rng), initial.targetPdf);
+                ClampHistory(previous);
+                RTXDI_CombineDIReservoirs(state, previous, u(rng), TargetPdf(previous));
+                RTXDI_FinalizeResampling(state, 1.f, state.M);
+                previous = state;
+
+                statistics.add(frame, RTXDI_IsValidDIReservoir(state) ? Shade(state) * RTXDI_GetDIReservoirInvPdf(state) : 0.f);
+            }
+        }
+    }
+
+    void RunMultiSample(std::mt19937& rng, Statistics& statistics)
+    {
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+        float targetPdf[RTXDI_DI_MULTI_RESERVOIR_SAMPLES];
+        for (uint trial = 0; trial < c_trials; trial++)
+        {
+            RTXDI_DIMultiReservoir previous = RTXDI_EmptyDIMultiReservoir();
+            for (uint frame = 0; frame < c_frames; frame++)
+            {
+                RTXDI_DIMultiReservoir initial = RTXDI_EmptyDIMultiReservoir();
+                for (uint c = 0; c < c_candidates; c++)
+                {
+                    const uint lightIndex = std::min(uint(u(rng) * c_lightCount), c_lightCount - 1);
+                    RTXDI_StreamDIMultiSample(initial, lightIndex, float2(0.f), u(rng), g_contribution[lightIndex], float(c_lightCount));
+                }
+                for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; i++)
+                {
+                    RTXDI_FinalizeResampling(initial.samples[i], 1.f, initial.samples[i].M);
+                    initial.samples[i].M = 1;
+                }
+
+                RTXDI_DIMultiReservoir state = RTXDI_EmptyDIMultiReservoir();
+                for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; i++)
+                    targetPdf[i] = initial.samples[i].targetPdf;
+                RTXDI_CombineDIMultiReservoirs(state, initial, u(rng), targetPdf);
+                for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; i++)
+                {
+                    ClampHistory(previous.samples[i]);
+                    targetPdf[i] = TargetPdf(previous.samples[i]);
+                }
+                RTXDI_CombineDIMultiReservoirs(state, previous, u(rng), targetPdf);
+                for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; i++)
+                    RTXDI_FinalizeResampling(state.samples[i], 1.f, state.samples[i].M);
+                previous = state;
+
+                double estimate = 0.0;
+                for (uint i = 0; i < RTXDI_DI_MULTI_RESERVOIR_SAMPLES; i++)
+                {
+                    if (RTXDI_IsValidDIReservoir(state.samples[i]))
+                        estimate += Shade(state.samples[i]) * RTXDI_GetDIMultiReservoirSampleWeight(state, i);
+                }
+                statistics.add(frame, estimate);
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    double exact = 0.0;
+    for (uint i = 0; i < c_lightCount; i++)
+    {
+        g_contribution[i] = i < 4 ? 1.f : 0.05f * u(rng);
+        g_visibility[i] = float(i & 1);
+        exact += g_contribution[i] * g_visibility[i];
+    }
+
+    Statistics singleSample;
+    Statistics multiSample;
+    RunSingleSample(rng, singleSample);
+    RunMultiSample(rng, multiSample);
+
+    printf("%u lights, %u candidates per frame, history capped at %g frames, %u trials, exact %.3f\n",
+        c_lightCount, c_candidates, c_maxHistoryLength, c_trials, exact);
+    printf("  mean, relative variance at frame 1, 2, 4, 8, 16, 32\n");
+    singleSample.print("1-sample");
+    char name[16];
+    snprintf(name, sizeof(name), "k = %d", RTXDI_DI_MULTI_RESERVOIR_SAMPLES);
+    multiSample.print(name);
+
+    return 0;
+}
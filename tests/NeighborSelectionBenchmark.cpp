@@ -0,0 +1,152 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Memory access trace of the spatial neighbor fetches for each RTXDI_NEIGHBOR_SELECTION_MODE.
+// A 32-lane wave covers 8x4 pixels in 2x2 quads, as in a compute shader with 8x4 or 8x8 thread groups.
+// The host has no lanes, so the sharing of the start index done by WaveReadLaneFirst and QuadReadLaneAt
+// in RTXDI_GetNeighborSampleStartIndex is emulated here. The offsets go through RTXDI_RotateNeighborOffset,
+// built with RTXDI_NEIGHBOR_SELECTION_PER_WAVE; the per-quad rotation of RTXDI_NEIGHBOR_ROTATION_PER_QUAD
+// is obtained by passing the quad position instead of the pixel position.
+// Reported: distinct 128-byte lines per wave and per neighbor, for a 4-byte row-major G-buffer channel and
+// for 24-byte reservoirs in 16x16 blocks.
+
+#define RTXDI_NEIGHBOR_SELECTION_MODE RTXDI_NEIGHBOR_SELECTION_PER_WAVE
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+
+#include <rtxdi/RtxdiUtils.h>
+
+#include <cstdio>
+#include <unordered_set>
+
+namespace
+{
+    const int c_renderWidth = 1920;
+    const int c_renderHeight = 1080;
+    const uint c_cacheLineSize = 128;
+    const uint c_gbufferTexelSize = 4;
+    const uint c_neighborOffsetCount = 8192;
+    const uint c_neighborSamples = 4;
+    const uint c_waveSize = 32;
+
+    enum class StartSharing
+    {
+        None,
+        Wave,
+        Quad
+    };
+
+    enum class Rotation
+    {
+        None,
+        PerPixel,
+        PerQuad
+    };
+
+    struct Configuration
+    {
+        StartSharing sharing;
+        Rotation rotation;
+        const char* name;
+    };
+
+    void Trace(const Configuration& configuration, float radius, const RTXDI_ReservoirBufferParameters& reservoirParams)
+    {
+        const uint neighborOffsetMask = c_neighborOffsetCount - 1;
+        const uint reservoirSize = rtxdi::GetDIReservoirSizeInBytes(rtxdi::DIReservoirFormat::Packed);
+
+        std::unordered_set<uint64_t> gbufferLines;
+        std::unordered_set<uint64_t> reservoirLines;
+        uint64_t totalGBufferLines = 0;
+        uint64_t totalReservoirLines = 0;
+        uint waveCount = 0;
+
+        for (int waveY = 0; waveY + 4 <= c_renderHeight; waveY += 4)
+        {
+            for (int waveX = 0; waveX + 8 <= c_renderWidth; waveX += 8)
+            {
+                uint2 pixelPositions[c_waveSize];
+                uint startIndices[c_waveSize];
+                for (uint lane = 0; lane < c_waveSize; lane++)
+                {
+                    const uint quad = lane >> 2;
+                    const uint quadLane = lane & 3;
+                    pixelPositions[lane] = uint2(waveX + (quad & 3) * 2 + (quadLane & 1), waveY + (quad >> 2) * 2 + (quadLane >> 1));
+
+                    RAB_RandomSamplerState rng = RTXDI_HostInitRandomSampler(pixelPositions[lane].y * c_renderWidth + pixelPositions[lane].x);
+                    startIndices[lane] = RTXDI_GetNeighborSampleStartIndex(RAB_GetNextRandom(rng), neighborOffsetMask);
+
+                    if (configuration.sharing == StartSharing::Wave)
+                        startIndices[lane] = startIndices[0];
+                    else if (configuration.sharing == StartSharing::Quad)
+                        startIndices[lane] = startIndices[lane & ~3u];
+                }
+
+                for (uint i = 0; i < c_neighborSamples; i++)
+                {
+                    gbufferLines.clear();
+                    reservoirLines.clear();
+                    for (uint lane = 0; lane < c_waveSize; lane++)
+                    {
+                        const uint2 pixelPosition = pixelPositions[lane];
+                        const uint sampleIdx = (startIndices[lane] + i) & neighborOffsetMask;
+                        int2 offset = int2(g_neighborOffsets[sampleIdx] * radius);
+                        if (configuration.rotation == Rotation::PerPixel)
+                            offset = RTXDI_RotateNeighborOffset(offset, pixelPosition);
+                        else if (configuration.rotation == Rotation::PerQuad)
+                            offset = RTXDI_RotateNeighborOffset(offset, pixelPosition >> 1);
+
+                        const int2 neighbor = RAB_ClampSamplePositionIntoView(int2(pixelPosition) + offset, false);
+                        gbufferLines.insert((uint64_t(neighbor.y) * c_renderWidth + neighbor.x) * c_gbufferTexelSize / c_cacheLineSize);
+                        reservoirLines.insert(uint64_t(RTXDI_ReservoirPositionToPointer(reservoirParams, uint2(neighbor), 0)) * reservoirSize / c_cacheLineSize);
+                    }
+                    totalGBufferLines += gbufferLines.size();
+                    totalReservoirLines += reservoirLines.size();
+                }
+                waveCount++;
+            }
+        }
+
+        const double samples = double(waveCount) * c_neighborSamples;
+        printf("  %-28s G-buffer %5.1f  reservoirs %5.1f\n", configuration.name, totalGBufferLines / samples, totalReservoirLines / samples);
+    }
+}
+
+int main()
+{
+    g_viewSize = int2(c_renderWidth, c_renderHeight);
+    std::vector<uint8_t> neighborOffsets(c_neighborOffsetCount * 2);
+    rtxdi::FillNeighborOffsetBuffer(neighborOffsets.data(), c_neighborOffsetCount);
+    RTXDI_HostLoadNeighborOffsets(neighborOffsets.data(), c_neighborOffsetCount);
+
+    const RTXDI_ReservoirBufferParameters reservoirParams = rtxdi::CalculateReservoirBufferParameters(
+        c_renderWidth, c_renderHeight, rtxdi::CheckerboardMode::Off);
+
+    const Configuration configurations[] = {
+        { StartSharing::None, Rotation::None, "per-pixel" },
+        { StartSharing::Wave, Rotation::None, "per-wave, no rotation" },
+        { StartSharing::Wave, Rotation::PerPixel, "per-wave" },
+        { StartSharing::Wave, Rotation::PerQuad, "per-wave, per-quad rotation" },
+        { StartSharing::Quad, Rotation::PerPixel, "per-quad" },
+        { StartSharing::Quad, Rotation::PerQuad, "per-quad, per-quad rotation" } };
+
+    printf("%dx%d, 32-lane waves of 8x4 pixels, distinct %u-byte lines per wave and neighbor\n", c_renderWidth, c_renderHeight, c_cacheLineSize);
+    for (float radius : { 8.f, 32.f })
+    {
+        printf("Radius %g:\n", radius);
+        for (const Configuration& configuration : configurations)
+            Trace(configuration, radius, reservoirParams);
+    }
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Microbenchmark of the two onion paths of RTXDI_ReGIR_CellIndexToWorldPos: the analytic one, and the one that
+// reads the cell table of ReGIROnionCalculatedParameters::regirOnionCellTable through RTXDI_REGIR_ONION_CELL_BUFFER.
+// ReGIRSampling.hlsli is included twice, in two namespaces, with and without the cell buffer.
+// The program first checks that both paths agree on every cell, then times them on a single thread.
+// RTXDI_ReGIR_WorldPosToCellIndex has no table path and is timed for reference.
+
+#define RTXDI_REGIR_MODE RTXDI_REGIR_ONION
+
+#include <rtxdi/RtxdiHostTypes.h>
+#include <rtxdi/ReGIR.h>
+#include <rtxdi/RISBufferSegmentAllocator.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+std::vector<float4> g_onionCells;
+
+namespace analytic
+{
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/ReGIRSampling.hlsli>
+}
+
+namespace table
+{
+#define RTXDI_REGIR_ONION_CELL_BUFFER g_onionCells
+#undef RTXDI_REGIR_SAMPLING_FUNCTIONS_HLSLI
+#undef RTXDI_MATH_HLSLI
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/ReGIRSampling.hlsli>
+}
+
+namespace
+{
+    const int c_iterations = 64;
+    const uint c_positionCount = 1 << 20;
+
+    // Both paths use float math, the differences come from the order of operations
+    const float c_maxCenterError = 1e-3f;
+    const float c_maxRadiusError = 1e-3f;
+
+    typedef bool (*CellIndexToWorldPosFunction)(ReGIR_Parameters, int, float3&, float&);
+
+    double TimeCellIndexToWorldPos(CellIndexToWorldPosFunction function, const ReGIR_Parameters& params, int cellCount)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        float sum = 0.f;
+        for (int iteration = 0; iteration < c_iterations; iteration++)
+        {
+            for (int cellIndex = 0; cellIndex < cellCount; cellIndex++)
+            {
+                float3 center;
+                float radius;
+                function(params, cellIndex, center, radius);
+                sum += center.x + radius;
+            }
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        // Keeps the calls from being optimized away
+        volatile float sink = sum;
+        (void)sink;
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / (double(c_iterations) * cellCount);
+    }
+}
+
+int main()
+{
+    rtxdi::ReGIRStaticParameters staticParams;
+    rtxdi::RISBufferSegmentAllocator risBufferSegmentAllocator;
+    rtxdi::ReGIRContext context(staticParams, risBufferSegmentAllocator);
+
+    rtxdi::ReGIRDynamicParameters dynamicParams;
+    dynamicParams.center = { 3.f, 1.f, -2.f };
+    context.setDynamicParameters(dynamicParams);
+
+    ReGIR_Parameters params = {};
+    context.fillReGIRParameters(params);
+    for (const rtxdi::ReGIROnionCell& cell : context.getReGIROnionCalculatedParameters().regirOnionCellTable)
+        g_onionCells.push_back(float4(cell.center.x, cell.center.y, cell.center.z, cell.radius));
+    const int cellCount = int(params.onionParams.numCells);
+
+    // Both paths must agree on every cell, and on the invalid indices just outside the table
+    float maxCenterError = 0.f;
+    float maxRadiusError = 0.f;
+    int mismatches = 0;
+    for (int cellIndex = -1; cellIndex <= cellCount; cellIndex++)
+    {
+        float3 analyticCenter, tableCenter;
+        float analyticRadius, tableRadius;
+        const bool analyticValid = analytic::RTXDI_ReGIR_CellIndexToWorldPos(params, cellIndex, analyticCenter, analyticRadius);
+        const bool tableValid = table::RTXDI_ReGIR_CellIndexToWorldPos(params, cellIndex, tableCenter, tableRadius);
+        if (analyticValid != tableValid)
+        {
+            mismatches++;
+            continue;
+        }
+        if (!analyticValid)
+            continue;
+
+        maxCenterError = std::max(maxCenterError, length(analyticCenter - tableCenter));
+        maxRadiusError = std::max(maxRadiusError, std::abs(analyticRadius - tableRadius));
+    }
+    printf("%d onion cells: %d validity mismatches, max center error %.2e, max radius error %.2e\n", cellCount, mismatches, maxCenterError, maxRadiusError);
+
+    const double analyticTime = TimeCellIndexToWorldPos(analytic::RTXDI_ReGIR_CellIndexToWorldPos, params, cellCount);
+    const double tableTime = TimeCellIndexToWorldPos(table::RTXDI_ReGIR_CellIndexToWorldPos, params, cellCount);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(-200.f, 200.f);
+    std::vector<float3> positions(c_positionCount);
+    for (float3& position : positions)
+        position = float3(u(rng), u(rng) * 0.1f, u(rng));
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    int cellIndexSum = 0;
+    for (const float3& position : positions)
+        cellIndexSum += analytic::RTXDI_ReGIR_WorldPosToCellIndex(params, position);
+    const auto end = std::chrono::high_resolution_clock::now();
+    volatile int sink = cellIndexSum;
+    (void)sink;
+    const double worldPosToCellIndexTime = std::chrono::duration<double, std::nano>(end - start).count() / c_positionCount;
+
+    printf("CellIndexToWorldPos: analytic %.1f ns, table %.1f ns (%.1fx)\n", analyticTime, tableTime, analyticTime / tableTime);
+    printf("WorldPosToCellIndex: analytic %.1f ns\n", worldPosToCellIndexTime);
+
+    const bool passed = mismatches == 0 && maxCenterError <= c_maxCenterError && maxRadiusError <= c_maxRadiusError;
+    if (!passed)
+        printf("FAILED: the table path doesn't match the analytic path\n");
+
+    return passed ? 0 : 1;
+}
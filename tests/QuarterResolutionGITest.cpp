@@ -0,0 +1,193 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Quarter-resolution GI reservoirs (ReSTIRGI_ReservoirResolution::Quarter) on a render size that isn't a multiple
+// of the quad size. The test checks that ReSTIRGIContext turns checkerboard sampling off for them, that
+// RTXDI_GIPixelPosToReservoirPos, RTXDI_GIReservoirPosToPixelPos and RTXDI_ActivateGIReservoirPixel agree on one
+// reservoir per 2x2 quad, and that RTXDI_GIUpsampleReservoir gives every pixel a sample from one of the quads
+// around it without crossing a depth discontinuity.
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+#include <rtxdi/GIResamplingFunctions.hlsli>
+
+#include <rtxdi/ReSTIRGI.h>
+
+#include <cstdio>
+#include <set>
+
+namespace
+{
+    const uint c_renderWidth = 37;
+    const uint c_renderHeight = 29;
+    // Even, so that no quad straddles the discontinuity
+    const int c_discontinuityX = 18;
+    const float c_nearDepth = 5.f;
+    const float c_farDepth = 50.f;
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    // Two planes facing the camera, at different depths on either side of the discontinuity
+    RAB_Surface SceneSurface(int2 pixelPosition)
+    {
+        const float depth = pixelPosition.x < c_discontinuityX ? c_nearDepth : c_farDepth;
+        RAB_Surface surface;
+        surface.worldPos = float3(float(pixelPosition.x) + 0.5f, float(pixelPosition.y) + 0.5f, depth);
+        surface.normal = float3(0.f, 0.f, -1.f);
+        surface.linearDepth = depth;
+        surface.valid = true;
+        return surface;
+    }
+
+    void TestContext()
+    {
+        rtxdi::ReSTIRGIStaticParameters staticParams;
+        staticParams.RenderWidth = c_renderWidth;
+        staticParams.RenderHeight = c_renderHeight;
+        staticParams.CheckerboardSamplingMode = rtxdi::CheckerboardMode::Black;
+        staticParams.ReservoirResolution = rtxdi::ReSTIRGI_ReservoirResolution::Quarter;
+        rtxdi::ReSTIRGIContext context(staticParams);
+
+        Check(context.getStaticParams().CheckerboardSamplingMode == rtxdi::CheckerboardMode::Off, "quarter resolution turns checkerboard sampling off");
+        Check(RTXDI_GetReservoirDownscaleLog2(context.getReservoirBufferParameters()) == 1, "quarter-resolution reservoir buffer covers 2x2 pixels per reservoir");
+
+        staticParams.ReservoirResolution = rtxdi::ReSTIRGI_ReservoirResolution::Full;
+        rtxdi::ReSTIRGIContext fullResolutionContext(staticParams);
+        Check(fullResolutionContext.getStaticParams().CheckerboardSamplingMode == rtxdi::CheckerboardMode::Black, "full resolution keeps checkerboard sampling");
+        Check(RTXDI_GetReservoirDownscaleLog2(fullResolutionContext.getReservoirBufferParameters()) == 0, "full-resolution reservoir buffer isn't downscaled");
+    }
+
+    void TestMapping(const RTXDI_ReservoirBufferParameters& reservoirParams)
+    {
+        // The checkerboard field of the DI runtime parameters must not change the GI mapping
+        const uint activeCheckerboardField = 1;
+
+        std::set<uint> pointers;
+        bool mappingMismatch = false;
+        bool outsideBuffer = false;
+        for (uint y = 0; y < c_renderHeight; y++)
+        {
+            for (uint x = 0; x < c_renderWidth; x++)
+            {
+                const uint2 reservoirPos = RTXDI_GIPixelPosToReservoirPos(uint2(x, y), activeCheckerboardField, reservoirParams);
+                int2 ownerPixel = int2(x, y);
+                RTXDI_ActivateGIReservoirPixel(ownerPixel, false, activeCheckerboardField, reservoirParams);
+                const uint2 reservoirPixel = RTXDI_GIReservoirPosToPixelPos(reservoirPos, activeCheckerboardField, reservoirParams);
+
+                mappingMismatch = mappingMismatch ||
+                    reservoirPos.x != x / 2 || reservoirPos.y != y / 2 ||
+                    ownerPixel.x != int(x & ~1u) || ownerPixel.y != int(y & ~1u) ||
+                    reservoirPixel.x != uint(ownerPixel.x) || reservoirPixel.y != uint(ownerPixel.y);
+
+                const uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, reservoirPos, 0);
+                outsideBuffer = outsideBuffer || pointer >= reservoirParams.reservoirArrayPitch;
+                pointers.insert(pointer);
+            }
+        }
+
+        const uint quadCount = ((c_renderWidth + 1) / 2) * ((c_renderHeight + 1) / 2);
+        Check(!mappingMismatch, "pixel, owner pixel and reservoir positions agree on the 2x2 quads");
+        Check(!outsideBuffer, "reservoirs of the partial quads at the edges are within the buffer");
+        Check(pointers.size() == quadCount, "one reservoir per quad");
+    }
+
+    void TestUpsampling(const RTXDI_ReservoirBufferParameters& reservoirParams)
+    {
+        g_viewSize = int2(c_renderWidth, c_renderHeight);
+        g_surfaces.clear();
+        for (uint y = 0; y < c_renderHeight; y++)
+        {
+            for (uint x = 0; x < c_renderWidth; x++)
+                g_surfaces.push_back(SceneSurface(int2(x, y)));
+        }
+
+        // One sample per quad, in front of the surface of the owner pixel
+        g_giReservoirs.assign(reservoirParams.reservoirArrayPitch, RTXDI_HostGIReservoirElement());
+        for (uint y = 0; y < c_renderHeight; y += 2)
+        {
+            for (uint x = 0; x < c_renderWidth; x += 2)
+            {
+                const RAB_Surface surface = SceneSurface(int2(x, y));
+                RTXDI_GIReservoir reservoir = RTXDI_EmptyGIReservoir();
+                reservoir.position = surface.worldPos - float3(0.f, 0.f, 1.f);
+                reservoir.normal = float3(0.f, 0.f, 1.f);
+                reservoir.radiance = float3(1.f);
+                reservoir.weightSum = 1.f;
+                reservoir.M = 1;
+                RTXDI_StoreGIReservoirAtSurface(reservoir, surface.worldPos, reservoirParams, RTXDI_GIPixelPosToReservoirPos(uint2(x, y), 0, reservoirParams), 0);
+            }
+        }
+
+        RTXDI_RuntimeParameters runtimeParams = {};
+        int missed = 0;
+        int tooFar = 0;
+        int crossed = 0;
+        for (uint y = 0; y < c_renderHeight; y++)
+        {
+            for (uint x = 0; x < c_renderWidth; x++)
+            {
+                RAB_RandomSamplerState rng = RTXDI_HostInitRandomSampler(y * c_renderWidth + x);
+                const RAB_Surface surface = RAB_GetGBufferSurface(int2(x, y), false);
+                const RTXDI_GIReservoir reservoir = RTXDI_GIUpsampleReservoir(uint2(x, y), surface, rng, runtimeParams, reservoirParams, 0, 0.1f, 0.5f);
+                if (!RTXDI_IsValidGIReservoir(reservoir) || !(reservoir.weightSum > 0.f))
+                {
+                    missed++;
+                    continue;
+                }
+
+                // The quads around a pixel have their centers within 1.5 pixels of the pixel center
+                const int2 ownerPixel = int2(int(reservoir.position.x), int(reservoir.position.y));
+                if (std::abs(float(ownerPixel.x + 1) - (float(x) + 0.5f)) > 1.5f || std::abs(float(ownerPixel.y + 1) - (float(y) + 0.5f)) > 1.5f)
+                    tooFar++;
+                if ((ownerPixel.x < c_discontinuityX) != (int(x) < c_discontinuityX))
+                    crossed++;
+            }
+        }
+
+        printf("Upsampling %ux%u: %d pixels without a sample, %d from a distant quad, %d across the discontinuity\n",
+            c_renderWidth, c_renderHeight, missed, tooFar, crossed);
+        Check(missed == 0, "every pixel gets an upsampled sample");
+        Check(tooFar == 0, "upsampled samples come from the quads around the pixel");
+        Check(crossed == 0, "upsampling doesn't cross depth discontinuities");
+    }
+}
+
+int main()
+{
+    Check(rtxdi::GetReservoirDownscaleLog2(rtxdi::ReSTIRGI_ReservoirResolution::Full) == 0, "full resolution isn't downscaled");
+    Check(rtxdi::GetReservoirDownscaleLog2(rtxdi::ReSTIRGI_ReservoirResolution::Quarter) == 1, "quarter resolution is downscaled by 2 along each axis");
+
+    TestContext();
+
+    rtxdi::ReSTIRGIStaticParameters staticParams;
+    staticParams.RenderWidth = c_renderWidth;
+    staticParams.RenderHeight = c_renderHeight;
+    staticParams.ReservoirResolution = rtxdi::ReSTIRGI_ReservoirResolution::Quarter;
+    const RTXDI_ReservoirBufferParameters reservoirParams = rtxdi::ReSTIRGIContext(staticParams).getReservoirBufferParameters();
+
+    TestMapping(reservoirParams);
+    TestUpsampling(reservoirParams);
+
+    if (g_failures == 0)
+        printf("Quarter-resolution GI test passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}
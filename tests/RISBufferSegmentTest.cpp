@@ -0,0 +1,195 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Reallocation and compaction of the RIS buffer segments owned by ImportanceSamplingContext: the local and
+// environment light presampling tiles and the ReGIR light slots. The RIS buffer is simulated with every element
+// tagged by its owner, so that the copies reported by compactRISBuffer can be checked against the new offsets.
+
+#include <rtxdi/RtxdiHostTypes.h>
+#include <rtxdi/ImportanceSamplingContext.h>
+#include <rtxdi/RISBufferSegmentAllocator.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    enum Owner : uint32_t
+    {
+        LocalLights = 1,
+        EnvironmentLight,
+        ReGIR,
+
+        OwnerCount
+    };
+
+    struct Segment
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    std::vector<Segment> GetSegments(const rtxdi::ImportanceSamplingContext& context)
+    {
+        const RTXDI_RISBufferSegmentParameters& local = context.getLocalLightRISBufferSegmentParams();
+        const RTXDI_RISBufferSegmentParameters& environment = context.getEnvironmentLightRISBufferSegmentParams();
+        const rtxdi::ReGIRContext& regir = context.getReGIRContext();
+
+        std::vector<Segment> segments(OwnerCount);
+        segments[LocalLights] = { local.bufferOffset, local.tileCount * local.tileSize };
+        segments[EnvironmentLight] = { environment.bufferOffset, environment.tileCount * environment.tileSize };
+        segments[ReGIR] = { regir.getReGIRCellOffset(), regir.getReGIRLightSlotCount() };
+        return segments;
+    }
+
+    void CheckSegmentsFit(const rtxdi::ImportanceSamplingContext& context)
+    {
+        const std::vector<Segment> segments = GetSegments(context);
+        const uint32_t totalSize = context.getRISBufferSegmentAllocator().getTotalSizeInElements();
+
+        bool overlap = false;
+        bool outside = false;
+        for (uint32_t a = LocalLights; a < OwnerCount; a++)
+        {
+            outside = outside || segments[a].offset + segments[a].size > totalSize;
+            for (uint32_t b = a + 1; b < OwnerCount; b++)
+            {
+                if (segments[a].size > 0 && segments[b].size > 0 &&
+                    segments[a].offset < segments[b].offset + segments[b].size &&
+                    segments[b].offset < segments[a].offset + segments[a].size)
+                {
+                    overlap = true;
+                }
+            }
+        }
+
+        Check(!overlap, "segments don't overlap");
+        Check(!outside, "segments are within the RIS buffer size");
+    }
+
+    void CheckConstantBuffer(rtxdi::ImportanceSamplingContext& context)
+    {
+        RTXDI_ImportanceSamplingParameters params;
+        context.packConstantBuffer(&params, true);
+        Check(params.localLightsRISBufferSegmentParams.bufferOffset == context.getLocalLightRISBufferSegmentParams().bufferOffset &&
+            params.environmentLightRISBufferSegmentParams.bufferOffset == context.getEnvironmentLightRISBufferSegmentParams().bufferOffset,
+            "constant buffer has the new presampling offsets");
+        Check(params.regir.commonParams.risBufferOffset == context.getReGIRContext().getReGIRCellOffset(),
+            "constant buffer has the new ReGIR offset");
+    }
+
+    // Fills the simulated RIS buffer with the owner tags at the current offsets
+    std::vector<uint32_t> TagRISBuffer(const rtxdi::ImportanceSamplingContext& context)
+    {
+        const std::vector<Segment> segments = GetSegments(context);
+        std::vector<uint32_t> buffer(context.getRISBufferSegmentAllocator().getTotalSizeInElements(), 0);
+        for (uint32_t owner = LocalLights; owner < OwnerCount; owner++)
+            std::fill(buffer.begin() + segments[owner].offset, buffer.begin() + segments[owner].offset + segments[owner].size, owner);
+        return buffer;
+    }
+
+    bool HoldsTags(const rtxdi::ImportanceSamplingContext& context, const std::vector<uint32_t>& buffer)
+    {
+        const std::vector<Segment> segments = GetSegments(context);
+        for (uint32_t owner = LocalLights; owner < OwnerCount; owner++)
+        {
+            for (uint32_t i = 0; i < segments[owner].size; i++)
+            {
+                if (buffer[segments[owner].offset + i] != owner)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void TestCompaction(rtxdi::ImportanceSamplingContext& context)
+    {
+        std::vector<uint32_t> buffer = TagRISBuffer(context);
+
+        std::vector<rtxdi::RISBufferSegmentMove> moves;
+        context.compactRISBuffer(moves);
+        for (const rtxdi::RISBufferSegmentMove& move : moves)
+            std::copy(buffer.begin() + move.srcOffset, buffer.begin() + move.srcOffset + move.sizeInElements, buffer.begin() + move.dstOffset);
+
+        const std::vector<Segment> segments = GetSegments(context);
+        uint32_t liveSize = 0;
+        for (uint32_t owner = LocalLights; owner < OwnerCount; owner++)
+            liveSize += segments[owner].size;
+
+        Check(HoldsTags(context, buffer), "segments hold their data after the moves");
+        Check(context.getRISBufferSegmentAllocator().getTotalSizeInElements() == liveSize, "compaction leaves no holes");
+        CheckSegmentsFit(context);
+        CheckConstantBuffer(context);
+    }
+}
+
+int main()
+{
+    rtxdi::ImportanceSamplingContext_StaticParameters staticParams;
+    staticParams.renderWidth = 64;
+    staticParams.renderHeight = 64;
+    rtxdi::ImportanceSamplingContext context(staticParams);
+    CheckSegmentsFit(context);
+
+    // Larger local light tiles don't fit into the released range
+    Check(!context.setLocalLightRISBufferParams({ 2048, 128 }), "growing the local light tiles requires a larger RIS buffer");
+    Check(context.getLocalLightRISBufferSegmentParams().tileSize == 2048, "local light tile size is updated");
+    CheckSegmentsFit(context);
+    CheckConstantBuffer(context);
+
+    // A smaller ReGIR structure fits into the range of the previous one
+    rtxdi::ReGIRStaticParameters regirParams;
+    regirParams.Mode = rtxdi::ReGIRMode::Grid;
+    regirParams.gridParameters.GridSize = { 8, 8, 8 };
+    regirParams.LightsPerCell = 64;
+    Check(context.setReGIRStaticParameters(regirParams), "shrinking ReGIR fits into the RIS buffer");
+    Check(context.getReGIRContext().getReGIRStaticParameters().Mode == rtxdi::ReGIRMode::Grid, "ReGIR mode is updated");
+    Check(context.getReGIRContext().getReGIRLightSlotCount() == 8 * 8 * 8 * 64, "ReGIR light slots are recomputed");
+    CheckSegmentsFit(context);
+    CheckConstantBuffer(context);
+
+    Check(context.setEnvironmentLightRISBufferParams({ 256, 128 }), "shrinking the environment light tiles fits into the RIS buffer");
+    TestCompaction(context);
+
+    // Clipmap level offsets follow the segment
+    regirParams.Mode = rtxdi::ReGIRMode::Clipmap;
+    regirParams.clipmapParameters.GridSize = { 8, 8, 8 };
+    regirParams.clipmapParameters.LevelCount = 3;
+    context.setReGIRStaticParameters(regirParams);
+    context.setLocalLightRISBufferParams({ 512, 128 });
+    TestCompaction(context);
+    const rtxdi::ReGIRClipmapCalculatedParameters& clipmap = context.getReGIRContext().getReGIRClipmapCalculatedParameters();
+    Check(clipmap.levelRISBufferOffsets.size() == 3 &&
+        clipmap.levelRISBufferOffsets[0] == context.getReGIRContext().getReGIRCellOffset() &&
+        clipmap.levelRISBufferOffsets[2] == context.getReGIRContext().getReGIRCellOffset() + 2 * 8 * 8 * 8 * 64,
+        "clipmap level offsets follow the ReGIR segment");
+
+    // Disabling ReGIR releases its segment
+    regirParams.Mode = rtxdi::ReGIRMode::Disabled;
+    context.setReGIRStaticParameters(regirParams);
+    TestCompaction(context);
+    Check(context.getRISBufferSegmentAllocator().getTotalSizeInElements() == (512 + 256) * 128, "only the presampling tiles remain");
+
+    if (g_failures == 0)
+        printf("RIS buffer segment test passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}
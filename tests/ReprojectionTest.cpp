@@ -0,0 +1,197 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Temporal reprojection across a render resolution change. A ReSTIRGIContext is resized between two frames,
+// and RTXDI_GITemporalResampling runs at the new size with the previous frame scale of fillRuntimeParams.
+// The previous frame holds one GI reservoir per pixel whose sample position identifies the pixel, so the test
+// can check that every pixel reuses the reservoir of the previous pixel under the same screen position,
+// when shrinking and when growing the render size. It also checks the scale reported by ReSTIRDIContext,
+// and that runtime parameters with a zero scale reproject as if the size were unchanged.
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+#include <rtxdi/GIResamplingFunctions.hlsli>
+
+#include <rtxdi/ReSTIRDI.h>
+#include <rtxdi/ReSTIRGI.h>
+
+#include <cstdio>
+
+namespace
+{
+    // The surfaces cover a square of the plane z = 0, whatever the render size
+    const float c_planeSize = 10.f;
+    const float c_sampleHeight = 2.f;
+    const float c_linearDepth = 5.f;
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    RAB_Surface PlaneSurface(int2 pixelPosition, int2 viewSize)
+    {
+        RAB_Surface surface;
+        surface.worldPos = float3(
+            (float(pixelPosition.x) + 0.5f) / float(viewSize.x) * c_planeSize,
+            (float(pixelPosition.y) + 0.5f) / float(viewSize.y) * c_planeSize,
+            0.f);
+        surface.normal = float3(0.f, 0.f, 1.f);
+        surface.linearDepth = c_linearDepth;
+        surface.valid = true;
+        return surface;
+    }
+
+    std::vector<RAB_Surface> PlaneSurfaces(int2 viewSize)
+    {
+        std::vector<RAB_Surface> surfaces;
+        for (int y = 0; y < viewSize.y; y++)
+        {
+            for (int x = 0; x < viewSize.x; x++)
+                surfaces.push_back(PlaneSurface(int2(x, y), viewSize));
+        }
+        return surfaces;
+    }
+
+    // Stores a reservoir above every previous frame surface
+    void FillPreviousReservoirs(const RTXDI_ReservoirBufferParameters& reservoirParams)
+    {
+        g_giReservoirs.assign(reservoirParams.reservoirArrayPitch * rtxdi::c_NumReSTIRGIReservoirBuffers, RTXDI_HostGIReservoirElement());
+        for (int y = 0; y < g_prevViewSize.y; y++)
+        {
+            for (int x = 0; x < g_prevViewSize.x; x++)
+            {
+                const RAB_Surface surface = g_prevSurfaces[y * g_prevViewSize.x + x];
+                RTXDI_GIReservoir reservoir = RTXDI_EmptyGIReservoir();
+                reservoir.position = surface.worldPos + float3(0.f, 0.f, c_sampleHeight);
+                reservoir.normal = float3(0.f, 0.f, -1.f);
+                reservoir.radiance = float3(1.f);
+                reservoir.weightSum = 1.f;
+                reservoir.M = 1;
+
+                const uint2 reservoirPos = RTXDI_GIPixelPosToReservoirPos(uint2(x, y), 0, reservoirParams);
+                RTXDI_StoreGIReservoirAtSurface(reservoir, surface.worldPos, reservoirParams, reservoirPos, 0);
+            }
+        }
+    }
+
+    // Runs the temporal pass on every pixel and checks that the reused sample comes from the previous pixel nearest to
+    // the reprojected pixel center
+    void TestResize(uint prevSize, uint size, uint maxSize)
+    {
+        printf("Resize from %ux%u to %ux%u\n", prevSize, prevSize, size, size);
+
+        rtxdi::ReSTIRGIStaticParameters staticParams;
+        staticParams.RenderWidth = prevSize;
+        staticParams.RenderHeight = prevSize;
+        staticParams.MaxRenderWidth = maxSize;
+        staticParams.MaxRenderHeight = maxSize;
+        rtxdi::ReSTIRGIContext context(staticParams);
+        context.setFrameIndex(1);
+        Check(context.resize(size, size), "the new size fits the reservoir buffers");
+
+        RTXDI_RuntimeParameters runtimeParams = {};
+        context.fillRuntimeParams(runtimeParams);
+        const float scale = float(prevSize) / float(size);
+        Check(runtimeParams.prevFrameScaleX == scale && runtimeParams.prevFrameScaleY == scale, "GI context reports the previous frame scale");
+
+        const RTXDI_ReservoirBufferParameters reservoirParams = context.getReservoirBufferParameters();
+        g_prevViewSize = int2(prevSize, prevSize);
+        g_prevSurfaces = PlaneSurfaces(g_prevViewSize);
+        g_viewSize = int2(size, size);
+        g_surfaces = PlaneSurfaces(g_viewSize);
+        FillPreviousReservoirs(reservoirParams);
+
+        RTXDI_GITemporalResamplingParameters tparams = {};
+        tparams.screenSpaceMotion = float3(0.f);
+        tparams.sourceBufferIndex = 0;
+        tparams.maxHistoryLength = 20;
+        tparams.biasCorrectionMode = RTXDI_BIAS_CORRECTION_OFF;
+        tparams.depthThreshold = 0.1f;
+        tparams.normalThreshold = 0.5f;
+        tparams.maxReservoirAge = 30;
+        tparams.enablePermutationSampling = false;
+        tparams.enableFallbackSampling = false;
+
+        int missed = 0;
+        int misplaced = 0;
+        for (uint y = 0; y < size; y++)
+        {
+            for (uint x = 0; x < size; x++)
+            {
+                RAB_RandomSamplerState rng = RTXDI_HostInitRandomSampler(y * size + x);
+                const RAB_Surface surface = RAB_GetGBufferSurface(int2(x, y), false);
+                const RTXDI_GIReservoir reservoir = RTXDI_GITemporalResampling(uint2(x, y), surface, RTXDI_EmptyGIReservoir(),
+                    rng, runtimeParams, reservoirParams, tparams);
+                if (!RTXDI_IsValidGIReservoir(reservoir))
+                {
+                    missed++;
+                    continue;
+                }
+
+                // Previous pixel of the reused sample, and the reprojected center of the current pixel in previous pixels
+                const float2 samplePixel = float2(reservoir.position.x, reservoir.position.y) / c_planeSize * float(prevSize) - 0.5f;
+                const float2 reprojected = (float2(float(x), float(y)) + 0.5f) * scale - 0.5f;
+                if (std::abs(samplePixel.x - reprojected.x) > 0.501f || std::abs(samplePixel.y - reprojected.y) > 0.501f)
+                    misplaced++;
+            }
+        }
+
+        printf("  %d pixels without a temporal sample, %d pixels reusing the wrong previous pixel\n", missed, misplaced);
+        Check(missed == 0, "every pixel finds its previous reservoir");
+        Check(misplaced == 0, "every pixel reuses the previous pixel under its center");
+
+        context.setFrameIndex(2);
+        context.fillRuntimeParams(runtimeParams);
+        Check(runtimeParams.prevFrameScaleX == 1.f && runtimeParams.prevFrameScaleY == 1.f, "scale returns to 1 on the next frame");
+    }
+
+    void TestDIContextScale()
+    {
+        rtxdi::ReSTIRDIStaticParameters staticParams;
+        staticParams.RenderWidth = 64;
+        staticParams.RenderHeight = 48;
+        rtxdi::ReSTIRDIContext context(staticParams);
+        context.setFrameIndex(1);
+        context.resize(32, 32);
+
+        const RTXDI_RuntimeParameters runtimeParams = context.getRuntimeParams();
+        Check(runtimeParams.prevFrameScaleX == 2.f && runtimeParams.prevFrameScaleY == 1.5f, "DI context reports the previous frame scale");
+    }
+
+    void TestZeroScale()
+    {
+        const RTXDI_RuntimeParameters runtimeParams = {};
+        const float2 reprojected = RTXDI_ReprojectPixelPos(uint2(17, 5), float2(1.5f, -2.f), runtimeParams);
+        Check(reprojected.x == 18.5f && reprojected.y == 3.f, "zero scale reprojects at an unchanged size");
+    }
+}
+
+int main()
+{
+    TestResize(64, 32, 64);
+    TestResize(32, 64, 64);
+    TestResize(48, 40, 48);
+    TestDIContextScale();
+    TestZeroScale();
+
+    if (g_failures == 0)
+        printf("Reprojection test passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Cache simulation of the reservoir buffer accesses of a frame for each block size and in-block order
+// (ReSTIRDIStaticParameters::ReservoirBlockSize and ReservoirBlockAddressing).
+// Thread groups are dispatched in row-major order. Each thread reads its own reservoir and, for the spatial
+// patterns, neighbors from the neighbor offset buffer like RTXDI_DISpatialResampling.
+// Reported per layout:
+//   lines/group - distinct cache lines touched by a thread group, i.e. its L1 footprint
+//   hit rate    - hit rate of a 16 KB LRU cache over the whole frame
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+
+#include <rtxdi/RtxdiUtils.h>
+
+#include <cstdio>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    const uint c_renderWidth = 1920;
+    const uint c_renderHeight = 1080;
+    const uint c_cacheLineSize = 128;
+    const uint c_cacheSize = 16 * 1024;
+    const uint c_neighborOffsetCount = 8192;
+
+    class LruCache
+    {
+    public:
+        explicit LruCache(size_t lineCount) : m_lineCount(lineCount) { }
+
+        void access(uint64_t line)
+        {
+            auto it = m_map.find(line);
+            if (it != m_map.end())
+            {
+                m_hits++;
+                m_lines.splice(m_lines.begin(), m_lines, it->second);
+                return;
+            }
+
+            m_misses++;
+            m_lines.push_front(line);
+            m_map[line] = m_lines.begin();
+            if (m_lines.size() > m_lineCount)
+            {
+                m_map.erase(m_lines.back());
+                m_lines.pop_back();
+            }
+        }
+
+        double hitRate() const { return double(m_hits) / double(std::max<uint64_t>(m_hits + m_misses, 1)); }
+
+    private:
+        size_t m_lineCount;
+        std::list<uint64_t> m_lines;
+        std::unordered_map<uint64_t, std::list<uint64_t>::iterator> m_map;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+    };
+
+    struct Layout
+    {
+        uint blockSize;
+        rtxdi::ReservoirBlockOrder order;
+        const char* name;
+    };
+
+    struct Pattern
+    {
+        uint neighbors;
+        float radius;
+        const char* name;
+    };
+
+    void Simulate(uint2 groupSize, const Pattern& pattern, const Layout& layout)
+    {
+        const RTXDI_ReservoirBufferParameters reservoirParams = rtxdi::CalculateReservoirBufferParameters(
+            c_renderWidth, c_renderHeight, rtxdi::CheckerboardMode::Off, 1, layout.blockSize, layout.order);
+        const uint reservoirSize = rtxdi::GetDIReservoirSizeInBytes(rtxdi::DIReservoirFormat::Packed);
+        const uint neighborOffsetMask = c_neighborOffsetCount - 1;
+
+        LruCache cache(c_cacheSize / c_cacheLineSize);
+        std::unordered_set<uint64_t> groupLines;
+        uint64_t totalGroupLines = 0;
+        uint groupCount = 0;
+
+        for (uint groupY = 0; groupY + groupSize.y <= c_renderHeight; groupY += groupSize.y)
+        {
+            for (uint groupX = 0; groupX + groupSize.x <= c_renderWidth; groupX += groupSize.x)
+            {
+                groupLines.clear();
+                for (uint thread = 0; thread < groupSize.x * groupSize.y; thread++)
+                {
+                    const uint2 pixelPosition = uint2(groupX + thread % groupSize.x, groupY + thread / groupSize.x);
+                    RAB_RandomSamplerState rng = RTXDI_HostInitRandomSampler(pixelPosition.y * c_renderWidth + pixelPosition.x);
+                    const uint startIdx = uint(RAB_GetNextRandom(rng) * neighborOffsetMask);
+
+                    for (uint i = 0; i <= pattern.neighbors; i++)
+                    {
+                        int2 position = int2(pixelPosition);
+                        if (i > 0)
+                        {
+                            const uint sampleIdx = (startIdx + i) & neighborOffsetMask;
+                            position += int2(g_neighborOffsets[sampleIdx] * pattern.radius);
+                            position = RAB_ClampSamplePositionIntoView(position, false);
+                        }
+
+                        const uint pointer = RTXDI_ReservoirPositionToPointer(reservoirParams, uint2(position), 0);
+                        const uint64_t line = uint64_t(pointer) * reservoirSize / c_cacheLineSize;
+                        cache.access(line);
+                        groupLines.insert(line);
+                    }
+                }
+
+                totalGroupLines += groupLines.size();
+                groupCount++;
+            }
+        }
+
+        printf("  %-14s %7.1f lines/group  %5.1f%% hit rate\n", layout.name, double(totalGroupLines) / groupCount, cache.hitRate() * 100.0);
+    }
+}
+
+int main()
+{
+    g_viewSize = int2(c_renderWidth, c_renderHeight);
+    std::vector<uint8_t> neighborOffsets(c_neighborOffsetCount * 2);
+    rtxdi::FillNeighborOffsetBuffer(neighborOffsets.data(), c_neighborOffsetCount);
+    RTXDI_HostLoadNeighborOffsets(neighborOffsets.data(), c_neighborOffsetCount);
+
+    const uint2 groupSizes[] = { uint2(8, 8), uint2(8, 4) };
+    const Pattern patterns[] = {
+        { 0, 0.f, "own reservoir" },
+        { 4, 2.f, "4 neighbors, radius 2" },
+        { 5, 8.f, "5 neighbors, radius 8" },
+        { 5, 32.f, "5 neighbors, radius 32" } };
+    const Layout layouts[] = {
+        { 16, rtxdi::ReservoirBlockOrder::RowMajor, "16 row-major" },
+        { 16, rtxdi::ReservoirBlockOrder::ZOrder, "16 Z-order" },
+        { 8, rtxdi::ReservoirBlockOrder::RowMajor, "8 row-major" },
+        { 8, rtxdi::ReservoirBlockOrder::ZOrder, "8 Z-order" } };
+
+    printf("%ux%u, %u-byte DI reservoirs, %u-byte lines, %u KB LRU cache\n",
+        c_renderWidth, c_renderHeight, rtxdi::GetDIReservoirSizeInBytes(rtxdi::DIReservoirFormat::Packed), c_cacheLineSize, c_cacheSize / 1024);
+
+    for (const uint2& groupSize : groupSizes)
+    {
+        for (const Pattern& pattern : patterns)
+        {
+            printf("%ux%u groups, %s:\n", groupSize.x, groupSize.y, pattern.name);
+            for (const Layout& layout : layouts)
+                Simulate(groupSize, pattern, layout);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,267 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef RTXDI_HOST_BRIDGE_H
+#define RTXDI_HOST_BRIDGE_H
+
+// Minimal RAB_* bridge for the host builds of the shader headers in the tests and benchmarks.
+// The scene is a list of point lights lit onto a G-buffer of surfaces, both filled by the program.
+// Include it before the .hlsli files, once per program like the shader headers themselves.
+//
+// The resource macros that every resampling header requires are bound to the globals below.
+// The optional ones (RTXDI_COUNTER_BUFFER, RTXDI_LIGHT_ALIAS_TABLE, RTXDI_REGIR_HASH_BUFFER,
+// RTXDI_REGIR_ACTIVE_CELL_BUFFER, RTXDI_REGIR_ONION_CELL_BUFFER) are left to the program,
+// which can point them to the matching globals.
+
+#include <rtxdi/RtxdiHostTypes.h>
+#include <rtxdi/ReSTIRGIParameters.h>
+
+#include <atomic>
+#include <vector>
+
+struct RAB_RandomSamplerState
+{
+    uint seed;
+    uint index;
+};
+
+struct RAB_Surface
+{
+    float3 worldPos;
+    float3 normal;
+    float linearDepth;
+    bool valid;
+};
+
+struct RAB_LightInfo
+{
+    float3 position;
+    float3 radiance;
+};
+
+struct RAB_LightSample
+{
+    float3 position;
+    float3 normal;
+    float3 radiance;
+    float solidAnglePdf;
+};
+
+#if RTXDI_COMPACT_DI_RESERVOIR
+typedef RTXDI_CompactDIReservoir RTXDI_HostDIReservoirElement;
+#elif RTXDI_SOA_DI_RESERVOIR
+typedef uint2 RTXDI_HostDIReservoirElement;
+#else
+typedef RTXDI_PackedDIReservoir RTXDI_HostDIReservoirElement;
+#endif
+
+#if RTXDI_COMPACT_GI_RESERVOIR
+typedef RTXDI_CompactGIReservoir RTXDI_HostGIReservoirElement;
+#elif RTXDI_SOA_GI_RESERVOIR
+typedef uint4 RTXDI_HostGIReservoirElement;
+#else
+typedef RTXDI_PackedGIReservoir RTXDI_HostGIReservoirElement;
+#endif
+
+// Scene
+std::vector<RAB_LightInfo> g_lights;
+std::vector<RAB_Surface> g_surfaces;
+std::vector<RAB_Surface> g_prevSurfaces;
+int2 g_viewSize = int2(0, 0);
+// Size of g_prevSurfaces, 0 if it's the same as g_viewSize
+int2 g_prevViewSize = int2(0, 0);
+
+// Resources of the shader headers
+std::vector<RTXDI_HostDIReservoirElement> g_lightReservoirs;
+std::vector<RTXDI_HostGIReservoirElement> g_giReservoirs;
+std::vector<uint2> g_risBuffer;
+std::vector<float2> g_neighborOffsets;
+std::vector<RTXDI_AliasTableEntry> g_lightAliasTable;
+std::vector<float4> g_regirOnionCells;
+std::vector<std::atomic<uint>> g_regirHashTable;
+std::vector<std::atomic<uint>> g_regirActiveCells;
+std::vector<std::atomic<uint>> g_counters;
+
+#define RTXDI_LIGHT_RESERVOIR_BUFFER g_lightReservoirs
+#define RTXDI_GI_RESERVOIR_BUFFER g_giReservoirs
+#define RTXDI_RIS_BUFFER g_risBuffer
+#define RTXDI_NEIGHBOR_OFFSETS_BUFFER g_neighborOffsets
+
+inline float RTXDI_HostLuminance(float3 color)
+{
+    return dot(color, float3(0.2126f, 0.7152f, 0.0722f));
+}
+
+// PCG hash of the sampler state, so that consecutive indices give uncorrelated numbers
+inline uint RTXDI_HostPcgHash(uint value)
+{
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+inline RAB_RandomSamplerState RTXDI_HostInitRandomSampler(uint seed)
+{
+    RAB_RandomSamplerState rng;
+    rng.seed = RTXDI_HostPcgHash(seed);
+    rng.index = 0;
+    return rng;
+}
+
+float RAB_GetNextRandom(RAB_RandomSamplerState& rng)
+{
+    const uint bits = RTXDI_HostPcgHash(rng.seed + RTXDI_HostPcgHash(rng.index++));
+    return float(bits >> 8) * (1.f / 16777216.f);
+}
+
+// Neighbor offsets written by rtxdi::FillNeighborOffsetBuffer are RG8_SNORM, like the GPU buffer format
+inline void RTXDI_HostLoadNeighborOffsets(const uint8_t* snormOffsets, uint neighborOffsetCount)
+{
+    g_neighborOffsets.resize(neighborOffsetCount);
+    for (uint i = 0; i < neighborOffsetCount; i++)
+    {
+        g_neighborOffsets[i] = float2(
+            max(float(int8_t(snormOffsets[i * 2 + 0])) / 127.f, -1.f),
+            max(float(int8_t(snormOffsets[i * 2 + 1])) / 127.f, -1.f));
+    }
+}
+
+RAB_Surface RAB_EmptySurface()
+{
+    RAB_Surface surface;
+    surface.worldPos = float3(0.f);
+    surface.normal = float3(0.f);
+    surface.linearDepth = 0.f;
+    surface.valid = false;
+    return surface;
+}
+
+RAB_Surface RAB_GetGBufferSurface(int2 pixelPosition, bool previousFrame)
+{
+    const bool usePrevSurfaces = previousFrame && !g_prevSurfaces.empty();
+    const std::vector<RAB_Surface>& surfaces = usePrevSurfaces ? g_prevSurfaces : g_surfaces;
+    const int2 viewSize = usePrevSurfaces && g_prevViewSize.x > 0 ? g_prevViewSize : g_viewSize;
+    if (pixelPosition.x < 0 || pixelPosition.y < 0 || pixelPosition.x >= viewSize.x || pixelPosition.y >= viewSize.y)
+        return RAB_EmptySurface();
+
+    const size_t index = size_t(pixelPosition.y) * size_t(viewSize.x) + size_t(pixelPosition.x);
+    return index < surfaces.size() ? surfaces[index] : RAB_EmptySurface();
+}
+
+bool RAB_IsSurfaceValid(RAB_Surface surface) { return surface.valid; }
+float3 RAB_GetSurfaceWorldPos(RAB_Surface surface) { return surface.worldPos; }
+float3 RAB_GetSurfaceNormal(RAB_Surface surface) { return surface.normal; }
+float RAB_GetSurfaceLinearDepth(RAB_Surface surface) { return surface.linearDepth; }
+bool RAB_AreMaterialsSimilar(RAB_Surface, RAB_Surface) { return true; }
+
+int2 RAB_ClampSamplePositionIntoView(int2 pixelPosition, bool previousFrame)
+{
+    const int2 viewSize = previousFrame && g_prevViewSize.x > 0 ? g_prevViewSize : g_viewSize;
+    return clamp(pixelPosition, int2(0, 0), max(viewSize - 1, int2(0, 0)));
+}
+
+RAB_LightInfo RAB_EmptyLightInfo()
+{
+    RAB_LightInfo lightInfo;
+    lightInfo.position = float3(0.f);
+    lightInfo.radiance = float3(0.f);
+    return lightInfo;
+}
+
+RAB_LightInfo RAB_LoadLightInfo(uint index, bool)
+{
+    return index < g_lights.size() ? g_lights[index] : RAB_EmptyLightInfo();
+}
+
+// The bridge has no compact light storage, RTXDI_LIGHT_COMPACT_BIT is never set
+RAB_LightInfo RAB_LoadCompactLightInfo(uint) { return RAB_EmptyLightInfo(); }
+bool RAB_StoreCompactLightInfo(uint, RAB_LightInfo) { return false; }
+
+// The light list doesn't change between frames
+int RAB_TranslateLightIndex(uint lightIndex, bool) { return int(lightIndex); }
+
+RAB_LightSample RAB_EmptyLightSample()
+{
+    RAB_LightSample lightSample;
+    lightSample.position = float3(0.f);
+    lightSample.normal = float3(0.f);
+    lightSample.radiance = float3(0.f);
+    lightSample.solidAnglePdf = 0.f;
+    return lightSample;
+}
+
+RAB_LightSample RAB_SamplePolymorphicLight(RAB_LightInfo lightInfo, RAB_Surface surface, float2)
+{
+    RAB_LightSample lightSample;
+    lightSample.position = lightInfo.position;
+    lightSample.normal = normalize(surface.worldPos - lightInfo.position);
+    lightSample.radiance = lightInfo.radiance;
+    lightSample.solidAnglePdf = 1.f;
+    return lightSample;
+}
+
+void RAB_GetLightDirDistance(RAB_Surface surface, RAB_LightSample lightSample, float3& outDirection, float& outDistance)
+{
+    const float3 toLight = lightSample.position - surface.worldPos;
+    outDistance = length(toLight);
+    outDirection = outDistance > 0.f ? toLight / outDistance : surface.normal;
+}
+
+float RAB_GetLightSampleTargetPdfForSurface(RAB_LightSample lightSample, RAB_Surface surface)
+{
+    float3 direction;
+    float distance;
+    RAB_GetLightDirDistance(surface, lightSample, direction, distance);
+    if (distance <= 0.f)
+        return 0.f;
+
+    return RTXDI_HostLuminance(lightSample.radiance) * max(dot(surface.normal, direction), 0.f) / (distance * distance);
+}
+
+float RAB_GetLightTargetPdfForVolume(RAB_LightInfo lightInfo, float3 volumeCenter, float volumeRadius)
+{
+    const float3 toLight = lightInfo.position - volumeCenter;
+    return RTXDI_HostLuminance(lightInfo.radiance) / max(dot(toLight, toLight), volumeRadius * volumeRadius);
+}
+
+float RAB_GetGISampleTargetPdfForSurface(float3 samplePosition, float3 sampleRadiance, RAB_Surface surface)
+{
+    const float3 direction = normalize(samplePosition - surface.worldPos);
+    return RTXDI_HostLuminance(sampleRadiance) * max(dot(surface.normal, direction), 0.f);
+}
+
+// Point lights are not hit by rays, so BRDF samples never find a local light or the environment
+float RAB_LightSampleSolidAnglePdf(RAB_LightSample lightSample) { return lightSample.solidAnglePdf; }
+bool RAB_IsAnalyticLightSample(RAB_LightSample) { return true; }
+float RAB_GetSurfaceBrdfPdf(RAB_Surface, float3) { return 0.f; }
+bool RAB_GetSurfaceBrdfSample(RAB_Surface surface, RAB_RandomSamplerState&, float3& outDirection) { outDirection = surface.normal; return false; }
+float RAB_EvaluateLocalLightSourcePdf(uint) { return 0.f; }
+float2 RAB_GetEnvironmentMapRandXYFromDir(float3) { return float2(0.f); }
+float RAB_EvaluateEnvironmentMapSamplingPdf(float3) { return 0.f; }
+
+bool RAB_TraceRayForLocalLight(float3, float3, float, float, uint& outLightIndex, float2& outRandXY)
+{
+    outLightIndex = RTXDI_InvalidLightIndex;
+    outRandXY = float2(0.f);
+    return false;
+}
+
+// The scene has no occluders
+bool RAB_GetConservativeVisibility(RAB_Surface, RAB_LightSample) { return true; }
+bool RAB_GetTemporalConservativeVisibility(RAB_Surface, RAB_Surface, RAB_LightSample) { return true; }
+bool RAB_GetConservativeVisibility(RAB_Surface, float3) { return true; }
+bool RAB_GetTemporalConservativeVisibility(RAB_Surface, RAB_Surface, float3) { return true; }
+
+bool RAB_ValidateGISampleWithJacobian(float& jacobian)
+{
+    return jacobian > 0.f && jacobian < 10.f;
+}
+
+#endif // RTXDI_HOST_BRIDGE_H
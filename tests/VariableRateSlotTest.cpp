@@ -0,0 +1,150 @@
+/***************************************************************************
+ # Copyright (c) 2023, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// Slot mapping of variable-rate sampling (CheckerboardMode::VariableRate) for every sampling rate, on render sizes
+// that are and aren't multiples of RTXDI_VARIABLE_RATE_TILE_SIZE. The rate map entries come from
+// rtxdi::BuildVariableRateMap over consecutive frames. For each tile and frame, the test checks that
+//   - RTXDI_GetVariableRateSlotCount equals the number of active pixels of the tile inside the render area,
+//   - RTXDI_VariableRateSlotToPixelPos maps the slots to these pixels and RTXDI_PixelPosToVariableRateSlot inverts it,
+// and over the frames of a rate period, that every pixel is active exactly once.
+
+#include "RtxdiHostBridge.h"
+
+#include <rtxdi/RtxdiMath.hlsli>
+#include <rtxdi/RtxdiHelpers.hlsli>
+
+#include <rtxdi/RtxdiUtils.h>
+
+#include <cstdio>
+
+namespace
+{
+    struct RateConfiguration
+    {
+        float variance;
+        uint expectedRate;
+        uint period;
+        const char* name;
+    };
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    void TestRenderSize(uint2 renderSize, const RateConfiguration& configuration)
+    {
+        uint widthInTiles, heightInTiles;
+        rtxdi::GetVariableRateMapSize(renderSize.x, renderSize.y, widthInTiles, heightInTiles);
+
+        const std::vector<float> variance(size_t(renderSize.x) * renderSize.y, configuration.variance);
+        std::vector<uint> rateMap(size_t(widthInTiles) * heightInTiles);
+        std::vector<uint> activeFrames(size_t(renderSize.x) * renderSize.y, 0);
+
+        int rateMismatches = 0;
+        int countMismatches = 0;
+        int slotMismatches = 0;
+        for (uint frame = 0; frame < configuration.period; frame++)
+        {
+            rtxdi::BuildVariableRateMap(variance.data(), renderSize.x, renderSize.y, frame, rtxdi::VariableRateMapParameters(), rateMap.data());
+
+            for (uint tileY = 0; tileY < heightInTiles; tileY++)
+            {
+                for (uint tileX = 0; tileX < widthInTiles; tileX++)
+                {
+                    const uint2 tilePosition = uint2(tileX, tileY);
+                    const uint rateMapEntry = rateMap[tileY * widthInTiles + tileX];
+                    if (RTXDI_GetVariableSamplingRate(rateMapEntry) != configuration.expectedRate)
+                        rateMismatches++;
+
+                    // Active pixels of the tile inside the render area
+                    uint activeCount = 0;
+                    const uint2 extent = RTXDI_GetVariableRateTileExtent(tilePosition, renderSize);
+                    std::vector<bool> slotTaken(extent.x * extent.y, false);
+                    for (uint y = 0; y < extent.y; y++)
+                    {
+                        for (uint x = 0; x < extent.x; x++)
+                        {
+                            const uint2 pixelPosition = tilePosition * RTXDI_VARIABLE_RATE_TILE_SIZE + uint2(x, y);
+                            if (!RTXDI_IsVariableRatePixelActive(pixelPosition, rateMapEntry))
+                                continue;
+
+                            activeCount++;
+                            activeFrames[pixelPosition.y * renderSize.x + pixelPosition.x]++;
+                        }
+                    }
+
+                    const uint slotCount = RTXDI_GetVariableRateSlotCount(tilePosition, rateMapEntry, renderSize);
+                    if (slotCount != activeCount)
+                        countMismatches++;
+
+                    for (uint slot = 0; slot < slotCount; slot++)
+                    {
+                        const uint2 pixelPosition = RTXDI_VariableRateSlotToPixelPos(tilePosition, slot, rateMapEntry, renderSize);
+                        const uint2 offset = pixelPosition - tilePosition * RTXDI_VARIABLE_RATE_TILE_SIZE;
+                        const bool valid = pixelPosition.x < renderSize.x && pixelPosition.y < renderSize.y &&
+                            pixelPosition.x / RTXDI_VARIABLE_RATE_TILE_SIZE == tileX && pixelPosition.y / RTXDI_VARIABLE_RATE_TILE_SIZE == tileY &&
+                            RTXDI_IsVariableRatePixelActive(pixelPosition, rateMapEntry) &&
+                            !slotTaken[offset.y * extent.x + offset.x] &&
+                            RTXDI_PixelPosToVariableRateSlot(pixelPosition, rateMapEntry, renderSize) == slot;
+                        if (!valid)
+                        {
+                            slotMismatches++;
+                            continue;
+                        }
+                        slotTaken[offset.y * extent.x + offset.x] = true;
+                    }
+                }
+            }
+        }
+
+        int coverageMismatches = 0;
+        for (uint count : activeFrames)
+        {
+            if (count != 1)
+                coverageMismatches++;
+        }
+
+        printf("%-8s %3ux%-3u: %d rate, %d slot count, %d slot mapping, %d coverage mismatches\n",
+            configuration.name, renderSize.x, renderSize.y, rateMismatches, countMismatches, slotMismatches, coverageMismatches);
+        Check(rateMismatches == 0, "rate map has the expected rate");
+        Check(countMismatches == 0, "slot count equals the number of active pixels");
+        Check(slotMismatches == 0, "slots map to distinct active pixels of the tile and back");
+        Check(coverageMismatches == 0, "every pixel is active exactly once per rate period");
+    }
+}
+
+int main()
+{
+    // Variances below the default thresholds of VariableRateMapParameters select the lower rates
+    const RateConfiguration configurations[] = {
+        { 1.f, RTXDI_SAMPLING_RATE_FULL, 1, "full" },
+        { 0.005f, RTXDI_SAMPLING_RATE_HALF, 2, "half" },
+        { 0.0001f, RTXDI_SAMPLING_RATE_QUARTER, 4, "quarter" } };
+
+    const uint2 renderSizes[] = { uint2(16, 8), uint2(37, 29), uint2(13, 6), uint2(9, 17), uint2(1, 1), uint2(2, 3) };
+
+    for (const RateConfiguration& configuration : configurations)
+    {
+        for (const uint2& renderSize : renderSizes)
+            TestRenderSize(renderSize, configuration);
+    }
+
+    if (g_failures == 0)
+        printf("Variable-rate slot test passed\n");
+
+    return g_failures == 0 ? 0 : 1;
+}